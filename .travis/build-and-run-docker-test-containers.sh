@@ -20,6 +20,9 @@ docker build -t build_cpp_image -f tests/docker/Dockerfile.testing.cpp.debian_bu
 cpp_test_args="--cap-add SYS_PTRACE build_cpp_image sh ./tests/docker/cpp_test.run.sh Debug"
 docker run --rm $cpp_test_args
 docker run --rm --env CC=/usr/bin/clang --env CXX=/usr/bin/clang++ $cpp_test_args
+# Build and run the gRPC callback API code against a gRPC that has it.
+docker build -t build_grpc_callback_image -f tests/docker/Dockerfile.testing.grpc_callback.debian_bookworm .
+docker run --rm build_grpc_callback_image sh ./tests/docker/grpc_callback_test.run.sh
 # Build flatc on debian once to speed up the test loop below.
 docker run --name flatc_container build_cpp_image sh ./tests/docker/build_flatc.run.sh Debug
 # All dependent dockers refer to 'flatc_debian_stretch'.
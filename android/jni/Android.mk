@@ -35,6 +35,7 @@ include $(CLEAR_VARS)
 LOCAL_MODULE := flatbuffers_extra
 LOCAL_SRC_FILES := src/idl_parser.cpp \
                    src/idl_gen_text.cpp \
+                   src/ndjson.cpp \
                    src/reflection.cpp \
                    src/util.cpp
 LOCAL_STATIC_LIBRARIES := flatbuffers
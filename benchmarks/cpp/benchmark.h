@@ -0,0 +1,49 @@
+/*
+ * Copyright 2020 Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FLATBUFFERS_BENCHMARK_H_
+#define FLATBUFFERS_BENCHMARK_H_
+
+#include <cstddef>
+
+// Minimal timing harness for the C++ benchmarks, without external
+// dependencies. A benchmark runs `iterations` times the operation it measures,
+// and reports how many bytes of input it processed per iteration (0 if that
+// is not meaningful):
+//
+//   FLATBUFFERS_BENCHMARK(ParseSomething) {
+//     for (size_t i = 0; i < iterations; i++) { ... }
+//     return input.size();
+//   }
+//
+// Run the `flatbenchmark` binary with an optional substring to select
+// benchmarks by name.
+
+typedef size_t (*BenchmarkFunction)(size_t iterations);
+
+struct BenchmarkRegistrar {
+  BenchmarkRegistrar(const char *name, BenchmarkFunction fn);
+};
+
+// Prevents the compiler from optimizing away a computed value.
+void DoNotOptimize(const void *p);
+
+#define FLATBUFFERS_BENCHMARK(NAME)                                  \
+  static size_t NAME(size_t iterations);                             \
+  static BenchmarkRegistrar NAME##_registrar(#NAME, NAME);           \
+  static size_t NAME(size_t iterations)
+
+#endif  // FLATBUFFERS_BENCHMARK_H_
@@ -0,0 +1,78 @@
+/*
+ * Copyright 2020 Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "benchmark.h"
+
+namespace {
+
+struct Benchmark {
+  const char *name;
+  BenchmarkFunction fn;
+};
+
+// Written through a volatile pointer so computations feeding it are kept.
+const void *volatile optimization_sink;
+
+std::vector<Benchmark> &Benchmarks() {
+  static std::vector<Benchmark> benchmarks;
+  return benchmarks;
+}
+
+double Seconds(size_t (*fn)(size_t), size_t iterations, size_t *bytes) {
+  auto start = std::chrono::steady_clock::now();
+  *bytes = fn(iterations);
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double>(end - start).count();
+}
+
+}  // namespace
+
+BenchmarkRegistrar::BenchmarkRegistrar(const char *name, BenchmarkFunction fn) {
+  Benchmark b = { name, fn };
+  Benchmarks().push_back(b);
+}
+
+void DoNotOptimize(const void *p) { optimization_sink = p; }
+
+int main(int argc, const char *argv[]) {
+  const char *filter = argc > 1 ? argv[1] : "";
+  printf("%-40s %14s %12s %12s\n", "benchmark", "iterations", "ns/iter",
+         "MB/s");
+  for (auto it = Benchmarks().begin(); it != Benchmarks().end(); ++it) {
+    if (!strstr(it->name, filter)) continue;
+    // Grow the iteration count until a run takes long enough to time.
+    size_t iterations = 1, bytes = 0;
+    auto secs = Seconds(it->fn, iterations, &bytes);
+    while (secs < 0.5 && iterations < (static_cast<size_t>(1) << 40)) {
+      auto scale = secs > 0.01 ? 0.6 / secs : 100.0;
+      iterations = static_cast<size_t>(static_cast<double>(iterations) * scale) + 1;
+      secs = Seconds(it->fn, iterations, &bytes);
+    }
+    auto per_iter = secs / static_cast<double>(iterations);
+    printf("%-40s %14lu %12.0f", it->name,
+           static_cast<unsigned long>(iterations), per_iter * 1e9);
+    if (bytes) {
+      printf(" %12.1f", static_cast<double>(bytes) / per_iter / 1e6);
+    }
+    printf("\n");
+  }
+  return 0;
+}
@@ -0,0 +1,233 @@
+/*
+ * Copyright 2020 Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Throughput and latency of the generated MonsterStorage service over an
+// in-process channel, for requests of several sizes built in place in gRPC
+// slices by a MessageBuilder, or built by a FlatBufferBuilder and then copied
+// into a slice.
+//
+// Run the `grpcbenchmark` binary with an optional substring to select
+// benchmarks by name, e.g. "bidi" or "copy".
+
+#include <grpc++/grpc++.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "monster_test.grpc.fb.h"
+#include "monster_test_generated.h"
+
+using namespace MyGame::Example;
+
+namespace {
+
+// Replies to each request with the size of its inventory, so that the server
+// reads every request the way a real handler would.
+class BenchService final : public MonsterStorage::Service {
+  virtual ::grpc::Status Store(
+      ::grpc::ServerContext * /*context*/,
+      const flatbuffers::grpc::Message<Monster> *request,
+      flatbuffers::grpc::Message<Stat> *response) override {
+    *response = Reply(*request);
+    return ::grpc::Status::OK;
+  }
+
+  virtual ::grpc::Status GetMinMaxHitPoints(
+      ::grpc::ServerContext * /*context*/,
+      ::grpc::ServerReaderWriter<flatbuffers::grpc::Message<Stat>,
+                                 flatbuffers::grpc::Message<Monster>> *stream)
+      override {
+    flatbuffers::grpc::Message<Monster> request;
+    while (stream->Read(&request)) {
+      if (!stream->Write(Reply(request))) break;
+    }
+    return ::grpc::Status::OK;
+  }
+
+ private:
+  static flatbuffers::grpc::Message<Stat> Reply(
+      const flatbuffers::grpc::Message<Monster> &request) {
+    auto inventory = request.GetRoot()->inventory();
+    flatbuffers::grpc::MessageBuilder mbb;
+    mbb.Finish(CreateStat(mbb, 0, inventory ? inventory->size() : 0));
+    return mbb.ReleaseMessage<Stat>();
+  }
+};
+
+enum Serialization { kMessageBuilder, kPooledMessageBuilder, kCopy };
+
+const char *SerializationName(Serialization serialization) {
+  switch (serialization) {
+    case kMessageBuilder: return "message_builder";
+    case kPooledMessageBuilder: return "slice_pool";
+    default: return "copy";
+  }
+}
+
+template<class Builder>
+flatbuffers::Offset<Monster> PopulateRequest(
+    Builder &fbb, const std::vector<uint8_t> &payload) {
+  auto name = fbb.CreateString("Fred");
+  auto inventory = fbb.CreateVector(payload);
+  return CreateMonster(fbb, 0, 100, 80, name, inventory);
+}
+
+// Builds a request the way the serialization being measured does.
+flatbuffers::grpc::Message<Monster> BuildRequest(
+    Serialization serialization, const std::vector<uint8_t> &payload,
+    flatbuffers::grpc::SlicePool *pool) {
+  if (serialization == kCopy) {
+    flatbuffers::FlatBufferBuilder fbb(payload.size() + 64);
+    fbb.Finish(PopulateRequest(fbb, payload));
+    auto slice = grpc_slice_from_copied_buffer(
+        reinterpret_cast<const char *>(fbb.GetBufferPointer()), fbb.GetSize());
+    return flatbuffers::grpc::Message<Monster>(slice, false);
+  }
+  auto initial_size = static_cast<flatbuffers::uoffset_t>(payload.size() + 64);
+  flatbuffers::grpc::MessageBuilder mbb =
+      serialization == kPooledMessageBuilder
+          ? flatbuffers::grpc::MessageBuilder(pool, initial_size)
+          : flatbuffers::grpc::MessageBuilder(initial_size);
+  mbb.Finish(PopulateRequest(mbb, payload));
+  return mbb.ReleaseMessage<Monster>();
+}
+
+double Microseconds(std::chrono::steady_clock::duration d) {
+  return std::chrono::duration<double, std::micro>(d).count();
+}
+
+void Report(const char *rpc, Serialization serialization, size_t size,
+            double seconds, std::vector<double> &latencies) {
+  std::sort(latencies.begin(), latencies.end());
+  auto count = latencies.size();
+  auto name = std::string(rpc) + "/" + SerializationName(serialization) + "/" +
+              std::to_string(size);
+  printf("%-40s %10lu %12.0f %10.1f %10.1f %10.1f\n", name.c_str(),
+         static_cast<unsigned long>(count),
+         static_cast<double>(count) / seconds,
+         static_cast<double>(count * size) / seconds / 1e6,
+         latencies[count / 2], latencies[count * 99 / 100]);
+}
+
+// Returns false if an RPC failed. Only reports if `report` is set, so runs
+// can be used to warm up.
+bool RunUnary(MonsterStorage::Stub *stub, Serialization serialization,
+              const std::vector<uint8_t> &payload, size_t iterations,
+              flatbuffers::grpc::SlicePool *pool, bool report) {
+  std::vector<double> latencies;
+  latencies.reserve(iterations);
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < iterations; i++) {
+    auto rpc_start = std::chrono::steady_clock::now();
+    auto request = BuildRequest(serialization, payload, pool);
+    grpc::ClientContext context;
+    flatbuffers::grpc::Message<Stat> response;
+    if (!stub->Store(&context, request, &response).ok()) return false;
+    latencies.push_back(
+        Microseconds(std::chrono::steady_clock::now() - rpc_start));
+  }
+  auto seconds = std::chrono::duration<double>(
+                     std::chrono::steady_clock::now() - start)
+                     .count();
+  if (report) {
+    Report("unary", serialization, payload.size(), seconds, latencies);
+  }
+  return true;
+}
+
+// Round trips on a single bidi stream, so latency excludes call setup.
+bool RunBidi(MonsterStorage::Stub *stub, Serialization serialization,
+             const std::vector<uint8_t> &payload, size_t iterations,
+             flatbuffers::grpc::SlicePool *pool, bool report) {
+  std::vector<double> latencies;
+  latencies.reserve(iterations);
+  grpc::ClientContext context;
+  auto stream = stub->GetMinMaxHitPoints(&context);
+  flatbuffers::grpc::Message<Stat> response;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < iterations; i++) {
+    auto rpc_start = std::chrono::steady_clock::now();
+    auto request = BuildRequest(serialization, payload, pool);
+    if (!stream->Write(request) || !stream->Read(&response)) return false;
+    latencies.push_back(
+        Microseconds(std::chrono::steady_clock::now() - rpc_start));
+  }
+  auto seconds = std::chrono::duration<double>(
+                     std::chrono::steady_clock::now() - start)
+                     .count();
+  stream->WritesDone();
+  if (!stream->Finish().ok()) return false;
+  if (report) {
+    Report("bidi", serialization, payload.size(), seconds, latencies);
+  }
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, const char *argv[]) {
+  const char *filter = argc > 1 ? argv[1] : "";
+  BenchService service;
+  grpc::ServerBuilder builder;
+  builder.RegisterService(&service);
+  // Large enough for the largest request.
+  builder.SetMaxReceiveMessageSize(64 * 1024 * 1024);
+  auto server = builder.BuildAndStart();
+  grpc::ChannelArguments args;
+  args.SetMaxReceiveMessageSize(64 * 1024 * 1024);
+  auto stub = MonsterStorage::NewStub(server->InProcessChannel(args));
+  flatbuffers::grpc::SlicePool pool;
+
+  printf("%-40s %10s %12s %10s %10s %10s\n", "benchmark", "messages", "msgs/s",
+         "MB/s", "p50 us", "p99 us");
+  const size_t sizes[] = { 64, 1024, 16 * 1024, 256 * 1024, 4 * 1024 * 1024 };
+  const Serialization serializations[] = { kMessageBuilder,
+                                           kPooledMessageBuilder, kCopy };
+  const char *rpcs[] = { "unary", "bidi" };
+  auto ok = true;
+  for (size_t r = 0; r < sizeof(rpcs) / sizeof(rpcs[0]); r++) {
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+      std::vector<uint8_t> payload(sizes[s]);
+      for (size_t i = 0; i < payload.size(); i++)
+        payload[i] = static_cast<uint8_t>(i * 31);
+      // About 256MB of requests per benchmark, within bounds.
+      auto iterations = std::max<size_t>(
+          100, std::min<size_t>(20000, (256 << 20) / sizes[s]));
+      for (size_t i = 0;
+           i < sizeof(serializations) / sizeof(serializations[0]); i++) {
+        auto name = std::string(rpcs[r]) + "/" +
+                    SerializationName(serializations[i]) + "/" +
+                    std::to_string(sizes[s]);
+        if (!strstr(name.c_str(), filter)) continue;
+        // Warm up the channel and the slice pool first.
+        auto run = r ? RunBidi : RunUnary;
+        ok = run(stub.get(), serializations[i], payload, iterations / 10 + 1,
+                 &pool, false) &&
+             run(stub.get(), serializations[i], payload, iterations, &pool,
+                 true) &&
+             ok;
+      }
+    }
+  }
+  server->Shutdown();
+  if (!ok) printf("RPC FAILED\n");
+  return ok ? 0 : 1;
+}
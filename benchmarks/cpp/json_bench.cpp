@@ -0,0 +1,156 @@
+/*
+ * Copyright 2020 Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Benchmarks of JSON parsing and generation.
+
+#include "benchmark.h"
+#include "flatbuffers/idl.h"
+#include "flatbuffers/util.h"
+
+namespace {
+
+const char *kFloatSchema =
+    "table Sample { x:double; y:double; z:float; t:long; }"
+    "table Samples { samples:[Sample]; values:[double]; }"
+    "root_type Samples;";
+
+const char *kTextSchema =
+    "table Entry { key:string; text:string; }"
+    "table Entries { entries:[Entry]; }"
+    "root_type Entries;";
+
+// Deterministic pseudo-random numbers, like tests/test.cpp.
+uint32_t lcg_seed = 48271;
+uint32_t lcg_rand() {
+  return lcg_seed =
+             (static_cast<uint64_t>(lcg_seed) * 279470273UL) % 4294967291UL;
+}
+
+// A float-heavy JSON document: sensor-like samples plus a flat array.
+const std::string &FloatJson() {
+  static std::string json;
+  if (!json.empty()) return json;
+  json = "{ samples: [";
+  for (int i = 0; i < 20000; i++) {
+    json += "{ x: " + flatbuffers::NumToString(lcg_rand() / 1e5 - 20000.0) +
+            ", y: " + flatbuffers::NumToString(lcg_rand() / 3e9) +
+            ", z: " + flatbuffers::NumToString(lcg_rand() / 7.0f) +
+            ", t: " + flatbuffers::NumToString(1580000000000LL + i) + " },\n";
+  }
+  json += "], values: [";
+  for (int i = 0; i < 100000; i++) {
+    json += flatbuffers::NumToString((lcg_rand() % 2000000) / 1000.0 - 1000) +
+            ", ";
+  }
+  json += "] }";
+  return json;
+}
+
+// A string-heavy, indented JSON document, the way GenerateText prints it.
+const std::string &TextJson() {
+  static std::string json;
+  if (!json.empty()) return json;
+  json = "{\n  entries: [\n";
+  for (int i = 0; i < 20000; i++) {
+    json += "    {\n      key: \"entry_" + flatbuffers::NumToString(i) +
+            "\",\n      text: \"";
+    auto len = 20 + lcg_rand() % 200;
+    for (uint32_t j = 0; j < len; j++) {
+      json += static_cast<char>('a' + lcg_rand() % 27);
+      if (json.back() == '{') json.back() = ' ';
+    }
+    json += "\"\n    },\n";
+  }
+  json += "  ]\n}\n";
+  return json;
+}
+
+// The numbers of the document above, as separate strings.
+const std::vector<std::string> &FloatStrings() {
+  static std::vector<std::string> strings;
+  if (!strings.empty()) return strings;
+  for (int i = 0; i < 10000; i++) {
+    strings.push_back(flatbuffers::NumToString(lcg_rand() / 1e5 - 20000.0));
+    strings.push_back(flatbuffers::NumToString(lcg_rand() / 7.0f));
+  }
+  return strings;
+}
+
+FLATBUFFERS_BENCHMARK(ParseFloatHeavyJson) {
+  const auto &json = FloatJson();
+  flatbuffers::Parser parser;
+  if (!parser.Parse(kFloatSchema)) return 0;
+  for (size_t i = 0; i < iterations; i++) {
+    if (!parser.Parse(json.c_str())) return 0;
+    DoNotOptimize(parser.builder_.GetBufferPointer());
+  }
+  return json.size();
+}
+
+FLATBUFFERS_BENCHMARK(ParseStringHeavyJson) {
+  const auto &json = TextJson();
+  flatbuffers::Parser parser;
+  if (!parser.Parse(kTextSchema)) return 0;
+  for (size_t i = 0; i < iterations; i++) {
+    if (!parser.Parse(json.c_str())) return 0;
+    DoNotOptimize(parser.builder_.GetBufferPointer());
+  }
+  return json.size();
+}
+
+FLATBUFFERS_BENCHMARK(GenerateFloatHeavyJson) {
+  flatbuffers::Parser parser;
+  if (!parser.Parse(kFloatSchema) || !parser.Parse(FloatJson().c_str()))
+    return 0;
+  std::string text;
+  for (size_t i = 0; i < iterations; i++) {
+    text.clear();
+    if (!GenerateText(parser, parser.builder_.GetBufferPointer(), &text))
+      return 0;
+    DoNotOptimize(text.data());
+  }
+  return text.size();
+}
+
+FLATBUFFERS_BENCHMARK(StringToNumberDouble) {
+  const auto &strings = FloatStrings();
+  size_t bytes = 0;
+  for (size_t i = 0; i < iterations; i++) {
+    const auto &s = strings[i % strings.size()];
+    double d;
+    flatbuffers::StringToNumber(s.c_str(), &d);
+    DoNotOptimize(&d);
+    bytes += s.size();
+  }
+  return bytes / (iterations ? iterations : 1);
+}
+
+// The strtod-based conversion StringToNumber falls back to.
+FLATBUFFERS_BENCHMARK(StrtodDouble) {
+  const auto &strings = FloatStrings();
+  size_t bytes = 0;
+  for (size_t i = 0; i < iterations; i++) {
+    const auto &s = strings[i % strings.size()];
+    double d;
+    char *end;
+    flatbuffers::strtoval_impl(&d, s.c_str(), &end);
+    DoNotOptimize(&d);
+    bytes += s.size();
+  }
+  return bytes / (iterations ? iterations : 1);
+}
+
+}  // namespace
@@ -153,7 +153,26 @@ grpc::string GetHeaderIncludes(grpc_generator::File *file,
         "grpc++/impl/codegen/status.h",
         "grpc++/impl/codegen/stub_options.h",
         "grpc++/impl/codegen/sync_stream.h"};
-    std::vector<grpc::string> headers(headers_strs, array_end(headers_strs));
+    // gRPC versions with the callback API declare the method handlers in
+    // method_handler.h, and no longer in method_handler_impl.h.
+    static const char *callback_headers_strs[] = {
+        "grpcpp/impl/codegen/server_callback_handlers.h",
+        "grpcpp/impl/rpc_method.h",
+        "grpcpp/impl/serialization_traits.h",
+        "grpcpp/impl/service_type.h",
+        "grpcpp/support/async_stream.h",
+        "grpcpp/support/async_unary_call.h",
+        "grpcpp/support/client_callback.h",
+        "grpcpp/support/method_handler.h",
+        "grpcpp/support/server_callback.h",
+        "grpcpp/support/status.h",
+        "grpcpp/support/stub_options.h",
+        "grpcpp/support/sync_stream.h"};
+    std::vector<grpc::string> headers =
+        params.generate_callback_api
+            ? std::vector<grpc::string>(callback_headers_strs,
+                                        array_end(callback_headers_strs))
+            : std::vector<grpc::string>(headers_strs, array_end(headers_strs));
     PrintIncludes(printer.get(), headers, params);
     printer->Print(vars, "\n");
     printer->Print(vars, "namespace grpc {\n");
@@ -577,6 +596,46 @@ void PrintHeaderClientMethod(grpc_generator::Printer *printer,
   }
 }
 
+// Prints the callback overloads of a client method, either as pure virtual
+// members of the async interface or as overrides in the stub.
+void PrintHeaderClientMethodCallback(
+    grpc_generator::Printer *printer, const grpc_generator::Method *method,
+    std::map<grpc::string, grpc::string> *vars, bool is_interface) {
+  (*vars)["Method"] = method->name();
+  (*vars)["Request"] = method->input_type_name();
+  (*vars)["Response"] = method->output_type_name();
+  (*vars)["Virtual"] = is_interface ? "virtual " : "";
+  (*vars)["Suffix"] = is_interface ? " = 0" : " override";
+
+  if (method->NoStreaming()) {
+    printer->Print(*vars,
+                   "$Virtual$void $Method$(::grpc::ClientContext* context, "
+                   "const $Request$* request, $Response$* response, "
+                   "std::function<void(::grpc::Status)>)$Suffix$;\n");
+    printer->Print(*vars,
+                   "$Virtual$void $Method$(::grpc::ClientContext* context, "
+                   "const $Request$* request, $Response$* response, "
+                   "::grpc::ClientUnaryReactor* reactor)$Suffix$;\n");
+  } else if (ClientOnlyStreaming(method)) {
+    printer->Print(*vars,
+                   "$Virtual$void $Method$(::grpc::ClientContext* context, "
+                   "$Response$* response, "
+                   "::grpc::ClientWriteReactor< $Request$>* reactor)"
+                   "$Suffix$;\n");
+  } else if (ServerOnlyStreaming(method)) {
+    printer->Print(*vars,
+                   "$Virtual$void $Method$(::grpc::ClientContext* context, "
+                   "const $Request$* request, "
+                   "::grpc::ClientReadReactor< $Response$>* reactor)"
+                   "$Suffix$;\n");
+  } else if (method->BidiStreaming()) {
+    printer->Print(*vars,
+                   "$Virtual$void $Method$(::grpc::ClientContext* context, "
+                   "::grpc::ClientBidiReactor< $Request$, $Response$>* "
+                   "reactor)$Suffix$;\n");
+  }
+}
+
 void PrintHeaderClientMethodData(grpc_generator::Printer *printer,
                                  const grpc_generator::Method *method,
                                  std::map<grpc::string, grpc::string> *vars) {
@@ -734,6 +793,138 @@ void PrintHeaderServerMethodAsync(grpc_generator::Printer *printer,
   printer->Print(*vars, "};\n");
 }
 
+void PrintHeaderServerMethodCallback(
+    grpc_generator::Printer *printer, const grpc_generator::Method *method,
+    std::map<grpc::string, grpc::string> *vars) {
+  (*vars)["Method"] = method->name();
+  (*vars)["Request"] = method->input_type_name();
+  (*vars)["Response"] = method->output_type_name();
+  printer->Print(*vars, "template <class BaseClass>\n");
+  printer->Print(*vars,
+                 "class WithCallbackMethod_$Method$ : public BaseClass {\n");
+  printer->Print(
+      " private:\n"
+      "  void BaseClassMustBeDerivedFromService(const Service *service) {}\n");
+  printer->Print(" public:\n");
+  printer->Indent();
+  printer->Print(*vars, "WithCallbackMethod_$Method$() {\n");
+  if (method->NoStreaming()) {
+    printer->Print(
+        *vars,
+        "  ::grpc::Service::MarkMethodCallback($Idx$,\n"
+        "      new ::grpc::internal::CallbackUnaryHandler< "
+        "$Request$, $Response$>(\n"
+        "          [this](::grpc::CallbackServerContext* context, "
+        "const $Request$* request, $Response$* response) {\n"
+        "            return this->$Method$(context, request, response);\n"
+        "          }));\n");
+  } else if (ClientOnlyStreaming(method)) {
+    printer->Print(
+        *vars,
+        "  ::grpc::Service::MarkMethodCallback($Idx$,\n"
+        "      new ::grpc::internal::CallbackClientStreamingHandler< "
+        "$Request$, $Response$>(\n"
+        "          [this](::grpc::CallbackServerContext* context, "
+        "$Response$* response) {\n"
+        "            return this->$Method$(context, response);\n"
+        "          }));\n");
+  } else if (ServerOnlyStreaming(method)) {
+    printer->Print(
+        *vars,
+        "  ::grpc::Service::MarkMethodCallback($Idx$,\n"
+        "      new ::grpc::internal::CallbackServerStreamingHandler< "
+        "$Request$, $Response$>(\n"
+        "          [this](::grpc::CallbackServerContext* context, "
+        "const $Request$* request) {\n"
+        "            return this->$Method$(context, request);\n"
+        "          }));\n");
+  } else if (method->BidiStreaming()) {
+    printer->Print(
+        *vars,
+        "  ::grpc::Service::MarkMethodCallback($Idx$,\n"
+        "      new ::grpc::internal::CallbackBidiHandler< "
+        "$Request$, $Response$>(\n"
+        "          [this](::grpc::CallbackServerContext* context) {\n"
+        "            return this->$Method$(context);\n"
+        "          }));\n");
+  }
+  printer->Print("}\n");
+  printer->Print(*vars,
+                 "~WithCallbackMethod_$Method$() override {\n"
+                 "  BaseClassMustBeDerivedFromService(this);\n"
+                 "}\n");
+  // A null reactor makes gRPC fail the call with UNIMPLEMENTED.
+  if (method->NoStreaming()) {
+    printer->Print(
+        *vars,
+        "// disable synchronous version of this method\n"
+        "::grpc::Status $Method$("
+        "::grpc::ServerContext* context, const $Request$* request, "
+        "$Response$* response) final override {\n"
+        "  abort();\n"
+        "  return ::grpc::Status(::grpc::StatusCode::UNIMPLEMENTED, \"\");\n"
+        "}\n");
+    printer->Print(*vars,
+                   "virtual ::grpc::ServerUnaryReactor* $Method$("
+                   "::grpc::CallbackServerContext* context, "
+                   "const $Request$* request, $Response$* response) {\n"
+                   "  return nullptr;\n"
+                   "}\n");
+  } else if (ClientOnlyStreaming(method)) {
+    printer->Print(
+        *vars,
+        "// disable synchronous version of this method\n"
+        "::grpc::Status $Method$("
+        "::grpc::ServerContext* context, "
+        "::grpc::ServerReader< $Request$>* reader, "
+        "$Response$* response) final override {\n"
+        "  abort();\n"
+        "  return ::grpc::Status(::grpc::StatusCode::UNIMPLEMENTED, \"\");\n"
+        "}\n");
+    printer->Print(*vars,
+                   "virtual ::grpc::ServerReadReactor< $Request$>* $Method$("
+                   "::grpc::CallbackServerContext* context, "
+                   "$Response$* response) {\n"
+                   "  return nullptr;\n"
+                   "}\n");
+  } else if (ServerOnlyStreaming(method)) {
+    printer->Print(
+        *vars,
+        "// disable synchronous version of this method\n"
+        "::grpc::Status $Method$("
+        "::grpc::ServerContext* context, const $Request$* request, "
+        "::grpc::ServerWriter< $Response$>* writer) final override "
+        "{\n"
+        "  abort();\n"
+        "  return ::grpc::Status(::grpc::StatusCode::UNIMPLEMENTED, \"\");\n"
+        "}\n");
+    printer->Print(*vars,
+                   "virtual ::grpc::ServerWriteReactor< $Response$>* "
+                   "$Method$(::grpc::CallbackServerContext* context, "
+                   "const $Request$* request) {\n"
+                   "  return nullptr;\n"
+                   "}\n");
+  } else if (method->BidiStreaming()) {
+    printer->Print(
+        *vars,
+        "// disable synchronous version of this method\n"
+        "::grpc::Status $Method$("
+        "::grpc::ServerContext* context, "
+        "::grpc::ServerReaderWriter< $Response$, $Request$>* stream) "
+        "final override {\n"
+        "  abort();\n"
+        "  return ::grpc::Status(::grpc::StatusCode::UNIMPLEMENTED, \"\");\n"
+        "}\n");
+    printer->Print(*vars,
+                   "virtual ::grpc::ServerBidiReactor< $Request$, $Response$>* "
+                   "$Method$(::grpc::CallbackServerContext* context) {\n"
+                   "  return nullptr;\n"
+                   "}\n");
+  }
+  printer->Outdent();
+  printer->Print(*vars, "};\n");
+}
+
 void PrintHeaderServerMethodStreamedUnary(
     grpc_generator::Printer *printer, const grpc_generator::Method *method,
     std::map<grpc::string, grpc::string> *vars) {
@@ -910,7 +1101,8 @@ void PrintHeaderServerMethodGeneric(
 
 void PrintHeaderService(grpc_generator::Printer *printer,
                         const grpc_generator::Service *service,
-                        std::map<grpc::string, grpc::string> *vars) {
+                        std::map<grpc::string, grpc::string> *vars,
+                        const Parameters &params) {
   (*vars)["Service"] = service->name();
 
   printer->Print(service->GetLeadingComments("//").c_str());
@@ -937,6 +1129,21 @@ void PrintHeaderService(grpc_generator::Printer *printer,
                                       true);
     printer->Print(service->method(i)->GetTrailingComments("//").c_str());
   }
+  if (params.generate_callback_api) {
+    printer->Print(
+        "class async_interface {\n"
+        " public:\n");
+    printer->Indent();
+    printer->Print("virtual ~async_interface() {}\n");
+    for (int i = 0; i < service->method_count(); ++i) {
+      PrintHeaderClientMethodCallback(printer, service->method(i).get(), vars,
+                                      true);
+    }
+    printer->Outdent();
+    printer->Print("};\n");
+    printer->Print(
+        "virtual class async_interface* async() { return nullptr; }\n");
+  }
   printer->Outdent();
   printer->Print("private:\n");
   printer->Indent();
@@ -956,10 +1163,32 @@ void PrintHeaderService(grpc_generator::Printer *printer,
   for (int i = 0; i < service->method_count(); ++i) {
     PrintHeaderClientMethod(printer, service->method(i).get(), vars, true);
   }
+  if (params.generate_callback_api) {
+    printer->Print(
+        "class async final : public StubInterface::async_interface {\n"
+        " public:\n");
+    printer->Indent();
+    for (int i = 0; i < service->method_count(); ++i) {
+      PrintHeaderClientMethodCallback(printer, service->method(i).get(), vars,
+                                      false);
+    }
+    printer->Outdent();
+    printer->Print(
+        " private:\n"
+        "  friend class Stub;\n"
+        "  explicit async(Stub* stub) : stub_(stub) {}\n"
+        "  Stub* stub_;\n"
+        "};\n");
+    printer->Print(
+        "class async* async() override { return &async_stub_; }\n");
+  }
   printer->Outdent();
   printer->Print("\n private:\n");
   printer->Indent();
   printer->Print("std::shared_ptr< ::grpc::ChannelInterface> channel_;\n");
+  if (params.generate_callback_api) {
+    printer->Print("class async async_stub_{this};\n");
+  }
   for (int i = 0; i < service->method_count(); ++i) {
     PrintHeaderClientMethod(printer, service->method(i).get(), vars, false);
   }
@@ -1006,6 +1235,25 @@ void PrintHeaderService(grpc_generator::Printer *printer,
   }
   printer->Print(" AsyncService;\n");
 
+  // Server side - Callback
+  if (params.generate_callback_api) {
+    for (int i = 0; i < service->method_count(); ++i) {
+      (*vars)["Idx"] = as_string(i);
+      PrintHeaderServerMethodCallback(printer, service->method(i).get(), vars);
+    }
+
+    printer->Print("typedef ");
+    for (int i = 0; i < service->method_count(); ++i) {
+      (*vars)["method_name"] = service->method(i).get()->name();
+      printer->Print(*vars, "WithCallbackMethod_$method_name$<");
+    }
+    printer->Print("Service");
+    for (int i = 0; i < service->method_count(); ++i) {
+      printer->Print(" >");
+    }
+    printer->Print(" CallbackService;\n");
+  }
+
   // Server side - Generic
   for (int i = 0; i < service->method_count(); ++i) {
     (*vars)["Idx"] = as_string(i);
@@ -1105,7 +1353,7 @@ grpc::string GetHeaderServices(grpc_generator::File *file,
     }
 
     for (int i = 0; i < file->service_count(); ++i) {
-      PrintHeaderService(printer.get(), file->service(i).get(), &vars);
+      PrintHeaderService(printer.get(), file->service(i).get(), &vars, params);
       printer->Print("\n");
     }
 
@@ -1187,7 +1435,23 @@ grpc::string GetSourceIncludes(grpc_generator::File *file,
         "grpc++/impl/codegen/rpc_service_method.h",
         "grpc++/impl/codegen/service_type.h",
         "grpc++/impl/codegen/sync_stream.h"};
-    std::vector<grpc::string> headers(headers_strs, array_end(headers_strs));
+    // See GetHeaderIncludes().
+    static const char *callback_headers_strs[] = {
+        "grpcpp/impl/channel_interface.h",
+        "grpcpp/impl/client_unary_call.h",
+        "grpcpp/impl/codegen/server_callback_handlers.h",
+        "grpcpp/impl/rpc_service_method.h",
+        "grpcpp/impl/service_type.h",
+        "grpcpp/support/async_stream.h",
+        "grpcpp/support/async_unary_call.h",
+        "grpcpp/support/client_callback.h",
+        "grpcpp/support/method_handler.h",
+        "grpcpp/support/sync_stream.h"};
+    std::vector<grpc::string> headers =
+        params.generate_callback_api
+            ? std::vector<grpc::string>(callback_headers_strs,
+                                        array_end(callback_headers_strs))
+            : std::vector<grpc::string>(headers_strs, array_end(headers_strs));
     PrintIncludes(printer.get(), headers, params);
 
     if (!file->package().empty()) {
@@ -1344,6 +1608,67 @@ void PrintSourceClientMethod(grpc_generator::Printer *printer,
   }
 }
 
+void PrintSourceClientMethodCallback(
+    grpc_generator::Printer *printer, const grpc_generator::Method *method,
+    std::map<grpc::string, grpc::string> *vars) {
+  (*vars)["Method"] = method->name();
+  (*vars)["Request"] = method->input_type_name();
+  (*vars)["Response"] = method->output_type_name();
+  if (method->NoStreaming()) {
+    printer->Print(*vars,
+                   "void $ns$$Service$::Stub::async::$Method$("
+                   "::grpc::ClientContext* context, "
+                   "const $Request$* request, $Response$* response, "
+                   "std::function<void(::grpc::Status)> f) {\n");
+    printer->Print(*vars,
+                   "  ::grpc::internal::CallbackUnaryCall< $Request$, "
+                   "$Response$>(stub_->channel_.get(), "
+                   "stub_->rpcmethod_$Method$_, "
+                   "context, request, response, std::move(f));\n}\n\n");
+    printer->Print(*vars,
+                   "void $ns$$Service$::Stub::async::$Method$("
+                   "::grpc::ClientContext* context, "
+                   "const $Request$* request, $Response$* response, "
+                   "::grpc::ClientUnaryReactor* reactor) {\n");
+    printer->Print(*vars,
+                   "  ::grpc::internal::ClientCallbackUnaryFactory::Create"
+                   "< $Request$, $Response$>(stub_->channel_.get(), "
+                   "stub_->rpcmethod_$Method$_, "
+                   "context, request, response, reactor);\n}\n\n");
+  } else if (ClientOnlyStreaming(method)) {
+    printer->Print(*vars,
+                   "void $ns$$Service$::Stub::async::$Method$("
+                   "::grpc::ClientContext* context, $Response$* response, "
+                   "::grpc::ClientWriteReactor< $Request$>* reactor) {\n");
+    printer->Print(*vars,
+                   "  ::grpc::internal::ClientCallbackWriterFactory< "
+                   "$Request$>::Create(stub_->channel_.get(), "
+                   "stub_->rpcmethod_$Method$_, "
+                   "context, response, reactor);\n}\n\n");
+  } else if (ServerOnlyStreaming(method)) {
+    printer->Print(*vars,
+                   "void $ns$$Service$::Stub::async::$Method$("
+                   "::grpc::ClientContext* context, const $Request$* request, "
+                   "::grpc::ClientReadReactor< $Response$>* reactor) {\n");
+    printer->Print(*vars,
+                   "  ::grpc::internal::ClientCallbackReaderFactory< "
+                   "$Response$>::Create(stub_->channel_.get(), "
+                   "stub_->rpcmethod_$Method$_, "
+                   "context, request, reactor);\n}\n\n");
+  } else if (method->BidiStreaming()) {
+    printer->Print(*vars,
+                   "void $ns$$Service$::Stub::async::$Method$("
+                   "::grpc::ClientContext* context, "
+                   "::grpc::ClientBidiReactor< $Request$, $Response$>* "
+                   "reactor) {\n");
+    printer->Print(*vars,
+                   "  ::grpc::internal::ClientCallbackReaderWriterFactory< "
+                   "$Request$, $Response$>::Create(stub_->channel_.get(), "
+                   "stub_->rpcmethod_$Method$_, "
+                   "context, reactor);\n}\n\n");
+  }
+}
+
 void PrintSourceServerMethod(grpc_generator::Printer *printer,
                              const grpc_generator::Method *method,
                              std::map<grpc::string, grpc::string> *vars) {
@@ -1405,7 +1730,8 @@ void PrintSourceServerMethod(grpc_generator::Printer *printer,
 
 void PrintSourceService(grpc_generator::Printer *printer,
                         const grpc_generator::Service *service,
-                        std::map<grpc::string, grpc::string> *vars) {
+                        std::map<grpc::string, grpc::string> *vars,
+                        const Parameters &params) {
   (*vars)["Service"] = service->name();
 
   if (service->method_count() > 0) {
@@ -1460,6 +1786,9 @@ void PrintSourceService(grpc_generator::Printer *printer,
   for (int i = 0; i < service->method_count(); ++i) {
     (*vars)["Idx"] = as_string(i);
     PrintSourceClientMethod(printer, service->method(i).get(), vars);
+    if (params.generate_callback_api) {
+      PrintSourceClientMethodCallback(printer, service->method(i).get(), vars);
+    }
   }
 
   printer->Print(*vars, "$ns$$Service$::Service::Service() {\n");
@@ -1542,7 +1871,7 @@ grpc::string GetSourceServices(grpc_generator::File *file,
     }
 
     for (int i = 0; i < file->service_count(); ++i) {
-      PrintSourceService(printer.get(), file->service(i).get(), &vars);
+      PrintSourceService(printer.get(), file->service(i).get(), &vars, params);
       printer->Print("\n");
     }
   }
@@ -1608,7 +1937,17 @@ grpc::string GetMockIncludes(grpc_generator::File *file,
         "grpc++/impl/codegen/sync_stream.h",
         "gmock/gmock.h",
     };
-    std::vector<grpc::string> headers(headers_strs, array_end(headers_strs));
+    // See GetHeaderIncludes().
+    static const char *callback_headers_strs[] = {
+        "grpcpp/support/async_stream.h",
+        "grpcpp/support/sync_stream.h",
+        "gmock/gmock.h",
+    };
+    std::vector<grpc::string> headers =
+        params.generate_callback_api
+            ? std::vector<grpc::string>(callback_headers_strs,
+                                        array_end(callback_headers_strs))
+            : std::vector<grpc::string>(headers_strs, array_end(headers_strs));
     PrintIncludes(printer.get(), headers, params);
 
     if (!file->package().empty()) {
@@ -67,6 +67,8 @@ struct Parameters {
   grpc::string grpc_search_path;
   // Generate GMOCK code to facilitate unit testing.
   bool generate_mock_code;
+  // Also generate the callback (reactor) API, needs gRPC 1.33 or later.
+  bool generate_callback_api;
 };
 
 // Return the prologue of the generated header file.
@@ -0,0 +1,227 @@
+/*
+ * Copyright 2020 Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Exercises the code generated with --grpc-callback-api, which is checked in
+// as tests/grpc_callback/monster_test.grpc.fb.*. The callback API needs a
+// newer gRPC than grpc/build_grpc.sh builds, see
+// tests/docker/grpc_callback_test.run.sh.
+
+#include <grpcpp/grpcpp.h>
+
+#include <condition_variable>
+#include <mutex>
+
+#include "monster_test.grpc.fb.h"
+#include "monster_test_generated.h"
+#include "test_assert.h"
+
+using namespace MyGame::Example;
+using flatbuffers::grpc::Message;
+using flatbuffers::grpc::MessageBuilder;
+
+// Leaves Retrieve and GetMaxHitPoint without a reactor, so they report
+// UNIMPLEMENTED.
+class CallbackServiceImpl final : public MonsterStorage::CallbackService {
+  ::grpc::ServerUnaryReactor *Store(::grpc::CallbackServerContext *context,
+                                    const Message<Monster> *request,
+                                    Message<Stat> *response) override {
+    MessageBuilder mbb;
+    mbb.Finish(CreateStat(
+        mbb, mbb.CreateString("Hello, " + request->GetRoot()->name()->str())));
+    *response = mbb.ReleaseMessage<Stat>();
+    auto reactor = context->DefaultReactor();
+    reactor->Finish(::grpc::Status::OK);
+    return reactor;
+  }
+
+  // Answers each monster with its hit points, reusing one builder.
+  class HitPointsReactor
+      : public ::grpc::ServerBidiReactor<Message<Monster>, Message<Stat>> {
+   public:
+    HitPointsReactor() { StartRead(&request_); }
+
+    void OnReadDone(bool ok) override {
+      if (!ok) {
+        Finish(::grpc::Status::OK);
+        return;
+      }
+      mbb_.Finish(CreateStat(mbb_, 0, request_.GetRoot()->hp()));
+      response_ = mbb_.ReleaseMessage<Stat>();
+      StartWrite(&response_);
+    }
+    void OnWriteDone(bool ok) override {
+      if (ok) {
+        StartRead(&request_);
+      } else {
+        Finish(::grpc::Status::CANCELLED);
+      }
+    }
+    void OnDone() override { delete this; }
+
+   private:
+    MessageBuilder mbb_;
+    Message<Monster> request_;
+    Message<Stat> response_;
+  };
+
+  ::grpc::ServerBidiReactor<Message<Monster>, Message<Stat>> *
+  GetMinMaxHitPoints(::grpc::CallbackServerContext *) override {
+    return new HitPointsReactor();
+  }
+};
+
+// Blocks until Notify() was called.
+class Notification {
+ public:
+  Notification() : done_(false) {}
+  void Notify() {
+    std::lock_guard<std::mutex> lock(mu_);
+    done_ = true;
+    cv_.notify_one();
+  }
+  void Wait() {
+    std::unique_lock<std::mutex> lock(mu_);
+    cv_.wait(lock, [this] { return done_; });
+  }
+
+ private:
+  std::mutex mu_;
+  std::condition_variable cv_;
+  bool done_;
+};
+
+// Writes monsters with hit points 0 to count - 1 and sums the answers.
+class HitPointsClient
+    : public ::grpc::ClientBidiReactor<Message<Monster>, Message<Stat>> {
+ public:
+  HitPointsClient(MonsterStorage::Stub *stub, int count)
+      : count_(count), written_(0), sum_(0) {
+    stub->async()->GetMinMaxHitPoints(&context_, this);
+    StartRead(&response_);
+    Write();
+    StartCall();
+  }
+
+  void OnWriteDone(bool ok) override {
+    if (ok && written_ < count_) {
+      Write();
+    } else {
+      StartWritesDone();
+    }
+  }
+  void OnReadDone(bool ok) override {
+    if (!ok) return;
+    sum_ += response_.GetRoot()->val();
+    StartRead(&response_);
+  }
+  void OnDone(const ::grpc::Status &status) override {
+    status_ = status;
+    done_.Notify();
+  }
+
+  int64_t Await(::grpc::Status *status) {
+    done_.Wait();
+    *status = status_;
+    return sum_;
+  }
+
+ private:
+  void Write() {
+    mbb_.Finish(CreateMonster(mbb_, 0, 0, static_cast<int16_t>(written_++),
+                              mbb_.CreateString("Fred")));
+    request_ = mbb_.ReleaseMessage<Monster>();
+    StartWrite(&request_);
+  }
+
+  ::grpc::ClientContext context_;
+  MessageBuilder mbb_;
+  Message<Monster> request_;
+  Message<Stat> response_;
+  int count_;
+  int written_;
+  int64_t sum_;
+  ::grpc::Status status_;
+  Notification done_;
+};
+
+Message<Monster> MakeMonster(const char *name) {
+  MessageBuilder mbb;
+  mbb.Finish(CreateMonster(mbb, 0, 0, 0, mbb.CreateString(name)));
+  return mbb.ReleaseMessage<Monster>();
+}
+
+int main(int /*argc*/, const char * /*argv*/[]) {
+  CallbackServiceImpl service;
+  ::grpc::ServerBuilder builder;
+  builder.RegisterService(&service);
+  auto server = builder.BuildAndStart();
+  auto stub = MonsterStorage::NewStub(
+      server->InProcessChannel(::grpc::ChannelArguments()));
+
+  // A unary call through the callback client.
+  {
+    ::grpc::ClientContext context;
+    auto request = MakeMonster("Fred");
+    Message<Stat> response;
+    ::grpc::Status status;
+    Notification done;
+    stub->async()->Store(&context, &request, &response,
+                         [&](::grpc::Status s) {
+                           status = std::move(s);
+                           done.Notify();
+                         });
+    done.Wait();
+    TEST_EQ(status.ok(), true);
+    TEST_EQ_STR(response.GetRoot()->id()->c_str(), "Hello, Fred");
+  }
+
+  // The callback server also answers the synchronous client.
+  {
+    ::grpc::ClientContext context;
+    Message<Stat> response;
+    auto status = stub->Store(&context, MakeMonster("Wilma"), &response);
+    TEST_EQ(status.ok(), true);
+    TEST_EQ_STR(response.GetRoot()->id()->c_str(), "Hello, Wilma");
+  }
+
+  // A bidi stream, with a builder reused for each message on either side.
+  {
+    HitPointsClient client(stub.get(), 100);
+    ::grpc::Status status;
+    TEST_EQ(client.Await(&status), 99 * 100 / 2);
+    TEST_EQ(status.ok(), true);
+  }
+
+  // Methods without a reactor are unimplemented.
+  {
+    ::grpc::ClientContext context;
+    MessageBuilder mbb;
+    mbb.Finish(CreateStat(mbb, mbb.CreateString("Fred")));
+    auto reader = stub->Retrieve(&context, mbb.ReleaseMessage<Stat>());
+    Message<Monster> response;
+    TEST_EQ(reader->Read(&response), false);
+    TEST_EQ(reader->Finish().error_code(), ::grpc::StatusCode::UNIMPLEMENTED);
+  }
+
+  server->Shutdown();
+  if (!testing_fails) {
+    TEST_OUTPUT_LINE("ALL TESTS PASSED");
+    return 0;
+  } else {
+    TEST_OUTPUT_LINE("%d FAILED TESTS", testing_fails);
+    return 1;
+  }
+}
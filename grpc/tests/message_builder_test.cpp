@@ -195,6 +195,116 @@ void slice_allocator_tests() {
   }
 }
 
+void slice_pool_tests() {
+  flatbuffers::grpc::SlicePool pool;
+  const uint8_t *first_data = nullptr;
+  {
+    flatbuffers::grpc::MessageBuilder mb(&pool);
+    mb.Finish(populate1(mb));
+    auto msg = mb.ReleaseMessage<Monster>();
+    TEST_ASSERT_FUNC(verify(msg, m1_name(), m1_color()));
+    first_data = msg.data();
+    // The message still holds the slice.
+    TEST_EQ_FUNC(pool.cached_bytes(), 0);
+  }
+  TEST_ASSERT_FUNC(pool.cached_bytes() > 0);
+
+  // The next message of the same size reuses the memory.
+  {
+    flatbuffers::grpc::MessageBuilder mb(&pool);
+    mb.Finish(populate1(mb));
+    TEST_EQ_FUNC(pool.cached_bytes(), 0);
+    auto msg = mb.ReleaseMessage<Monster>();
+    TEST_ASSERT_FUNC(verify(msg, m1_name(), m1_color()));
+    TEST_EQ_FUNC(msg.data(), first_data);
+  }
+
+  // Growing the buffer takes bigger slices from the pool.
+  {
+    flatbuffers::grpc::MessageBuilder mb(&pool, 16);
+    std::vector<flatbuffers::grpc::Message<Monster>> msgs;
+    for (int i = 0; i < 5; ++i) {
+      mb.Finish(populate2(mb));
+      msgs.push_back(mb.ReleaseMessage<Monster>());
+      TEST_ASSERT_FUNC(verify(msgs[i], m2_name(), m2_color()));
+    }
+  }
+  pool.Trim();
+  TEST_EQ_FUNC(pool.cached_bytes(), 0);
+
+  // Messages may outlive the pool.
+  flatbuffers::grpc::Message<Monster> msg;
+  {
+    flatbuffers::grpc::SlicePool short_lived_pool;
+    flatbuffers::grpc::MessageBuilder mb(&short_lived_pool);
+    mb.Finish(populate1(mb));
+    msg = mb.ReleaseMessage<Monster>();
+  }
+  TEST_ASSERT_FUNC(verify(msg, m1_name(), m1_color()));
+}
+
+static int verify_stats_reports = 0;
+static flatbuffers::grpc::VerifyStats last_verify_stats;
+
+void record_verify_stats(const flatbuffers::grpc::VerifyStats &stats) {
+  verify_stats_reports++;
+  last_verify_stats = stats;
+}
+
+flatbuffers::grpc::Message<Monster> build_monster_with_enemy() {
+  flatbuffers::grpc::MessageBuilder mb;
+  auto enemy = populate2(mb);
+  auto name = mb.CreateString(m1_name());
+  MyGame::Example::MonsterBuilder builder(mb);
+  builder.add_name(name);
+  builder.add_color(m1_color());
+  builder.add_enemy(enemy);
+  mb.Finish(builder.Finish());
+  return mb.ReleaseMessage<Monster>();
+}
+
+void message_verify_tests() {
+  flatbuffers::grpc::SetVerifyStatsHook(&record_verify_stats);
+
+  // Verification is only done once.
+  {
+    auto msg = build_monster_with_enemy();
+    TEST_ASSERT_FUNC(msg.Verify());
+    TEST_ASSERT_FUNC(msg.Verify());
+    TEST_ASSERT_FUNC(msg.VerifyRoot());
+    TEST_EQ_FUNC(verify_stats_reports, 0);
+  }
+  TEST_EQ_FUNC(verify_stats_reports, 1);
+  TEST_EQ_FUNC(last_verify_stats.runs, 1);
+  TEST_EQ_FUNC(last_verify_stats.cache_hits, 2);
+  TEST_EQ_FUNC(last_verify_stats.tables, 2);
+  TEST_ASSERT_FUNC(last_verify_stats.size > 0);
+
+  // Lazy verification only verifies the tables that are read.
+  {
+    auto msg = build_monster_with_enemy();
+    TEST_ASSERT_FUNC(msg.VerifyRoot());
+    auto root = msg.GetRoot();
+    TEST_EQ_STR(root->name()->c_str(), m1_name().c_str());
+    TEST_ASSERT_FUNC(msg.VerifyTable(root->enemy()));
+    TEST_EQ_STR(root->enemy()->name()->c_str(), m2_name().c_str());
+    TEST_ASSERT_FUNC(msg.VerifyTable(root->test_as_Monster()));
+    // Moving a message moves its stats.
+    auto moved = std::move(msg);
+    TEST_ASSERT_FUNC(moved.Verify());
+  }
+  TEST_EQ_FUNC(verify_stats_reports, 2);
+  TEST_EQ_FUNC(last_verify_stats.runs, 3);
+  TEST_EQ_FUNC(last_verify_stats.cache_hits, 0);
+  TEST_EQ_FUNC(last_verify_stats.tables, 4);
+
+  // Messages that weren't verified aren't reported.
+  { auto msg = build_monster_with_enemy(); }
+  TEST_EQ_FUNC(verify_stats_reports, 2);
+
+  flatbuffers::grpc::SetVerifyStatsHook(nullptr);
+}
+
 /// This function does not populate exactly the first half of the table. But it
 /// could.
 void populate_first_half(MyGame::Example::MonsterBuilder &wrapper,
@@ -339,6 +449,8 @@ void message_builder_tests() {
   using flatbuffers::grpc::MessageBuilder;
 
   slice_allocator_tests();
+  slice_pool_tests();
+  message_verify_tests();
 
 #ifndef __APPLE__
   builder_move_ctor_conversion_before_finish_half_n_half_table_test();
@@ -2136,10 +2136,17 @@ class Verifier FLATBUFFERS_FINAL_CLASS {
         num_tables_(0),
         max_tables_(_max_tables),
         upper_bound_(0),
-        check_alignment_(_check_alignment) {
+        check_alignment_(_check_alignment),
+        lazy_depth_(static_cast<uoffset_t>(-1)) {
     FLATBUFFERS_ASSERT(size_ < FLATBUFFERS_MAX_BUFFER_SIZE);
   }
 
+  // Only verifies tables up to `depth` levels deep, e.g. 1 for just the root
+  // table. Tables below that are left unchecked, and each has to be verified
+  // with VerifyTable() before it is read, which is cheaper than verifying
+  // all of a large buffer when only parts of it are read.
+  void SetLazyDepth(uoffset_t depth) { lazy_depth_ = depth; }
+
   // Central location where any verification failures register.
   bool Check(bool ok) const {
     // clang-format off
@@ -2192,7 +2199,7 @@ class Verifier FLATBUFFERS_FINAL_CLASS {
 
   // Verify a pointer (may be NULL) of a table type.
   template<typename T> bool VerifyTable(const T *table) {
-    return !table || table->Verify(*this);
+    return !table || depth_ >= lazy_depth_ || table->Verify(*this);
   }
 
   // Verify a pointer (may be NULL) of any vector type.
@@ -2246,7 +2253,7 @@ class Verifier FLATBUFFERS_FINAL_CLASS {
   template<typename T> bool VerifyVectorOfTables(const Vector<Offset<T>> *vec) {
     if (vec) {
       for (uoffset_t i = 0; i < vec->size(); i++) {
-        if (!vec->Get(i)->Verify(*this)) return false;
+        if (!VerifyTable(vec->Get(i))) return false;
       }
     }
     return true;
@@ -2330,6 +2337,9 @@ class Verifier FLATBUFFERS_FINAL_CLASS {
     return true;
   }
 
+  // The number of tables verified so far.
+  uoffset_t GetNumTables() const { return num_tables_; }
+
   // Returns the message size in bytes
   size_t GetComputedSize() const {
     // clang-format off
@@ -2356,6 +2366,7 @@ class Verifier FLATBUFFERS_FINAL_CLASS {
   uoffset_t max_tables_;
   mutable size_t upper_bound_;
   bool check_alignment_;
+  uoffset_t lazy_depth_;
 };
 
 // Convenient way to bundle a buffer and its length, to pass it around
@@ -19,7 +19,11 @@
 
 #include <functional>
 #include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
 #include "flatbuffers/flatbuffers.h"
 #include "flatbuffers/idl.h"
@@ -73,26 +77,139 @@ class FlatCompiler {
     ErrorFn error_fn;
   };
 
-  explicit FlatCompiler(const InitParams &params) : params_(params) {}
+  explicit FlatCompiler(const InitParams &params)
+      : params_(params),
+        serving_(false),
+        include_cache_uses_(0),
+        includes_parsed_(0),
+        includes_reused_(0) {}
 
   int Compile(int argc, const char **argv);
 
   std::string GetUsageString(const char *program_name) const;
 
+  // Records a warning or error from a code generator against the input file
+  // being compiled on the calling thread. Returns false if the thread is not
+  // compiling one, in which case the caller reports the message itself.
+  static bool RecordGeneratorMessage(const std::string &text, bool error);
+
  private:
-  void ParseFile(flatbuffers::Parser &parser, const std::string &filename,
+  // Warnings, errors and make rules from compiling a group of input files.
+  // Groups may be compiled concurrently, so these are collected, and handed
+  // to the callbacks in input order once the group is done.
+  struct Report {
+    struct Message {
+      enum Kind { kWarning, kError, kOutput };
+      Kind kind;
+      std::string text;
+      bool usage;
+      bool show_exe_name;
+    };
+
+    void Warn(const std::string &warn, bool show_exe_name = true) {
+      Message m = { Message::kWarning, warn, false, show_exe_name };
+      messages.push_back(m);
+    }
+
+    // Returns false, for the caller to return in turn.
+    bool Error(const std::string &err, bool usage = true,
+               bool show_exe_name = true) {
+      Message m = { Message::kError, err, usage, show_exe_name };
+      messages.push_back(m);
+      return false;
+    }
+
+    void Print(const std::string &text) {
+      Message m = { Message::kOutput, text, false, false };
+      messages.push_back(m);
+    }
+
+    bool HasError() const {
+      for (auto it = messages.begin(); it != messages.end(); ++it)
+        if (it->kind == Message::kError) return true;
+      return false;
+    }
+
+    std::vector<Message> messages;
+  };
+
+  bool ParseFile(flatbuffers::Parser &parser, const std::string &filename,
                  const std::string &contents,
-                 std::vector<const char *> &include_directories) const;
+                 std::vector<const char *> &include_directories,
+                 Report *report) const;
+
+  bool LoadBinarySchema(Parser &parser, const std::string &filename,
+                        const std::string &contents, Report *report) const;
+
+  bool ConvertNdjson(flatbuffers::Parser &parser, const std::string &filename,
+                     const std::string &contents,
+                     const std::string &output_path, unsigned jobs,
+                     Report *report) const;
+
+  // Returns false if the report holds an error.
+  bool Replay(const Report &report) const;
+
+  static thread_local Report *current_report_;
+
+  // The include files of a schema, parsed by a server for other schemas that
+  // include the same files to parse on top of, along with the contents hash
+  // of every file read. The parser may be reused while none of them change.
+  struct CachedIncludes {
+    std::string key;
+    std::unique_ptr<Parser> parser;
+    std::vector<std::pair<std::string, uint64_t>> files;
+    uint64_t last_use;
+  };
+
+  // Beyond this many cached includes, the least recently used are dropped.
+  static const size_t kMaxCachedIncludes = 64;
+
+  // Parses the schema in filename into a parser of its includes kept by the
+  // server, which then replaces *parser, and is to be handed back with
+  // CacheIncludes() once done with. Parses into *parser as usual if the
+  // includes can't be cached, leaving includes->key empty.
+  bool ParseOnCachedIncludes(std::unique_ptr<Parser> *parser,
+                             const std::string &filename,
+                             const std::string &contents,
+                             std::vector<const char *> &include_directories,
+                             CachedIncludes *includes, Report *report);
+
+  bool TakeCachedIncludes(CachedIncludes *includes);
 
-  void LoadBinarySchema(Parser &parser, const std::string &filename,
-                        const std::string &contents);
+  void CacheIncludes(CachedIncludes &&includes);
+
+  // Compiles the requests of clients started with --connect, until the
+  // server fails. Parsed includes are kept between requests.
+  int Serve(const std::string &socket_path) const;
+
+  // Has the server at socket_path compile args. Returns -1 if there is no
+  // server to connect to.
+  int Connect(const std::string &socket_path,
+              const std::vector<std::string> &args) const;
+
+  static void ServerWarn(const FlatCompiler *flatc, const std::string &warn,
+                         bool show_exe_name);
+
+  static void ServerError(const FlatCompiler *flatc, const std::string &err,
+                          bool usage, bool show_exe_name);
 
   void Warn(const std::string &warn, bool show_exe_name = true) const;
 
-  void Error(const std::string &err, bool usage = true,
-             bool show_exe_name = true) const;
+  // Returns 1, for Compile to return should the error callback return.
+  int Error(const std::string &err, bool usage = true,
+            bool show_exe_name = true) const;
 
   InitParams params_;
+
+  // Set when compiling requests in a server, which caches parsed include
+  // files.
+  bool serving_;
+  std::mutex include_cache_mutex_;
+  std::map<std::string, CachedIncludes> include_cache_;
+  uint64_t include_cache_uses_;
+  // For --server-stats: how often includes were parsed, and reused.
+  uint64_t includes_parsed_;
+  uint64_t includes_reused_;
 };
 
 }  // namespace flatbuffers
@@ -122,6 +122,16 @@ inline Type ToFixedTypedVectorElementType(Type t, uint8_t *len) {
   return static_cast<Type>(fixed_type % 3 + FBT_INT);
 }
 
+// The typed vector element type that C++ scalars of type T are stored as.
+template<typename T> Type GetScalarType() {
+  static_assert(flatbuffers::is_scalar<T>::value, "Unrelated types");
+  return flatbuffers::is_floating_point<T>::value
+             ? FBT_FLOAT
+             : flatbuffers::is_same<T, bool>::value
+                   ? FBT_BOOL
+                   : (flatbuffers::is_unsigned<T>::value ? FBT_UINT : FBT_INT);
+}
+
 // TODO: implement proper support for 8/16bit floats, or decide not to
 // support them.
 typedef int16_t half;
@@ -180,6 +190,65 @@ template<typename T> const uint8_t *Indirect(const uint8_t *offset) {
   return offset - flatbuffers::ReadScalar<T>(offset);
 }
 
+// Scalar typed vector elements, if stored exactly as T in memory.
+template<typename T>
+const T *ScalarData(const uint8_t *data, uint8_t byte_width, Type type) {
+  // clang-format off
+  #if FLATBUFFERS_LITTLEENDIAN
+    if (type == GetScalarType<T>() && byte_width == sizeof(T))
+      return reinterpret_cast<const T *>(data);
+  #endif
+  // clang-format on
+  (void)data;
+  (void)byte_width;
+  (void)type;
+  return nullptr;
+}
+
+// One loop per pair of types, which compilers can vectorize.
+template<typename S, typename T>
+void ConvertScalars(const uint8_t *data, T *dest, size_t len) {
+  for (size_t i = 0; i < len; i++) {
+    dest[i] = static_cast<T>(flatbuffers::ReadScalar<S>(data + i * sizeof(S)));
+  }
+}
+
+// Converts `len` scalar elements to T, returns false for keys.
+template<typename T>
+bool CopyScalars(const uint8_t *data, uint8_t byte_width, Type type, T *dest,
+                 size_t len) {
+  if (auto direct = ScalarData<T>(data, byte_width, type)) {
+    memcpy(dest, direct, len * sizeof(T));
+    return true;
+  }
+  switch (type) {
+    case FBT_INT:
+      switch (byte_width) {
+        case 1: ConvertScalars<int8_t>(data, dest, len); return true;
+        case 2: ConvertScalars<int16_t>(data, dest, len); return true;
+        case 4: ConvertScalars<int32_t>(data, dest, len); return true;
+        default: ConvertScalars<int64_t>(data, dest, len); return true;
+      }
+    case FBT_UINT:
+    case FBT_BOOL:
+      switch (byte_width) {
+        case 1: ConvertScalars<uint8_t>(data, dest, len); return true;
+        case 2: ConvertScalars<uint16_t>(data, dest, len); return true;
+        case 4: ConvertScalars<uint32_t>(data, dest, len); return true;
+        default: ConvertScalars<uint64_t>(data, dest, len); return true;
+      }
+    case FBT_FLOAT:
+      // See ReadDouble().
+      switch (byte_width) {
+        case 1: ConvertScalars<quarter>(data, dest, len); return true;
+        case 2: ConvertScalars<half>(data, dest, len); return true;
+        case 4: ConvertScalars<float>(data, dest, len); return true;
+        default: ConvertScalars<double>(data, dest, len); return true;
+      }
+    default: return false;
+  }
+}
+
 inline BitWidth WidthU(uint64_t u) {
 #define FLATBUFFERS_GET_FIELD_BIT_WIDTH(value, width)                   \
   {                                                                     \
@@ -295,6 +364,19 @@ class TypedVector : public Sized {
 
   Type ElementType() { return type_; }
 
+  // The elements if they are stored as T, e.g. a vector written from
+  // int32_t values that don't all fit in 16 bits, or nullptr.
+  template<typename T> const T *data() const {
+    return ScalarData<T>(data_, byte_width_, type_);
+  }
+
+  // Converts the first `len` elements to T, without a Reference per
+  // element. Returns false if the elements aren't scalars.
+  template<typename T> bool CopyTo(T *dest, size_t len) const {
+    FLATBUFFERS_ASSERT(len <= size_);
+    return CopyScalars(data_, byte_width_, type_, dest, len);
+  }
+
   friend Reference;
 
  private:
@@ -320,19 +402,65 @@ class FixedTypedVector : public Object {
   }
 
   Type ElementType() { return type_; }
-  uint8_t size() { return len_; }
+  uint8_t size() const { return len_; }
+
+  // See TypedVector.
+  template<typename T> const T *data() const {
+    return ScalarData<T>(data_, byte_width_, type_);
+  }
+  template<typename T> bool CopyTo(T *dest, size_t len) const {
+    FLATBUFFERS_ASSERT(len <= len_);
+    return CopyScalars(data_, byte_width_, type_, dest, len);
+  }
 
  private:
   Type type_;
   uint8_t len_;
 };
 
+// Hash of a map key, as stored in the key index written with
+// BUILDER_FLAG_INDEX_MAP_KEYS (32-bit FNV-1a).
+inline uint32_t HashKey(const char *key) {
+  uint32_t hash = 2166136261u;
+  for (; *key; key++) {
+    hash ^= static_cast<uint8_t>(*key);
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+// Marks the start of a key index, see Builder::WriteKeyIndex().
+static const uint32_t kKeyIndexMagic = 0x4B584946;  // "FIXK"
+
+// A key to be looked up in many maps, e.g. the same field of every element
+// of a vector of maps. The hash is computed once, and the position the key
+// was last found at is tried first, which is a single strcmp for maps that
+// have the same keys. A MapKey is updated by lookups, so it can't be shared
+// between threads.
+class MapKey {
+ public:
+  explicit MapKey(const char *key)
+      : key_(key), hash_(HashKey(key)), hint_(0) {}
+  explicit MapKey(const std::string &key)
+      : key_(key), hash_(HashKey(key.c_str())), hint_(0) {}
+
+  const std::string &key() const { return key_; }
+
+ private:
+  std::string key_;
+  uint32_t hash_;
+  size_t hint_;
+
+  friend Map;
+};
+
 class Map : public Vector {
  public:
   Map(const uint8_t *data, uint8_t byte_width) : Vector(data, byte_width) {}
 
   Reference operator[](const char *key) const;
   Reference operator[](const std::string &key) const;
+  Reference operator[](MapKey &key) const;
 
   Vector Values() const { return Vector(data_, byte_width_); }
 
@@ -353,6 +481,37 @@ class Map : public Vector {
   }
 
   bool IsTheEmptyMap() const { return data_ == EmptyMap().data_; }
+
+ private:
+  // These return the position of `key` in `keys`, or keys.size() if it is
+  // absent. Probe() looks it up in the key index, Search() bisects.
+  size_t Probe(const TypedVector &keys, const uint8_t *slots,
+               size_t num_slots, const char *key, uint32_t hash) const;
+  size_t Search(const TypedVector &keys, const char *key) const;
+
+  // Finds the key index that directly follows the keys vector, if there is
+  // one, see Builder::WriteKeyIndex(). Returns the number of slots, or 0
+  // without an index. The index has to end before this map, so this never
+  // reads out of bounds. Anything found through it is compared against the
+  // key, and keys it doesn't find are still searched for.
+  size_t KeyIndex(const TypedVector &keys, const uint8_t **slots) const {
+    auto keys_end = keys.data_ + keys.size() * keys.byte_width_;
+    // Only keys narrower than 32 bits are padded up to the index, as far as
+    // the next 32-bit boundary of the buffer, which is assumed to be aligned.
+    auto padding = (0 - reinterpret_cast<uintptr_t>(keys_end)) & 3;
+    auto index = keys_end + (keys.byte_width_ < 4 ? padding : 0);
+    auto end = data_ - byte_width_ * 3;
+    if (end < index || end - index < 8 ||
+        ReadUInt64(index, 4) != kKeyIndexMagic)
+      return 0;
+    auto num_slots = static_cast<size_t>(ReadUInt64(index + 4, 4));
+    auto max_slots = static_cast<size_t>(end - index - 8) / 4;
+    if (num_slots < size() || num_slots > max_slots ||
+        (num_slots & (num_slots - 1)))
+      return 0;
+    *slots = index + 8;
+    return num_slots;
+  }
 };
 
 template<typename T>
@@ -542,57 +701,29 @@ class Reference {
   // they always do). keys_quoted determines if keys are quoted, at any level.
   // TODO(wvo): add further options to have indentation/newlines.
   void ToString(bool strings_quoted, bool keys_quoted, std::string &s) const {
-    if (type_ == FBT_STRING) {
-      String str(Indirect(), byte_width_);
-      if (strings_quoted) {
-        flatbuffers::EscapeString(str.c_str(), str.length(), &s, true, false);
-      } else {
-        s.append(str.c_str(), str.length());
-      }
-    } else if (IsKey()) {
-      auto str = AsKey();
-      if (keys_quoted) {
-        flatbuffers::EscapeString(str, strlen(str), &s, true, false);
-      } else {
-        s += str;
-      }
-    } else if (IsInt()) {
-      s += flatbuffers::NumToString(AsInt64());
-    } else if (IsUInt()) {
-      s += flatbuffers::NumToString(AsUInt64());
-    } else if (IsFloat()) {
-      s += flatbuffers::NumToString(AsDouble());
-    } else if (IsNull()) {
-      s += "null";
-    } else if (IsBool()) {
-      s += AsBool() ? "true" : "false";
-    } else if (IsMap()) {
-      s += "{ ";
-      auto m = AsMap();
-      auto keys = m.Keys();
-      auto vals = m.Values();
-      for (size_t i = 0; i < keys.size(); i++) {
-        keys[i].ToString(true, keys_quoted, s);
-        s += ": ";
-        vals[i].ToString(true, keys_quoted, s);
-        if (i < keys.size() - 1) s += ", ";
-      }
-      s += " }";
-    } else if (IsVector()) {
-      AppendToString<Vector>(s, AsVector(), keys_quoted);
-    } else if (IsTypedVector()) {
-      AppendToString<TypedVector>(s, AsTypedVector(), keys_quoted);
-    } else if (IsFixedTypedVector()) {
-      AppendToString<FixedTypedVector>(s, AsFixedTypedVector(), keys_quoted);
-    } else if (IsBlob()) {
-      auto blob = AsBlob();
-      flatbuffers::EscapeString(reinterpret_cast<const char *>(blob.data()),
-                                blob.size(), &s, true, false);
-    } else {
-      s += "(?)";
-    }
+    ToString(strings_quoted, keys_quoted, s, nullptr);
+  }
+
+  // Same, but with a sink `s` is only used as a buffer: whenever it grows
+  // past kTextChunkSize it is handed to the sink and cleared, so arbitrarily
+  // large buffers can be dumped with bounded memory. Whatever is left in `s`
+  // at the end is written too. Returns false if the sink failed.
+  bool ToString(bool strings_quoted, bool keys_quoted, std::string &s,
+                flatbuffers::TextSink *sink) const {
+    if (!AppendText(strings_quoted, keys_quoted, s, sink)) return false;
+    return FlushText(s, sink);
   }
 
+  // Same, streaming to a sink with an internal buffer.
+  bool ToString(bool strings_quoted, bool keys_quoted,
+                flatbuffers::TextSink *sink) const {
+    std::string s;
+    s.reserve(kTextChunkSize + 1024);
+    return ToString(strings_quoted, keys_quoted, s, sink);
+  }
+
+  static const size_t kTextChunkSize = 1 << 16;
+
   // This function returns the empty blob if you try to read a not-blob.
   // Strings can be viewed as blobs too.
   Blob AsBlob() const {
@@ -729,6 +860,123 @@ class Reference {
   }
 
  private:
+  static bool FlushText(std::string &s, flatbuffers::TextSink *sink) {
+    if (!sink || s.empty()) return true;
+    auto ok = sink->Write(s.data(), s.size());
+    s.clear();
+    return ok;
+  }
+
+  // Called between elements, keeps the buffered text around kTextChunkSize.
+  static bool MaybeFlushText(std::string &s, flatbuffers::TextSink *sink) {
+    return s.size() < kTextChunkSize || FlushText(s, sink);
+  }
+
+  bool AppendText(bool strings_quoted, bool keys_quoted, std::string &s,
+                  flatbuffers::TextSink *sink) const {
+    if (type_ == FBT_STRING) {
+      String str(Indirect(), byte_width_);
+      if (strings_quoted) {
+        flatbuffers::EscapeString(str.c_str(), str.length(), &s, true, false);
+      } else {
+        s.append(str.c_str(), str.length());
+      }
+    } else if (IsKey()) {
+      auto str = AsKey();
+      if (keys_quoted) {
+        flatbuffers::EscapeString(str, strlen(str), &s, true, false);
+      } else {
+        s += str;
+      }
+    } else if (IsInt()) {
+      flatbuffers::AppendIntToString(AsInt64(), &s);
+    } else if (IsUInt()) {
+      flatbuffers::AppendIntToString(AsUInt64(), &s);
+    } else if (IsFloat()) {
+      s += flatbuffers::NumToString(AsDouble());
+    } else if (IsNull()) {
+      s += "null";
+    } else if (IsBool()) {
+      s += AsBool() ? "true" : "false";
+    } else if (IsMap()) {
+      s += "{ ";
+      auto m = AsMap();
+      auto keys = m.Keys();
+      auto vals = m.Values();
+      for (size_t i = 0; i < keys.size(); i++) {
+        if (!MaybeFlushText(s, sink)) return false;
+        keys[i].AppendText(true, keys_quoted, s, sink);
+        s += ": ";
+        if (!vals[i].AppendText(true, keys_quoted, s, sink)) return false;
+        if (i < keys.size() - 1) s += ", ";
+      }
+      s += " }";
+    } else if (IsVector()) {
+      auto v = AsVector();
+      s += "[ ";
+      for (size_t i = 0; i < v.size(); i++) {
+        if (!MaybeFlushText(s, sink)) return false;
+        if (i) s += ", ";
+        if (!v[i].AppendText(true, keys_quoted, s, sink)) return false;
+      }
+      s += " ]";
+    } else if (IsTypedVector() || IsFixedTypedVector()) {
+      return AppendTypedVectorText(keys_quoted, s, sink);
+    } else if (IsBlob()) {
+      auto blob = AsBlob();
+      flatbuffers::EscapeString(reinterpret_cast<const char *>(blob.data()),
+                                blob.size(), &s, true, false);
+    } else {
+      s += "(?)";
+    }
+    return true;
+  }
+
+  // Scalar elements are formatted straight from the vector data, without a
+  // Reference per element.
+  bool AppendTypedVectorText(bool keys_quoted, std::string &s,
+                             flatbuffers::TextSink *sink) const {
+    auto data = Indirect();
+    size_t len;
+    Type elem_type;
+    if (IsTypedVector()) {
+      elem_type = ToTypedVectorElementType(type_);
+      len = static_cast<size_t>(ReadUInt64(data - byte_width_, byte_width_));
+      // See AsTypedVector().
+      if (elem_type == FBT_STRING) elem_type = FBT_KEY;
+    } else {
+      uint8_t fixed_len = 0;
+      elem_type = ToFixedTypedVectorElementType(type_, &fixed_len);
+      len = fixed_len;
+    }
+    s += "[ ";
+    for (size_t i = 0; i < len; i++) {
+      if (!MaybeFlushText(s, sink)) return false;
+      if (i) s += ", ";
+      auto elem = data + i * byte_width_;
+      switch (elem_type) {
+        case FBT_INT:
+          flatbuffers::AppendIntToString(ReadInt64(elem, byte_width_), &s);
+          break;
+        case FBT_UINT:
+          flatbuffers::AppendIntToString(ReadUInt64(elem, byte_width_), &s);
+          break;
+        case FBT_FLOAT:
+          s += flatbuffers::NumToString(ReadDouble(elem, byte_width_));
+          break;
+        case FBT_BOOL:
+          s += ReadUInt64(elem, byte_width_) ? "true" : "false";
+          break;
+        default:
+          Reference(elem, byte_width_, 1, elem_type)
+              .AppendText(true, keys_quoted, s, sink);
+          break;
+      }
+    }
+    s += " ]";
+    return true;
+  }
+
   const uint8_t *Indirect() const {
     return flexbuffers::Indirect(data_, parent_width_);
   }
@@ -756,6 +1004,9 @@ class Reference {
     return false;
   }
 
+  friend class Walker;
+  friend class Updater;
+
   const uint8_t *data_;
   uint8_t parent_width_;
   uint8_t byte_width_;
@@ -840,8 +1091,7 @@ template<typename T> int KeyCompare(const void *key, const void *elem) {
   return strcmp(skey, str_elem);
 }
 
-inline Reference Map::operator[](const char *key) const {
-  auto keys = Keys();
+inline size_t Map::Search(const TypedVector &keys, const char *key) const {
   // We can't pass keys.byte_width_ to the comparison function, so we have
   // to pick the right one ahead of time.
   int (*comp)(const void *, const void *) = nullptr;
@@ -852,8 +1102,37 @@ inline Reference Map::operator[](const char *key) const {
     case 8: comp = KeyCompare<uint64_t>; break;
   }
   auto res = std::bsearch(key, keys.data_, keys.size(), keys.byte_width_, comp);
-  if (!res) return Reference(nullptr, 1, NullPackedType());
-  auto i = (reinterpret_cast<uint8_t *>(res) - keys.data_) / keys.byte_width_;
+  if (!res) return keys.size();
+  return static_cast<size_t>(reinterpret_cast<uint8_t *>(res) - keys.data_) /
+         keys.byte_width_;
+}
+
+inline size_t Map::Probe(const TypedVector &keys, const uint8_t *slots,
+                         size_t num_slots, const char *key,
+                         uint32_t hash) const {
+  // Linear probing, up to the first empty slot.
+  auto mask = num_slots - 1;
+  for (size_t n = 0, h = hash & mask; n < num_slots; n++, h = (h + 1) & mask) {
+    auto slot = static_cast<size_t>(ReadUInt64(slots + h * 4, 4));
+    if (!slot) break;
+    if (slot > keys.size()) break;
+    auto elem = keys.data_ + (slot - 1) * keys.byte_width_;
+    if (!strcmp(reinterpret_cast<const char *>(
+                    Indirect(elem, keys.byte_width_)),
+                key))
+      return slot - 1;
+  }
+  return keys.size();
+}
+
+inline Reference Map::operator[](const char *key) const {
+  auto keys = Keys();
+  const uint8_t *slots;
+  auto num_slots = KeyIndex(keys, &slots);
+  auto i = num_slots ? Probe(keys, slots, num_slots, key, HashKey(key))
+                     : keys.size();
+  if (i == keys.size()) i = Search(keys, key);
+  if (i == keys.size()) return Reference(nullptr, 1, NullPackedType());
   return (*static_cast<const Vector *>(this))[i];
 }
 
@@ -861,6 +1140,21 @@ inline Reference Map::operator[](const std::string &key) const {
   return (*this)[key.c_str()];
 }
 
+inline Reference Map::operator[](MapKey &key) const {
+  auto keys = Keys();
+  auto i = key.hint_;
+  if (i >= keys.size() || strcmp(keys[i].AsKey(), key.key_.c_str())) {
+    const uint8_t *slots;
+    auto num_slots = KeyIndex(keys, &slots);
+    i = num_slots ? Probe(keys, slots, num_slots, key.key_.c_str(), key.hash_)
+                  : keys.size();
+    if (i == keys.size()) i = Search(keys, key.key_.c_str());
+    if (i == keys.size()) return Reference(nullptr, 1, NullPackedType());
+    key.hint_ = i;
+  }
+  return (*static_cast<const Vector *>(this))[i];
+}
+
 inline Reference GetRoot(const uint8_t *buffer, size_t size) {
   // See Finish() below for the serialization counterpart of this.
   // The root starts at the end of the buffer, so we parse backwards from there.
@@ -875,16 +1169,338 @@ inline Reference GetRoot(const std::vector<uint8_t> &buffer) {
   return GetRoot(flatbuffers::vector_data(buffer), buffer.size());
 }
 
+// Checks that a FlexBuffer is well formed: every offset, size and key lies
+// inside the buffer, and every map has as many keys as values, so that the
+// accessors above, which don't check anything, are safe to use on it. They
+// then read it at full speed. Values reachable along several paths are
+// checked each time, so like flatbuffers::Verifier this limits the nesting
+// depth and the total number of values it looks at.
+class Verifier FLATBUFFERS_FINAL_CLASS {
+ public:
+  Verifier(const uint8_t *buf, size_t buf_len, size_t max_depth = 64,
+           size_t max_values = 1000000, bool check_alignment = true)
+      : buf_(buf),
+        size_(buf_len),
+        depth_(0),
+        max_depth_(max_depth),
+        num_values_(0),
+        max_values_(max_values),
+        check_alignment_(check_alignment) {}
+
+  bool VerifyBuffer() {
+    // See GetRoot().
+    if (!Check(size_ >= 3)) return false;
+    auto byte_width = buf_[size_ - 1];
+    auto packed_type = buf_[size_ - 2];
+    if (!Check(IsByteWidth(byte_width) && size_ - 2 >= byte_width))
+      return false;
+    return VerifyRef(size_ - 2 - byte_width, byte_width, packed_type);
+  }
+
+ private:
+  // Central location where any verification failures register.
+  bool Check(bool ok) const {
+    // clang-format off
+    #ifdef FLATBUFFERS_DEBUG_VERIFICATION_FAILURE
+      FLATBUFFERS_ASSERT(ok);
+    #endif
+    // clang-format on
+    return ok;
+  }
+
+  static bool IsByteWidth(uint64_t w) {
+    return w == 1 || w == 2 || w == 4 || w == 8;
+  }
+
+  bool VerifyRange(size_t pos, size_t len) const {
+    return Check(pos <= size_ && len <= size_ - pos);
+  }
+
+  bool VerifyAlignment(size_t pos, size_t align) const {
+    return Check(!check_alignment_ || !(pos & (align - 1)));
+  }
+
+  // The offset at `pos` must point back into the buffer.
+  bool VerifyOffset(size_t pos, uint8_t width, size_t *target) const {
+    auto offset = ReadUInt64(buf_ + pos, width);
+    if (!Check(offset <= pos)) return false;
+    *target = pos - static_cast<size_t>(offset);
+    return true;
+  }
+
+  // A size prefix before `pos`, followed by that many elements of
+  // `elem_size` bytes and `extra` more bytes.
+  bool VerifySized(size_t pos, uint8_t width, size_t elem_size, size_t extra,
+                   size_t *count) const {
+    if (!Check(pos >= width) || !VerifyAlignment(pos, width)) return false;
+    auto n = ReadUInt64(buf_ + pos - width, width);
+    if (!Check(n <= size_ / elem_size)) return false;
+    *count = static_cast<size_t>(n);
+    return VerifyRange(pos, *count * elem_size) &&
+           VerifyRange(pos + *count * elem_size, extra);
+  }
+
+  bool VerifyKey(size_t pos) const {
+    return Check(pos < size_ && memchr(buf_ + pos, 0, size_ - pos) != nullptr);
+  }
+
+  bool VerifyKeys(size_t pos, uint8_t width, size_t count) const {
+    for (size_t i = 0; i < count; i++) {
+      size_t key;
+      if (!VerifyOffset(pos + i * width, width, &key) || !VerifyKey(key))
+        return false;
+    }
+    return true;
+  }
+
+  bool VerifyMap(size_t pos, uint8_t width) {
+    size_t count, keys, keys_count;
+    if (!Check(pos >= width * 3) ||
+        !VerifyOffset(pos - width * 3, width, &keys) ||
+        !VerifySized(pos, width, width, 0, &count))
+      return false;
+    auto keys_width = ReadUInt64(buf_ + pos - width * 2, width);
+    if (!Check(IsByteWidth(keys_width))) return false;
+    auto kw = static_cast<uint8_t>(keys_width);
+    return VerifySized(keys, kw, kw, 0, &keys_count) &&
+           Check(keys_count == count) && VerifyKeys(keys, kw, count) &&
+           VerifyVector(pos, width);
+  }
+
+  bool VerifyVector(size_t pos, uint8_t width) {
+    size_t count;
+    if (!VerifySized(pos, width, width + 1U, 0, &count)) return false;
+    // The types follow the elements.
+    auto types = pos + count * width;
+    if (!Check(++depth_ <= max_depth_)) return false;
+    for (size_t i = 0; i < count; i++) {
+      if (!VerifyRef(pos + i * width, width, buf_[types + i])) return false;
+    }
+    depth_--;
+    return true;
+  }
+
+  // The value at `pos` takes `parent_width` bytes, which the caller checked.
+  bool VerifyRef(size_t pos, uint8_t parent_width, uint8_t packed_type) {
+    if (!Check(++num_values_ <= max_values_)) return false;
+    auto type = static_cast<Type>(packed_type >> 2);
+    auto width = static_cast<uint8_t>(1U << (packed_type & 3));
+    if (!Check(type <= FBT_BOOL || type == FBT_VECTOR_BOOL)) return false;
+    if (IsInline(type)) return true;
+    size_t target, count;
+    if (!VerifyOffset(pos, parent_width, &target)) return false;
+    switch (type) {
+      case FBT_KEY: return VerifyKey(target);
+      case FBT_STRING:
+        return VerifySized(target, width, 1, 1, &count) &&
+               Check(!buf_[target + count]);
+      case FBT_BLOB: return VerifySized(target, width, 1, 0, &count);
+      case FBT_INDIRECT_INT:
+      case FBT_INDIRECT_UINT:
+      case FBT_INDIRECT_FLOAT:
+        return VerifyAlignment(target, width) && VerifyRange(target, width);
+      case FBT_MAP: return VerifyMap(target, width);
+      case FBT_VECTOR: return VerifyVector(target, width);
+      default: break;
+    }
+    if (IsTypedVector(type)) {
+      auto elem_type = ToTypedVectorElementType(type);
+      if (!VerifySized(target, width, width, 0, &count)) return false;
+      return (elem_type != FBT_KEY && elem_type != FBT_STRING) ||
+             VerifyKeys(target, width, count);
+    }
+    // Fixed typed vectors only hold scalars.
+    uint8_t len = 0;
+    ToFixedTypedVectorElementType(type, &len);
+    return VerifyAlignment(target, width) && VerifyRange(target, len * width);
+  }
+
+  const uint8_t *buf_;
+  size_t size_;
+  size_t depth_;
+  size_t max_depth_;
+  size_t num_values_;
+  size_t max_values_;
+  bool check_alignment_;
+};
+
+// Returns false if the buffer is not a well formed FlexBuffer, see Verifier.
+inline bool VerifyBuffer(const uint8_t *buf, size_t buf_len) {
+  Verifier verifier(buf, buf_len);
+  return verifier.VerifyBuffer();
+}
+
+// Receives the values of a FlexBuffer from a Walker in buffer order: maps
+// and vectors are bracketed by Start and End calls, and each map value is
+// preceded by its key. Keys stored as values are passed to String().
+// Return false from any of them to stop the walk.
+class WalkVisitor {
+ public:
+  virtual ~WalkVisitor() {}
+  virtual bool Null() { return true; }
+  virtual bool Bool(bool) { return true; }
+  virtual bool Int(int64_t) { return true; }
+  virtual bool UInt(uint64_t) { return true; }
+  virtual bool Float(double) { return true; }
+  virtual bool String(const char *, size_t) { return true; }
+  virtual bool Blob(const uint8_t *, size_t) { return true; }
+  virtual bool StartMap(size_t /*size*/) { return true; }
+  virtual bool Key(const char *) { return true; }
+  virtual bool EndMap() { return true; }
+  virtual bool StartVector(size_t /*size*/) { return true; }
+  virtual bool EndVector() { return true; }
+};
+
+// Walks a FlexBuffer in one pass over the buffer, reading values in place
+// rather than through a Reference, Vector or Map for each of them. Nesting
+// is kept on an explicit stack, which is reused between walks.
+class Walker {
+ public:
+  explicit Walker(WalkVisitor *visitor) : visitor_(visitor) {}
+
+  // Returns false if the visitor stopped the walk.
+  bool Walk(const uint8_t *buffer, size_t size) {
+    return Walk(GetRoot(buffer, size));
+  }
+  bool Walk(const Reference &ref) {
+    stack_.clear();
+    if (!Visit(ref.data_, ref.parent_width_, ref.type_, ref.byte_width_))
+      return false;
+    while (!stack_.empty()) {
+      auto &frame = stack_.back();
+      if (frame.index == frame.size) {
+        auto is_map = frame.keys != nullptr;
+        stack_.pop_back();
+        if (!(is_map ? visitor_->EndMap() : visitor_->EndVector()))
+          return false;
+        continue;
+      }
+      auto i = frame.index++;
+      if (frame.keys) {
+        auto key = Indirect(frame.keys + i * frame.keys_width,
+                            frame.keys_width);
+        if (!visitor_->Key(reinterpret_cast<const char *>(key))) return false;
+      }
+      auto elem = frame.data + i * frame.byte_width;
+      auto type = frame.elem_type;
+      uint8_t byte_width = 1;
+      if (frame.types) {
+        type = static_cast<Type>(frame.types[i] >> 2);
+        byte_width = static_cast<uint8_t>(1U << (frame.types[i] & 3));
+      }
+      // May grow the stack, so `frame` can't be used after this.
+      if (!Visit(elem, frame.byte_width, type, byte_width)) return false;
+    }
+    return true;
+  }
+
+ private:
+  // A map or vector being walked. Untyped ones have a type per element.
+  struct Frame {
+    const uint8_t *data;
+    const uint8_t *types;
+    const uint8_t *keys;
+    size_t size;
+    size_t index;
+    uint8_t byte_width;
+    uint8_t keys_width;
+    Type elem_type;
+  };
+
+  void Push(const uint8_t *data, uint8_t byte_width, size_t size,
+            const uint8_t *types, Type elem_type,
+            const uint8_t *keys = nullptr, uint8_t keys_width = 0) {
+    Frame frame = { data, types,      keys,       size,
+                    0,    byte_width, keys_width, elem_type };
+    stack_.push_back(frame);
+  }
+
+  // Reports scalars and strings, and pushes maps and vectors.
+  bool Visit(const uint8_t *p, uint8_t parent_width, Type type,
+             uint8_t byte_width) {
+    switch (type) {
+      case FBT_NULL: return visitor_->Null();
+      case FBT_BOOL: return visitor_->Bool(ReadUInt64(p, parent_width) != 0);
+      case FBT_INT: return visitor_->Int(ReadInt64(p, parent_width));
+      case FBT_UINT: return visitor_->UInt(ReadUInt64(p, parent_width));
+      case FBT_FLOAT: return visitor_->Float(ReadDouble(p, parent_width));
+      default: break;
+    }
+    auto data = Indirect(p, parent_width);
+    switch (type) {
+      case FBT_INDIRECT_INT: return visitor_->Int(ReadInt64(data, byte_width));
+      case FBT_INDIRECT_UINT:
+        return visitor_->UInt(ReadUInt64(data, byte_width));
+      case FBT_INDIRECT_FLOAT:
+        return visitor_->Float(ReadDouble(data, byte_width));
+      case FBT_KEY: {
+        auto key = reinterpret_cast<const char *>(data);
+        return visitor_->String(key, strlen(key));
+      }
+      case FBT_STRING:
+      case FBT_BLOB: {
+        auto len = static_cast<size_t>(
+            ReadUInt64(data - byte_width, byte_width));
+        return type == FBT_STRING
+                   ? visitor_->String(reinterpret_cast<const char *>(data),
+                                      len)
+                   : visitor_->Blob(data, len);
+      }
+      default: break;
+    }
+    size_t size = 0;
+    if (type == FBT_MAP || type == FBT_VECTOR || IsTypedVector(type)) {
+      size = static_cast<size_t>(ReadUInt64(data - byte_width, byte_width));
+    }
+    if (type == FBT_MAP) {
+      // See Map::Keys().
+      auto keys_offset = data - byte_width * 3;
+      auto keys_width = static_cast<uint8_t>(
+          ReadUInt64(keys_offset + byte_width, byte_width));
+      Push(data, byte_width, size, data + size * byte_width, FBT_NULL,
+           Indirect(keys_offset, byte_width), keys_width);
+      return visitor_->StartMap(size);
+    }
+    if (type == FBT_VECTOR) {
+      Push(data, byte_width, size, data + size * byte_width, FBT_NULL);
+    } else if (IsTypedVector(type)) {
+      auto elem_type = ToTypedVectorElementType(type);
+      // See AsTypedVector().
+      if (elem_type == FBT_STRING) elem_type = FBT_KEY;
+      Push(data, byte_width, size, nullptr, elem_type);
+    } else if (IsFixedTypedVector(type)) {
+      uint8_t len = 0;
+      auto elem_type = ToFixedTypedVectorElementType(type, &len);
+      size = len;
+      Push(data, byte_width, size, nullptr, elem_type);
+    } else {
+      return true;  // Unknown types are skipped.
+    }
+    return visitor_->StartVector(size);
+  }
+
+  WalkVisitor *visitor_;
+  std::vector<Frame> stack_;
+};
+
 // Flags that configure how the Builder behaves.
 // The "Share" flags determine if the Builder automatically tries to pool
 // this type. Pooling can reduce the size of serialized data if there are
 // multiple maps of the same kind, at the expense of slightly slower
-// serialization (the cost of lookups) and more memory use (std::set).
+// serialization (the cost of lookups) and more memory use (a hash table).
 // By default this is on for keys, but off for strings.
 // Turn keys off if you have e.g. only one map.
 // Turn strings on if you expect many non-unique string values.
 // Additionally, sharing key vectors can save space if you have maps with
 // identical field populations.
+// Indexing map keys stores a hash table of the keys after every keys vector
+// with at least kMinIndexedMapSize keys, so Map lookups become a hash probe
+// rather than a binary search. This costs 8 to 16 bytes per key. Readers that
+// don't know about the index simply don't see it.
+// Scalar vectors written from arrays store their elements as the array's type
+// by default, so readers can use them in place. Narrowing them stores the
+// elements at the smallest width that fits them all instead, which saves space
+// for small values but means readers have to convert them.
 enum BuilderFlag {
   BUILDER_FLAG_NONE = 0,
   BUILDER_FLAG_SHARE_KEYS = 1,
@@ -892,8 +1508,13 @@ enum BuilderFlag {
   BUILDER_FLAG_SHARE_KEYS_AND_STRINGS = 3,
   BUILDER_FLAG_SHARE_KEY_VECTORS = 4,
   BUILDER_FLAG_SHARE_ALL = 7,
+  BUILDER_FLAG_INDEX_MAP_KEYS = 8,
+  BUILDER_FLAG_NARROW_SCALAR_VECTORS = 16,
 };
 
+// Smaller maps are bisected about as fast as they are hashed.
+static const size_t kMinIndexedMapSize = 8;
+
 class Builder FLATBUFFERS_FINAL_CLASS {
  public:
   Builder(size_t initial_size = 256,
@@ -901,9 +1522,7 @@ class Builder FLATBUFFERS_FINAL_CLASS {
       : buf_(initial_size),
         finished_(false),
         flags_(flags),
-        force_min_bit_width_(BIT_WIDTH_8),
-        key_pool(KeyOffsetCompare(buf_)),
-        string_pool(StringOffsetCompare(buf_)) {
+        force_min_bit_width_(BIT_WIDTH_8) {
     buf_.clear();
   }
 
@@ -926,6 +1545,9 @@ class Builder FLATBUFFERS_FINAL_CLASS {
     force_min_bit_width_ = BIT_WIDTH_8;
     key_pool.clear();
     string_pool.clear();
+    key_vector_pool_.clear();
+    for (auto it = map_templates_.begin(); it != map_templates_.end(); ++it)
+      it->keys_vector = Value();
   }
 
   // All value constructing functions below have two versions: one that
@@ -1002,14 +1624,12 @@ class Builder FLATBUFFERS_FINAL_CLASS {
     auto sloc = buf_.size();
     WriteBytes(str, len + 1);
     if (flags_ & BUILDER_FLAG_SHARE_KEYS) {
-      auto it = key_pool.find(sloc);
-      if (it != key_pool.end()) {
+      auto existing = key_pool.Intern(buf_, sloc, len);
+      if (existing != sloc) {
         // Already in the buffer. Remove key we just serialized, and use
         // existing offset instead.
         buf_.resize(sloc);
-        sloc = *it;
-      } else {
-        key_pool.insert(sloc);
+        sloc = existing;
       }
     }
     stack_.push_back(Value(static_cast<uint64_t>(sloc), FBT_KEY, BIT_WIDTH_8));
@@ -1023,16 +1643,13 @@ class Builder FLATBUFFERS_FINAL_CLASS {
     auto reset_to = buf_.size();
     auto sloc = CreateBlob(str, len, 1, FBT_STRING);
     if (flags_ & BUILDER_FLAG_SHARE_STRINGS) {
-      StringOffset so(sloc, len);
-      auto it = string_pool.find(so);
-      if (it != string_pool.end()) {
+      auto existing = string_pool.Intern(buf_, sloc, len);
+      if (existing != sloc) {
         // Already in the buffer. Remove string we just serialized, and use
         // existing offset instead.
         buf_.resize(reset_to);
-        sloc = it->first;
+        sloc = existing;
         stack_.back().u_ = sloc;
-      } else {
-        string_pool.insert(so);
       }
     }
     return sloc;
@@ -1107,35 +1724,54 @@ class Builder FLATBUFFERS_FINAL_CLASS {
       Value val;
     };
     // TODO(wvo): strict aliasing?
-    // TODO(wvo): allow the caller to indicate the data is already sorted
-    // for maximum efficiency? With an assert to check sortedness to make sure
-    // we're not breaking binary search.
-    // Or, we can track if the map is sorted as keys are added which would be
-    // be quite cheap (cheaper than checking it here), so we can skip this
-    // step automatically when appliccable, and encourage people to write in
-    // sorted fashion.
-    // std::sort is typically already a lot faster on sorted data though.
     auto dict =
         reinterpret_cast<TwoValue *>(flatbuffers::vector_data(stack_) + start);
-    std::sort(dict, dict + len,
-              [&](const TwoValue &a, const TwoValue &b) -> bool {
-                auto as = reinterpret_cast<const char *>(
-                    flatbuffers::vector_data(buf_) + a.key.u_);
-                auto bs = reinterpret_cast<const char *>(
-                    flatbuffers::vector_data(buf_) + b.key.u_);
-                auto comp = strcmp(as, bs);
-                // If this assertion hits, you've added two keys with the same
-                // value to this map.
-                // TODO: Have to check for pointer equality, as some sort
-                // implementation apparently call this function with the same
-                // element?? Why?
-                FLATBUFFERS_ASSERT(comp || &a == &b);
-                return comp < 0;
-              });
-    // First create a vector out of all keys.
-    // TODO(wvo): if kBuilderFlagShareKeyVectors is true, see if we can share
-    // the first vector.
-    auto keys = CreateVector(start, len, 2, true, false);
+    auto key_less = [&](const TwoValue &a, const TwoValue &b) -> bool {
+      auto as = reinterpret_cast<const char *>(
+          flatbuffers::vector_data(buf_) + a.key.u_);
+      auto bs = reinterpret_cast<const char *>(
+          flatbuffers::vector_data(buf_) + b.key.u_);
+      auto comp = strcmp(as, bs);
+      // If this assertion hits, you've added two keys with the same
+      // value to this map.
+      // TODO: Have to check for pointer equality, as some sort
+      // implementation apparently call this function with the same
+      // element?? Why?
+      FLATBUFFERS_ASSERT(comp || &a == &b);
+      return comp < 0;
+    };
+    // Maps are usually written with their keys in the same order every time,
+    // so it pays to check for sorted input first: that is a single pass, and
+    // the sort would have to compare every pair at least once anyway.
+    size_t sorted = 1;
+    while (sorted < len && key_less(dict[sorted - 1], dict[sorted])) sorted++;
+    if (sorted < len) std::sort(dict, dict + len, key_less);
+    // First create a vector out of all keys, unless an identical one can be
+    // shared. With BUILDER_FLAG_SHARE_KEYS equal keys have equal offsets, so
+    // the offsets identify the key set.
+    Value keys;
+    auto share_keys = (flags_ & BUILDER_FLAG_SHARE_KEY_VECTORS) != 0;
+    if (share_keys) {
+      key_offsets_.clear();
+      for (size_t i = 0; i < len; i++) key_offsets_.push_back(dict[i].key.u_);
+      auto it = key_vector_pool_.find(key_offsets_);
+      if (it != key_vector_pool_.end()) {
+        keys = it->second;
+        share_keys = false;
+      }
+    }
+    if (keys.type_ == FBT_NULL) {
+      keys = CreateVector(start, len, 2, true, false);
+      if (share_keys) key_vector_pool_[key_offsets_] = keys;
+      // Maps sharing these keys find the index after them too.
+      if (IndexKeys(len)) {
+        BuildKeyIndex(len, [&](size_t i) {
+          return reinterpret_cast<const char *>(
+              flatbuffers::vector_data(buf_) + dict[i].key.u_);
+        });
+        WriteKeyIndex(key_index_);
+      }
+    }
     auto vec = CreateVector(start + 1, len, 2, false, false, &keys);
     // Remove temp elements and return map.
     stack_.resize(start);
@@ -1143,6 +1779,75 @@ class Builder FLATBUFFERS_FINAL_CLASS {
     return static_cast<size_t>(vec.u_);
   }
 
+  // Registers a set of keys for maps written with TemplateMap() or
+  // EndTemplateMap(), and returns its id. For these only the values are
+  // written, in the same order as the keys given here: the keys are sorted
+  // once, and serialized once per buffer as a keys vector that all maps of
+  // the template share. Templates stay registered across Clear().
+  size_t RegisterMapTemplate(const char *const *keys, size_t num_keys) {
+    map_templates_.push_back(MapTemplateDef());
+    auto &def = map_templates_.back();
+    def.keys.assign(keys, keys + num_keys);
+    std::vector<std::pair<std::string, size_t>> order;
+    for (size_t i = 0; i < num_keys; i++)
+      order.push_back(std::make_pair(def.keys[i], i));
+    std::sort(order.begin(), order.end());
+    def.sorted_pos.resize(num_keys);
+    for (size_t i = 0; i < num_keys; i++) {
+      // If this assertion hits, you've given the same key twice.
+      FLATBUFFERS_ASSERT(!i || order[i - 1].first != order[i].first);
+      def.keys[i] = order[i].first;
+      def.sorted_pos[order[i].second] = i;
+    }
+    if (IndexKeys(num_keys)) {
+      BuildKeyIndex(num_keys, [&](size_t i) { return def.keys[i].c_str(); });
+      def.key_index = key_index_;
+    }
+    return map_templates_.size() - 1;
+  }
+  size_t RegisterMapTemplate(const std::vector<std::string> &keys) {
+    std::vector<const char *> ptrs;
+    for (auto it = keys.begin(); it != keys.end(); ++it)
+      ptrs.push_back(it->c_str());
+    return RegisterMapTemplate(flatbuffers::vector_data(ptrs), ptrs.size());
+  }
+
+  size_t EndTemplateMap(size_t start, size_t map_template) {
+    auto &def = map_templates_[map_template];
+    auto len = stack_.size() - start;
+    // If this assertion hits, you didn't write a value for every key.
+    FLATBUFFERS_ASSERT(len == def.keys.size());
+    if (def.keys_vector.type_ == FBT_NULL) {
+      // First use in this buffer.
+      auto keys_start = stack_.size();
+      for (auto it = def.keys.begin(); it != def.keys.end(); ++it) Key(*it);
+      def.keys_vector = CreateVector(keys_start, len, 1, true, false);
+      stack_.resize(keys_start);
+      if (!def.key_index.empty()) WriteKeyIndex(def.key_index);
+    }
+    // Put the values in key order.
+    template_values_.assign(stack_.begin() + static_cast<ptrdiff_t>(start),
+                           stack_.end());
+    for (size_t i = 0; i < len; i++)
+      stack_[start + def.sorted_pos[i]] = template_values_[i];
+    auto vec = CreateVector(start, len, 1, false, false, &def.keys_vector);
+    stack_.resize(start);
+    stack_.push_back(vec);
+    return static_cast<size_t>(vec.u_);
+  }
+
+  template<typename F> size_t TemplateMap(size_t map_template, F f) {
+    auto start = StartMap();
+    f();
+    return EndTemplateMap(start, map_template);
+  }
+  template<typename F>
+  size_t TemplateMap(const char *key, size_t map_template, F f) {
+    auto start = StartMap(key);
+    f();
+    return EndTemplateMap(start, map_template);
+  }
+
   template<typename F> size_t Vector(F f) {
     auto start = StartVector();
     f();
@@ -1358,6 +2063,38 @@ class Builder FLATBUFFERS_FINAL_CLASS {
     }
   }
 
+  bool IndexKeys(size_t len) const {
+    return (flags_ & BUILDER_FLAG_INDEX_MAP_KEYS) &&
+           len >= kMinIndexedMapSize && len <= 0x7FFFFFFF;
+  }
+
+  // Builds a hash table of `len` sorted keys into key_index_, with linear
+  // probing. Each 32-bit slot holds the position of a key plus one, or 0 if
+  // it is empty.
+  template<typename KeyAt> void BuildKeyIndex(size_t len, KeyAt key_at) {
+    size_t num_slots = 1;
+    while (num_slots < len * 2) num_slots <<= 1;
+    auto mask = num_slots - 1;
+    key_index_.assign(num_slots, 0);
+    for (size_t i = 0; i < len; i++) {
+      auto h = HashKey(key_at(i)) & mask;
+      while (key_index_[h]) h = (h + 1) & mask;
+      key_index_[h] = static_cast<uint32_t>(i + 1);
+    }
+  }
+
+  // Writes a key index right after a keys vector, before the maps that use
+  // it, so that old readers never look at it. kKeyIndexMagic and the number
+  // of slots (a power of two, at least twice the number of keys) come first,
+  // then the slots, see Map::KeyIndex().
+  void WriteKeyIndex(const std::vector<uint32_t> &slots) {
+    Align(BIT_WIDTH_32);
+    Write(kKeyIndexMagic, sizeof(uint32_t));
+    Write(static_cast<uint32_t>(slots.size()), sizeof(uint32_t));
+    for (auto it = slots.begin(); it != slots.end(); ++it)
+      Write(*it, sizeof(uint32_t));
+  }
+
   void WriteOffset(uint64_t o, uint8_t byte_width) {
     auto reloff = buf_.size() - o;
     FLATBUFFERS_ASSERT(byte_width == 8 || reloff < 1ULL << (byte_width * 8));
@@ -1381,16 +2118,6 @@ class Builder FLATBUFFERS_FINAL_CLASS {
     }
   }
 
-  template<typename T> static Type GetScalarType() {
-    static_assert(flatbuffers::is_scalar<T>::value, "Unrelated types");
-    return flatbuffers::is_floating_point<T>::value
-               ? FBT_FLOAT
-               : flatbuffers::is_same<T, bool>::value
-                     ? FBT_BOOL
-                     : (flatbuffers::is_unsigned<T>::value ? FBT_UINT
-                                                           : FBT_INT);
-  }
-
  public:
   // This was really intended to be private, except for LastValue/ReuseValue.
   struct Value {
@@ -1484,21 +2211,84 @@ class Builder FLATBUFFERS_FINAL_CLASS {
     return sloc;
   }
 
+  // The smallest width all elements fit in, from their minimum and maximum.
+  template<typename T>
+  static BitWidth ScalarsWidth(const T *elems, size_t len) {
+    if (flatbuffers::is_same<T, bool>::value) return BIT_WIDTH_8;
+    if (flatbuffers::is_floating_point<T>::value) {
+      if (sizeof(T) <= sizeof(float)) return BIT_WIDTH_32;
+      auto fits = true;
+      for (size_t i = 0; i < len; i++) {
+        auto d = static_cast<double>(elems[i]);
+        fits &= static_cast<double>(static_cast<float>(d)) == d;
+      }
+      return fits ? BIT_WIDTH_32 : BIT_WIDTH_64;
+    }
+    T lo = 0, hi = 0;
+    for (size_t i = 0; i < len; i++) {
+      lo = elems[i] < lo ? elems[i] : lo;
+      hi = elems[i] > hi ? elems[i] : hi;
+    }
+    if (flatbuffers::is_unsigned<T>::value)
+      return WidthU(static_cast<uint64_t>(hi));
+    return (std::max)(WidthI(static_cast<int64_t>(lo)),
+                      WidthI(static_cast<int64_t>(hi)));
+  }
+
+  // Writes the elements as S, with a memcpy if they already are.
+  template<typename S, typename T>
+  void WriteScalars(const T *elems, size_t len) {
+    // clang-format off
+    #if FLATBUFFERS_LITTLEENDIAN
+      if (flatbuffers::is_same<S, T>::value) {
+        WriteBytes(elems, len * sizeof(T));
+        return;
+      }
+    #endif
+    // clang-format on
+    auto loc = buf_.size();
+    buf_.resize(loc + len * sizeof(S));
+    auto dest = buf_.data() + loc;
+    for (size_t i = 0; i < len; i++) {
+      auto s = flatbuffers::EndianScalar(static_cast<S>(elems[i]));
+      memcpy(dest + i * sizeof(S), &s, sizeof(S));
+    }
+  }
+
   template<typename T>
   size_t ScalarVector(const T *elems, size_t len, bool fixed) {
     auto vector_type = GetScalarType<T>();
-    auto byte_width = sizeof(T);
-    auto bit_width = WidthB(byte_width);
-    // If you get this assert, you're trying to write a vector with a size
-    // field that is bigger than the scalars you're trying to write (e.g. a
-    // byte vector > 255 elements). For such types, write a "blob" instead.
-    // TODO: instead of asserting, could write vector with larger elements
-    // instead, though that would be wasteful.
-    FLATBUFFERS_ASSERT(WidthU(len) <= bit_width);
-    Align(bit_width);
+    // Store the elements as T, unless asked to narrow them to the smallest
+    // width that fits them all. Either way the vector is widened if its size
+    // field doesn't fit (e.g. a byte vector > 255 elements).
+    auto bit_width =
+        (flags_ & BUILDER_FLAG_NARROW_SCALAR_VECTORS)
+            ? (std::max)(force_min_bit_width_, ScalarsWidth(elems, len))
+            : WidthB(sizeof(T));
+    if (!fixed) bit_width = (std::max)(bit_width, WidthU(len));
+    auto byte_width = Align(bit_width);
     if (!fixed) Write<uint64_t>(len, byte_width);
     auto vloc = buf_.size();
-    for (size_t i = 0; i < len; i++) Write(elems[i], byte_width);
+    switch (byte_width) {
+      case 1:
+        if (vector_type == FBT_INT) WriteScalars<int8_t>(elems, len);
+        else WriteScalars<uint8_t>(elems, len);
+        break;
+      case 2:
+        if (vector_type == FBT_INT) WriteScalars<int16_t>(elems, len);
+        else WriteScalars<uint16_t>(elems, len);
+        break;
+      case 4:
+        if (vector_type == FBT_FLOAT) WriteScalars<float>(elems, len);
+        else if (vector_type == FBT_INT) WriteScalars<int32_t>(elems, len);
+        else WriteScalars<uint32_t>(elems, len);
+        break;
+      default:
+        if (vector_type == FBT_FLOAT) WriteScalars<double>(elems, len);
+        else if (vector_type == FBT_INT) WriteScalars<int64_t>(elems, len);
+        else WriteScalars<uint64_t>(elems, len);
+        break;
+    }
     stack_.push_back(Value(static_cast<uint64_t>(vloc),
                            ToTypedVector(vector_type, fixed ? len : 0),
                            bit_width));
@@ -1569,6 +2359,21 @@ class Builder FLATBUFFERS_FINAL_CLASS {
 
   std::vector<uint8_t> buf_;
   std::vector<Value> stack_;
+  std::vector<uint32_t> key_index_;  // Scratch space for BuildKeyIndex().
+
+  // For BUILDER_FLAG_SHARE_KEY_VECTORS: keys vectors by their key offsets.
+  std::map<std::vector<uint64_t>, Value> key_vector_pool_;
+  std::vector<uint64_t> key_offsets_;
+
+  struct MapTemplateDef {
+    std::vector<std::string> keys;  // Sorted.
+    // The position in `keys` of each key, in the order they were registered.
+    std::vector<size_t> sorted_pos;
+    Value keys_vector;  // FBT_NULL until used in the current buffer.
+    std::vector<uint32_t> key_index;
+  };
+  std::vector<MapTemplateDef> map_templates_;
+  std::vector<Value> template_values_;
 
   bool finished_;
 
@@ -1576,37 +2381,405 @@ class Builder FLATBUFFERS_FINAL_CLASS {
 
   BitWidth force_min_bit_width_;
 
-  struct KeyOffsetCompare {
-    explicit KeyOffsetCompare(const std::vector<uint8_t> &buf) : buf_(&buf) {}
-    bool operator()(size_t a, size_t b) const {
-      auto stra =
-          reinterpret_cast<const char *>(flatbuffers::vector_data(*buf_) + a);
-      auto strb =
-          reinterpret_cast<const char *>(flatbuffers::vector_data(*buf_) + b);
-      return strcmp(stra, strb) < 0;
+  // An open addressing hash set of the keys or strings in buf_, by offset,
+  // for sharing them. Clearing it is O(1) and keeps the table, so a Builder
+  // that is reused doesn't allocate for it again.
+  class StringPool {
+   public:
+    StringPool() : size_(0), generation_(1) {}
+
+    void clear() {
+      size_ = 0;
+      // Slots of older generations are empty.
+      if (!++generation_) {
+        slots_.assign(slots_.size(), Slot());
+        generation_ = 1;
+      }
     }
-    const std::vector<uint8_t> *buf_;
+
+    // Returns the offset of an earlier copy of the `len` bytes at `offset` in
+    // `buf`, or adds them to the pool and returns `offset`.
+    size_t Intern(const std::vector<uint8_t> &buf, size_t offset, size_t len) {
+      if ((size_ + 1) * 2 > slots_.size()) Grow();
+      auto data = flatbuffers::vector_data(buf);
+      auto hash = Hash(data + offset, len);
+      auto mask = slots_.size() - 1;
+      for (auto i = hash & mask;; i = (i + 1) & mask) {
+        auto &slot = slots_[i];
+        if (slot.generation != generation_) {
+          slot.offset = offset;
+          slot.len = len;
+          slot.hash = hash;
+          slot.generation = generation_;
+          size_++;
+          return offset;
+        }
+        if (slot.hash == hash && slot.len == len &&
+            !memcmp(data + slot.offset, data + offset, len)) {
+          return slot.offset;
+        }
+      }
+    }
+
+   private:
+    struct Slot {
+      Slot() : offset(0), len(0), hash(0), generation(0) {}
+      size_t offset;
+      size_t len;
+      uint32_t hash;
+      uint32_t generation;
+    };
+
+    static uint32_t Hash(const uint8_t *data, size_t len) {
+      uint32_t hash = 2166136261u;  // FNV-1a.
+      for (size_t i = 0; i < len; i++) {
+        hash ^= data[i];
+        hash *= 16777619u;
+      }
+      return hash;
+    }
+
+    void Grow() {
+      std::vector<Slot> old;
+      old.swap(slots_);
+      slots_.resize(old.empty() ? 64 : old.size() * 2);
+      auto mask = slots_.size() - 1;
+      for (auto it = old.begin(); it != old.end(); ++it) {
+        if (it->generation != generation_) continue;
+        auto i = it->hash & mask;
+        while (slots_[i].generation == generation_) i = (i + 1) & mask;
+        slots_[i] = *it;
+      }
+    }
+
+    std::vector<Slot> slots_;  // A power of two in size, at most half full.
+    size_t size_;
+    uint32_t generation_;
+  };
+
+  StringPool key_pool;
+  StringPool string_pool;
+
+  friend class Updater;
+};
+
+// One step of a path to a value in a FlexBuffer: a map key or a vector index.
+struct PathElement {
+  PathElement(const char *k) : key(k), index(0), is_key(true) {}
+  PathElement(const std::string &k) : key(k), index(0), is_key(true) {}
+  PathElement(size_t i) : index(i), is_key(false) {}
+  PathElement(int i) : index(static_cast<size_t>(i)), is_key(false) {}
+
+  std::string key;
+  size_t index;
+  bool is_key;
+};
+
+typedef std::vector<PathElement> Path;
+
+// Updates a FlexBuffer without serializing it again. Changes are logged with
+// Set(), Remove() and Append(), and Finish() appends their new values to the
+// buffer, followed by new copies of only the maps and vectors on their paths
+// and a new root. Everything else is shared with the previous version, which
+// offsets can point back to, so an update takes time proportional to the
+// size of the maps and vectors it changes rather than the whole buffer.
+// The previous versions remain in the buffer: serialize it again (e.g. with
+// a Walker) to compact it.
+class Updater {
+ public:
+  // Takes over `buffer`, which holds a finished FlexBuffer.
+  explicit Updater(std::vector<uint8_t> &&buffer,
+                   BuilderFlag flags = BUILDER_FLAG_SHARE_KEYS)
+      : builder_(1, flags) {
+    builder_.buf_.swap(buffer);
+    builder_.finished_ = true;
+    committed_ = builder_.buf_.size();
+  }
+
+  // The value at `path` becomes `t`, anything Builder::Add() accepts. Missing
+  // map keys are added.
+  template<typename T> void Set(const Path &path, const T &t) {
+    builder_.Add(t);
+    auto node = Insert(path);
+    node->op = kSet;
+    node->value = Pop();
+  }
+
+  // Removes a map key or a vector element. Later elements move down, but
+  // keep their original index for the other changes in the same Finish().
+  void Remove(const Path &path) { Insert(path)->op = kRemove; }
+
+  // Adds `t` to the end of the vector at `path`.
+  template<typename T> void Append(const Path &path, const T &t) {
+    builder_.Add(t);
+    Insert(path)->appended.push_back(Pop());
+  }
+
+  // Applies the changes since the last Finish(). Returns false, and drops
+  // them, if a path doesn't lead to an existing map or vector or a change
+  // is made inside a value set in the same Finish().
+  bool Finish() {
+    auto &buf = builder_.buf_;
+    auto width = buf[committed_ - 1];
+    Slot root = { committed_ - 2 - width, width, buf[committed_ - 2] };
+    Builder::Value value;
+    auto ok = Rebuild(root, root_, &value);
+    root_ = Node();
+    builder_.stack_.clear();
+    if (ok) {
+      builder_.stack_.push_back(value);
+      builder_.Finish();
+      committed_ = buf.size();
+    } else {
+      // Back to the previous version, whose values the pools may not refer
+      // past.
+      buf.resize(committed_);
+      builder_.key_pool.clear();
+      builder_.string_pool.clear();
+      builder_.key_vector_pool_.clear();
+    }
+    return ok;
+  }
+
+  Reference GetRoot() const { return flexbuffers::GetRoot(GetBuffer()); }
+  const std::vector<uint8_t> &GetBuffer() const { return builder_.buf_; }
+
+ private:
+  enum Op { kNone, kSet, kRemove };
+
+  // The changes below one value, as a tree of paths.
+  struct Node {
+    Node() : elem(0), op(kNone) {}
+    PathElement elem;
+    Op op;
+    Builder::Value value;
+    std::vector<Node> children;
+    std::vector<Builder::Value> appended;
   };
 
-  typedef std::pair<size_t, size_t> StringOffset;
-  struct StringOffsetCompare {
-    explicit StringOffsetCompare(const std::vector<uint8_t> &buf)
-        : buf_(&buf) {}
-    bool operator()(const StringOffset &a, const StringOffset &b) const {
-      auto stra = reinterpret_cast<const char *>(
-          flatbuffers::vector_data(*buf_) + a.first);
-      auto strb = reinterpret_cast<const char *>(
-          flatbuffers::vector_data(*buf_) + b.first);
-      return strncmp(stra, strb, (std::min)(a.second, b.second) + 1) < 0;
-    }
-    const std::vector<uint8_t> *buf_;
+  // A value in the buffer, by position, as the buffer moves when it grows.
+  struct Slot {
+    size_t pos;
+    uint8_t parent_width;
+    uint8_t packed_type;
   };
 
-  typedef std::set<size_t, KeyOffsetCompare> KeyOffsetMap;
-  typedef std::set<StringOffset, StringOffsetCompare> StringOffsetMap;
+  Builder::Value Pop() {
+    auto value = builder_.stack_.back();
+    builder_.stack_.pop_back();
+    return value;
+  }
+
+  Node *Insert(const Path &path) {
+    auto node = &root_;
+    for (auto it = path.begin(); it != path.end(); ++it) {
+      auto child = node->children.begin();
+      while (child != node->children.end() &&
+             (child->elem.is_key != it->is_key ||
+              (it->is_key ? child->elem.key != it->key
+                          : child->elem.index != it->index)))
+        ++child;
+      if (child == node->children.end()) {
+        node->children.push_back(Node());
+        node->children.back().elem = *it;
+        child = node->children.end() - 1;
+      }
+      node = &*child;
+    }
+    return node;
+  }
+
+  Reference At(const Slot &slot) const {
+    return Reference(builder_.buf_.data() + slot.pos, slot.parent_width,
+                     slot.packed_type);
+  }
+
+  // The Value for an unchanged value, referring to it where it is.
+  Builder::Value Existing(const Slot &slot) const {
+    auto ref = At(slot);
+    switch (ref.type_) {
+      case FBT_NULL: return Builder::Value();
+      case FBT_BOOL: return Builder::Value(ref.AsBool());
+      case FBT_INT: {
+        auto i = ref.AsInt64();
+        return Builder::Value(i, FBT_INT, WidthI(i));
+      }
+      case FBT_UINT: {
+        auto u = ref.AsUInt64();
+        return Builder::Value(u, FBT_UINT, WidthU(u));
+      }
+      case FBT_FLOAT: return Builder::Value(ref.AsDouble());
+      default:
+        return Builder::Value(
+            static_cast<uint64_t>(ref.Indirect() - builder_.buf_.data()),
+            ref.type_, Builder::WidthB(ref.byte_width_));
+    }
+  }
+
+  // Writes the new version of `slot` with the changes in `node`.
+  bool Rebuild(const Slot &slot, const Node &node, Builder::Value *value) {
+    if (node.op == kSet) {
+      *value = node.value;
+      return node.children.empty() && node.appended.empty();
+    }
+    if (node.children.empty() && node.appended.empty()) {
+      *value = Existing(slot);
+      return true;
+    }
+    auto ref = At(slot);
+    if (ref.IsMap()) return RebuildMap(ref, node, value);
+    if (ref.IsUntypedVector() || ref.IsTypedVector() ||
+        ref.IsFixedTypedVector())
+      return RebuildVector(ref, node, value);
+    return false;
+  }
+
+  // The elements of a map or vector, by position.
+  void GetSlots(const Reference &ref, std::vector<Slot> *slots) const {
+    auto data = ref.Indirect();
+    auto pos = static_cast<size_t>(data - builder_.buf_.data());
+    auto width = ref.byte_width_;
+    size_t size;
+    auto elem_type = FBT_NULL;
+    if (ref.IsFixedTypedVector()) {
+      uint8_t len = 0;
+      elem_type = ToFixedTypedVectorElementType(ref.type_, &len);
+      size = len;
+    } else {
+      size = static_cast<size_t>(ReadUInt64(data - width, width));
+      if (ref.IsTypedVector()) {
+        elem_type = ToTypedVectorElementType(ref.type_);
+        // See AsTypedVector().
+        if (elem_type == FBT_STRING) elem_type = FBT_KEY;
+      }
+    }
+    for (size_t i = 0; i < size; i++) {
+      // Untyped elements have their type after all elements.
+      auto packed_type = elem_type == FBT_NULL
+                             ? data[size * width + i]
+                             : PackedType(BIT_WIDTH_8, elem_type);
+      Slot slot = { pos + i * width, width, packed_type };
+      slots->push_back(slot);
+    }
+  }
+
+  // Applies the changes in `node` to the elements in `slots`, which `find`
+  // maps path elements to the index of.
+  template<typename F>
+  bool ApplyChanges(const Node &node, const std::vector<Slot> &slots, F find,
+                    std::vector<Op> *ops, std::vector<Builder::Value> *values,
+                    std::vector<const Node *> *added) {
+    ops->assign(slots.size(), kNone);
+    values->resize(slots.size());
+    for (auto child = node.children.begin(); child != node.children.end();
+         ++child) {
+      auto i = find(child->elem);
+      if (i >= slots.size()) {
+        // Only maps can get new elements.
+        if (!added || child->op == kNone) return false;
+        if (child->op == kSet) added->push_back(&*child);
+        continue;
+      }
+      (*ops)[i] = child->op == kRemove ? kRemove : kSet;
+      // This may grow the buffer, see Slot.
+      if (child->op != kRemove && !Rebuild(slots[i], *child, &(*values)[i]))
+        return false;
+    }
+    return true;
+  }
+
+  bool RebuildMap(const Reference &ref, const Node &node,
+                  Builder::Value *value) {
+    if (!node.appended.empty()) return false;
+    std::vector<Slot> slots;
+    GetSlots(ref, &slots);
+    // Keys are stored as offsets into the buffer, which may move.
+    std::vector<uint64_t> keys;
+    auto map_keys = ref.AsMap().Keys();
+    for (size_t i = 0; i < slots.size(); i++) {
+      keys.push_back(static_cast<uint64_t>(
+          reinterpret_cast<const uint8_t *>(map_keys[i].AsKey()) -
+          builder_.buf_.data()));
+    }
+    auto key_at = [&](size_t i) {
+      return reinterpret_cast<const char *>(builder_.buf_.data() + keys[i]);
+    };
+    auto find = [&](const PathElement &elem) {
+      if (!elem.is_key) return static_cast<size_t>(-1);
+      // Keys are sorted.
+      size_t lo = 0, hi = keys.size();
+      while (lo < hi) {
+        auto mid = (lo + hi) / 2;
+        if (strcmp(key_at(mid), elem.key.c_str()) < 0) {
+          lo = mid + 1;
+        } else {
+          hi = mid;
+        }
+      }
+      return lo < keys.size() && elem.key == key_at(lo)
+                 ? lo
+                 : static_cast<size_t>(-1);
+    };
+    std::vector<Op> ops;
+    std::vector<Builder::Value> values;
+    std::vector<const Node *> added;
+    if (!ApplyChanges(node, slots, find, &ops, &values, &added)) return false;
+    auto start = builder_.StartMap();
+    for (size_t i = 0; i < slots.size(); i++) {
+      if (ops[i] == kRemove) continue;
+      builder_.stack_.push_back(Builder::Value(keys[i], FBT_KEY, BIT_WIDTH_8));
+      builder_.stack_.push_back(ops[i] == kSet ? values[i]
+                                               : Existing(slots[i]));
+    }
+    for (auto it = added.begin(); it != added.end(); ++it) {
+      builder_.Key((*it)->elem.key);
+      builder_.stack_.push_back((*it)->value);
+    }
+    builder_.EndMap(start);
+    *value = Pop();
+    return true;
+  }
+
+  bool RebuildVector(const Reference &ref, const Node &node,
+                     Builder::Value *value) {
+    std::vector<Slot> slots;
+    GetSlots(ref, &slots);
+    auto find = [](const PathElement &elem) {
+      return elem.is_key ? static_cast<size_t>(-1) : elem.index;
+    };
+    std::vector<Op> ops;
+    std::vector<Builder::Value> values;
+    if (!ApplyChanges(node, slots, find, &ops, &values, nullptr))
+      return false;
+    auto start = builder_.StartVector();
+    for (size_t i = 0; i < slots.size(); i++) {
+      if (ops[i] == kRemove) continue;
+      builder_.stack_.push_back(ops[i] == kSet ? values[i]
+                                               : Existing(slots[i]));
+    }
+    builder_.stack_.insert(builder_.stack_.end(), node.appended.begin(),
+                           node.appended.end());
+    // Typed vectors stay typed while their elements have one type they can
+    // hold, and fixed ones while their length stays the same too.
+    auto len = builder_.stack_.size() - start;
+    auto elem_type = len ? builder_.stack_[start].type_ : FBT_NULL;
+    auto typed = ref.IsTypedVector() || ref.IsFixedTypedVector();
+    for (auto i = start; i < builder_.stack_.size(); i++) {
+      if (builder_.stack_[i].type_ != elem_type) typed = false;
+    }
+    typed = typed && (elem_type == FBT_INT || elem_type == FBT_UINT ||
+                      elem_type == FBT_FLOAT || elem_type == FBT_KEY ||
+                      elem_type == FBT_BOOL);
+    auto fixed = typed && ref.IsFixedTypedVector() && len == slots.size() &&
+                 elem_type != FBT_KEY && elem_type != FBT_BOOL;
+    builder_.EndVector(start, typed, fixed);
+    *value = Pop();
+    return true;
+  }
 
-  KeyOffsetMap key_pool;
-  StringOffsetMap string_pool;
+  Builder builder_;
+  size_t committed_;  // The end of the current version.
+  Node root_;
 };
 
 }  // namespace flexbuffers
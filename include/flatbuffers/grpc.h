@@ -19,40 +19,106 @@
 
 // Helper functionality to glue FlatBuffers and GRPC.
 
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
 #include "flatbuffers/flatbuffers.h"
 #include "grpc++/support/byte_buffer.h"
 #include "grpc/byte_buffer_reader.h"
 
+// Current gRPC passes a ByteBuffer to SerializationTraits, where older
+// versions, like the 1.15 the tests are pinned to, pass a grpc_byte_buffer.
+// gRPC only started defining its version in grpcpp/version_info.h well after
+// that changed, so any version found there takes a ByteBuffer. Define
+// FLATBUFFERS_GRPC_BYTE_BUFFER_TRAITS to 0 or 1 to override the check.
+// clang-format off
+#ifndef FLATBUFFERS_GRPC_BYTE_BUFFER_TRAITS
+  #if defined(__has_include)
+    #if __has_include(<grpcpp/version_info.h>)
+      #include <grpcpp/version_info.h>
+    #endif
+  #endif
+  #if defined(GRPC_CPP_VERSION_MAJOR)
+    #define FLATBUFFERS_GRPC_BYTE_BUFFER_TRAITS 1
+  #else
+    #define FLATBUFFERS_GRPC_BYTE_BUFFER_TRAITS 0
+  #endif
+#endif
+// clang-format on
+
 namespace flatbuffers {
 namespace grpc {
 
+// What verifying a Message cost, as reported to a VerifyStatsHook.
+struct VerifyStats {
+  VerifyStats() : size(0), runs(0), cache_hits(0), tables(0), nanoseconds(0) {}
+
+  size_t size;           // Of the message.
+  uint32_t runs;         // Verifier runs.
+  uint32_t cache_hits;   // Calls answered by an earlier verification.
+  uint64_t tables;       // Tables verified, over all runs.
+  uint64_t nanoseconds;  // Spent verifying.
+};
+
+// Called as a Message that was verified at all is destroyed, which for an
+// RPC handler is typically at the end of the RPC.
+typedef void (*VerifyStatsHook)(const VerifyStats &stats);
+
+namespace detail {
+inline std::atomic<VerifyStatsHook> &verify_stats_hook() {
+  static std::atomic<VerifyStatsHook> hook(nullptr);
+  return hook;
+}
+}  // namespace detail
+
+// Sets the hook, or clears it with nullptr. Timing verification is only done
+// with a hook set.
+inline void SetVerifyStatsHook(VerifyStatsHook hook) {
+  detail::verify_stats_hook().store(hook);
+}
+
 // Message is a typed wrapper around a buffer that manages the underlying
 // `grpc_slice` and also provides flatbuffers-specific helpers such as `Verify`
 // and `GetRoot`. Since it is backed by a `grpc_slice`, the underlying buffer
 // is refcounted and ownership is be managed automatically.
 template<class T> class Message {
  public:
-  Message() : slice_(grpc_empty_slice()) {}
+  Message() : slice_(grpc_empty_slice()), verified_(kUnverified) {}
 
   Message(grpc_slice slice, bool add_ref)
-      : slice_(add_ref ? grpc_slice_ref(slice) : slice) {}
+      : slice_(add_ref ? grpc_slice_ref(slice) : slice),
+        verified_(kUnverified) {}
 
   Message &operator=(const Message &other) = delete;
 
-  Message(Message &&other) : slice_(other.slice_) {
+  Message(Message &&other)
+      : slice_(other.slice_), verified_(other.verified_), stats_(other.stats_) {
     other.slice_ = grpc_empty_slice();
+    other.verified_ = kUnverified;
+    other.stats_ = VerifyStats();
   }
 
   Message(const Message &other) = delete;
 
   Message &operator=(Message &&other) {
+    ReportStats();
     grpc_slice_unref(slice_);
     slice_ = other.slice_;
+    verified_ = other.verified_;
+    stats_ = other.stats_;
     other.slice_ = grpc_empty_slice();
+    other.verified_ = kUnverified;
+    other.stats_ = VerifyStats();
     return *this;
   }
 
-  ~Message() { grpc_slice_unref(slice_); }
+  ~Message() {
+    ReportStats();
+    grpc_slice_unref(slice_);
+  }
 
   const uint8_t *mutable_data() const { return GRPC_SLICE_START_PTR(slice_); }
 
@@ -60,9 +126,40 @@ template<class T> class Message {
 
   size_t size() const { return GRPC_SLICE_LENGTH(slice_); }
 
+  // Verifies the whole message. Success is remembered, so interceptors and
+  // handlers may each call this for the cost of one verification.
   bool Verify() const {
-    Verifier verifier(data(), size());
-    return verifier.VerifyBuffer<T>(nullptr);
+    if (verified_ == kVerified) {
+      stats_.cache_hits++;
+      return true;
+    }
+    if (!RunVerifier<T>(nullptr, 0)) return false;
+    verified_ = kVerified;
+    return true;
+  }
+
+  // Verifies only the root table, leaving the tables it refers to for
+  // VerifyTable() to verify when a handler reads them.
+  bool VerifyRoot() const {
+    if (verified_ != kUnverified) {
+      stats_.cache_hits++;
+      return true;
+    }
+    if (!RunVerifier<T>(nullptr, 1)) return false;
+    verified_ = kRootVerified;
+    return true;
+  }
+
+  // Verifies a table read from a message verified with VerifyRoot(), and
+  // all it refers to, before its fields are read.
+  template<class U> bool VerifyTable(const U *table) const {
+    FLATBUFFERS_ASSERT(verified_ != kUnverified);
+    if (!table) return true;
+    if (verified_ == kVerified) {
+      stats_.cache_hits++;
+      return true;
+    }
+    return RunVerifier(table, 0);
   }
 
   T *GetMutableRoot() { return flatbuffers::GetMutableRoot<T>(mutable_data()); }
@@ -73,22 +170,169 @@ template<class T> class Message {
   const grpc_slice &BorrowSlice() const { return slice_; }
 
  private:
+  enum Verified { kUnverified, kRootVerified, kVerified };
+
+  // Verifies the message, or just `table` and what it refers to.
+  template<class U>
+  bool RunVerifier(const U *table, uoffset_t lazy_depth) const {
+    auto hook = detail::verify_stats_hook().load();
+    std::chrono::steady_clock::time_point start;
+    if (hook) start = std::chrono::steady_clock::now();
+    Verifier verifier(data(), size());
+    if (lazy_depth) verifier.SetLazyDepth(lazy_depth);
+    auto ok = table ? verifier.VerifyTable(table)
+                    : verifier.VerifyBuffer<T>(nullptr);
+    if (hook) {
+      stats_.nanoseconds += static_cast<uint64_t>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(
+              std::chrono::steady_clock::now() - start)
+              .count());
+    }
+    stats_.runs++;
+    stats_.tables += verifier.GetNumTables();
+    return ok;
+  }
+
+  void ReportStats() {
+    if (!stats_.runs && !stats_.cache_hits) return;
+    if (auto hook = detail::verify_stats_hook().load()) {
+      stats_.size = size();
+      hook(stats_);
+    }
+  }
+
   grpc_slice slice_;
+  mutable Verified verified_;
+  mutable VerifyStats stats_;
 };
 
 class MessageBuilder;
 
+// SlicePool keeps the memory of the slices it hands out once they have been
+// released, by gRPC as well as the application, so that building one message
+// after another, e.g. for a streaming response, doesn't go back to malloc for
+// each of them. Memory is kept in power-of-two size classes, up to
+// `max_cached_bytes` in total. The pool is thread-safe, as slices may be
+// released on any gRPC thread, and slices may outlive it.
+class SlicePool {
+ public:
+  explicit SlicePool(size_t max_cached_bytes = 64 * 1024 * 1024)
+      : state_(std::make_shared<State>(max_cached_bytes)) {}
+
+  SlicePool(const SlicePool &other) = delete;
+  SlicePool &operator=(const SlicePool &other) = delete;
+
+  ~SlicePool() {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    state_->closed = true;
+    state_->Trim();
+  }
+
+  // Returns a slice of `size` bytes, reusing cached memory if possible.
+  grpc_slice Allocate(size_t size) {
+    size_t size_class = kMinSizeClass;
+    while ((static_cast<size_t>(1) << size_class) < size) size_class++;
+    Block *block = nullptr;
+    {
+      std::lock_guard<std::mutex> lock(state_->mutex);
+      auto &cached = state_->cached[size_class];
+      if (!cached.empty()) {
+        block = cached.back();
+        cached.pop_back();
+        state_->cached_bytes -= block->capacity();
+      }
+    }
+    if (!block) {
+      block = new Block;
+      block->size_class = size_class;
+      block->data.reset(new uint8_t[block->capacity()]);
+    }
+    block->state = state_;
+    return grpc_slice_new_with_user_data(block->data.get(), size, &Release,
+                                         block);
+  }
+
+  // The memory held for reuse.
+  size_t cached_bytes() const {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    return state_->cached_bytes;
+  }
+
+  // Frees the memory held for reuse.
+  void Trim() {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    state_->Trim();
+  }
+
+ private:
+  static const size_t kMinSizeClass = 10;
+  static const size_t kNumSizeClasses = sizeof(size_t) * 8;
+
+  struct State;
+
+  struct Block {
+    size_t capacity() const { return static_cast<size_t>(1) << size_class; }
+
+    std::shared_ptr<State> state;  // Only while in use, for Release().
+    std::unique_ptr<uint8_t[]> data;
+    size_t size_class;
+  };
+
+  struct State {
+    explicit State(size_t max_bytes)
+        : max_cached_bytes(max_bytes), cached_bytes(0), closed(false) {}
+
+    // Needs mutex.
+    void Trim() {
+      for (size_t i = 0; i < kNumSizeClasses; i++) {
+        for (auto it = cached[i].begin(); it != cached[i].end(); ++it)
+          delete *it;
+        cached[i].clear();
+      }
+      cached_bytes = 0;
+    }
+
+    std::mutex mutex;
+    std::vector<Block *> cached[kNumSizeClasses];
+    size_t max_cached_bytes;
+    size_t cached_bytes;
+    bool closed;  // Set once the pool is gone.
+  };
+
+  // Called by gRPC when the last reference to a slice is dropped.
+  static void Release(void *user_data) {
+    auto block = static_cast<Block *>(user_data);
+    // Keeps the state alive until the lock is released.
+    auto state = std::move(block->state);
+    std::lock_guard<std::mutex> lock(state->mutex);
+    if (!state->closed &&
+        state->cached_bytes + block->capacity() <= state->max_cached_bytes) {
+      state->cached[block->size_class].push_back(block);
+      state->cached_bytes += block->capacity();
+    } else {
+      delete block;
+    }
+  }
+
+  std::shared_ptr<State> state_;
+};
+
 // SliceAllocator is a gRPC-specific allocator that uses the `grpc_slice`
 // refcounted slices to manage memory ownership. This makes it easy and
-// efficient to transfer buffers to gRPC.
+// efficient to transfer buffers to gRPC. Slices come from `pool` if given,
+// which has to outlive the allocator.
 class SliceAllocator : public Allocator {
  public:
-  SliceAllocator() : slice_(grpc_empty_slice()) {}
+  SliceAllocator() : slice_(grpc_empty_slice()), pool_(nullptr) {}
+
+  explicit SliceAllocator(SlicePool *pool)
+      : slice_(grpc_empty_slice()), pool_(pool) {}
 
   SliceAllocator(const SliceAllocator &other) = delete;
   SliceAllocator &operator=(const SliceAllocator &other) = delete;
 
-  SliceAllocator(SliceAllocator &&other) : slice_(grpc_empty_slice()) {
+  SliceAllocator(SliceAllocator &&other)
+      : slice_(grpc_empty_slice()), pool_(nullptr) {
     // default-construct and swap idiom
     swap(other);
   }
@@ -103,13 +347,14 @@ class SliceAllocator : public Allocator {
   void swap(SliceAllocator &other) {
     using std::swap;
     swap(slice_, other.slice_);
+    swap(pool_, other.pool_);
   }
 
   virtual ~SliceAllocator() { grpc_slice_unref(slice_); }
 
   virtual uint8_t *allocate(size_t size) override {
     FLATBUFFERS_ASSERT(GRPC_SLICE_IS_EMPTY(slice_));
-    slice_ = grpc_slice_malloc(size);
+    slice_ = NewSlice(size);
     return GRPC_SLICE_START_PTR(slice_);
   }
 
@@ -127,7 +372,7 @@ class SliceAllocator : public Allocator {
     FLATBUFFERS_ASSERT(old_size == GRPC_SLICE_LENGTH(slice_));
     FLATBUFFERS_ASSERT(new_size > old_size);
     grpc_slice old_slice = slice_;
-    grpc_slice new_slice = grpc_slice_malloc(new_size);
+    grpc_slice new_slice = NewSlice(new_size);
     uint8_t *new_p = GRPC_SLICE_START_PTR(new_slice);
     memcpy_downward(old_p, old_size, new_p, new_size, in_use_back,
                     in_use_front);
@@ -137,6 +382,10 @@ class SliceAllocator : public Allocator {
   }
 
  private:
+  grpc_slice NewSlice(size_t size) {
+    return pool_ ? pool_->Allocate(size) : grpc_slice_malloc(size);
+  }
+
   grpc_slice &get_slice(uint8_t *p, size_t size) {
     FLATBUFFERS_ASSERT(p == GRPC_SLICE_START_PTR(slice_));
     FLATBUFFERS_ASSERT(size == GRPC_SLICE_LENGTH(slice_));
@@ -144,6 +393,7 @@ class SliceAllocator : public Allocator {
   }
 
   grpc_slice slice_;
+  SlicePool *pool_;
 
   friend class MessageBuilder;
 };
@@ -165,6 +415,13 @@ class MessageBuilder : private detail::SliceAllocatorMember,
   explicit MessageBuilder(uoffset_t initial_size = 1024)
       : FlatBufferBuilder(initial_size, &slice_allocator_, false) {}
 
+  // Builds messages in slices from `pool`, which has to outlive the builder.
+  explicit MessageBuilder(SlicePool *pool, uoffset_t initial_size = 1024)
+      : FlatBufferBuilder(initial_size, &slice_allocator_, false) {
+    // The FlatBufferBuilder doesn't allocate anything until used.
+    slice_allocator_.pool_ = pool;
+  }
+
   MessageBuilder(const MessageBuilder &other) = delete;
   MessageBuilder &operator=(const MessageBuilder &other) = delete;
 
@@ -272,6 +529,33 @@ namespace grpc {
 
 template<class T> class SerializationTraits<flatbuffers::grpc::Message<T>> {
  public:
+#if FLATBUFFERS_GRPC_BYTE_BUFFER_TRAITS
+  static grpc::Status Serialize(const flatbuffers::grpc::Message<T> &msg,
+                                ByteBuffer *buffer, bool *own_buffer) {
+    // Wrap the `grpc_slice` of the `Message<T>` in a `Slice`, and package it
+    // into the `ByteBuffer`, which takes its own reference.
+    Slice slice(msg.BorrowSlice(), Slice::ADD_REF);
+    *buffer = ByteBuffer(&slice, 1);
+    *own_buffer = true;
+    return grpc::Status::OK;
+  }
+
+  static grpc::Status Deserialize(ByteBuffer *buffer,
+                                  flatbuffers::grpc::Message<T> *msg) {
+    // Reference a single uncompressed slice directly, or else copy `buffer`
+    // into a single contiguous slice.
+    Slice slice;
+    if (!buffer->TrySingleSlice(&slice).ok() &&
+        !buffer->DumpToSingleSlice(&slice).ok()) {
+      buffer->Clear();
+      return ::grpc::Status(::grpc::StatusCode::INTERNAL, "No payload");
+    }
+    // `c_slice()` returns a new reference, which the `Message<T>` takes over.
+    *msg = flatbuffers::grpc::Message<T>(slice.c_slice(), false);
+    buffer->Clear();
+    return Verify(msg);
+  }
+#else
   static grpc::Status Serialize(const flatbuffers::grpc::Message<T> &msg,
                                 grpc_byte_buffer **buffer, bool *own_buffer) {
     // We are passed in a `Message<T>`, which is a wrapper around a
@@ -312,8 +596,24 @@ template<class T> class SerializationTraits<flatbuffers::grpc::Message<T>> {
       *msg = flatbuffers::grpc::Message<T>(slice, false);
     }
     grpc_byte_buffer_destroy(buffer);
+    return Verify(msg);
+  }
+#endif
+
+ private:
+  static grpc::Status Verify(flatbuffers::grpc::Message<T> *msg) {
 #if FLATBUFFERS_GRPC_DISABLE_AUTO_VERIFICATION
+    (void)msg;
     return ::grpc::Status::OK;
+#elif FLATBUFFERS_GRPC_LAZY_VERIFICATION
+    // Handlers have to verify the tables below the root they read, with
+    // Message::VerifyTable().
+    if (msg->VerifyRoot()) {
+      return ::grpc::Status::OK;
+    } else {
+      return ::grpc::Status(::grpc::StatusCode::INTERNAL,
+                            "Message verification failed");
+    }
 #else
     if (msg->Verify()) {
       return ::grpc::Status::OK;
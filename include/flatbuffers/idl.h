@@ -29,6 +29,7 @@
 
 #if !defined(FLATBUFFERS_CPP98_STL)
 #  include <functional>
+#  include <unordered_map>
 #endif  // !defined(FLATBUFFERS_CPP98_STL)
 
 // This file defines the data types representing a parsed IDL (Interface
@@ -231,8 +232,16 @@ template<typename T> class SymbolTable {
   }
 
  public:
-  std::map<std::string, T *> dict;  // quick lookup
-  std::vector<T *> vec;             // Used to iterate in order of insertion
+  // clang-format off
+  #ifndef FLATBUFFERS_CPP98_STL
+    typedef std::unordered_map<std::string, T *> Dict;
+  #else
+    typedef std::map<std::string, T *> Dict;
+  #endif  // !FLATBUFFERS_CPP98_STL
+  // clang-format on
+
+  Dict dict;             // quick lookup, in no particular order
+  std::vector<T *> vec;  // Used to iterate in order of insertion
 };
 
 // A name space, as set in the schema.
@@ -338,6 +347,14 @@ struct StructDef : public Definition {
 
   bool Deserialize(Parser &parser, const reflection::Object *object);
 
+  // Same as fields.Lookup(), but through a perfect hash of the field names
+  // built by BuildFieldIndex(). Used for every key when parsing JSON.
+  FieldDef *LookupField(const std::string &field_name) const;
+
+  // Called once all fields have been added, before the struct is shared
+  // between threads. Until then, LookupField() uses fields.Lookup().
+  void BuildFieldIndex();
+
   SymbolTable<FieldDef> fields;
 
   bool fixed;       // If it's struct, not a table.
@@ -348,6 +365,17 @@ struct StructDef : public Definition {
   size_t bytesize;  // Size if fixed.
 
   flatbuffers::unique_ptr<std::string> original_location;
+
+ private:
+  // Maps the hash of a field name to the field, without collisions.
+  struct FieldIndex {
+    FieldIndex() : seed(0), num_fields(0) {}
+
+    std::vector<FieldDef *> slots;  // Power of 2 sized, empty if not built.
+    uint32_t seed;
+    size_t num_fields;  // The size of fields.vec the index was built for.
+  };
+  FieldIndex field_index_;
 };
 
 struct EnumDef;
@@ -556,6 +584,7 @@ struct IDLOptions {
   bool force_defaults;
   bool java_primitive_has_method;
   bool cs_gen_json_serializer;
+  bool grpc_callback_api;
   std::vector<std::string> cpp_includes;
   std::string cpp_std;
   std::string proto_namespace_suffix;
@@ -644,6 +673,7 @@ struct IDLOptions {
         force_defaults(false),
         java_primitive_has_method(false),
         cs_gen_json_serializer(false),
+        grpc_callback_api(false),
         filename_suffix("_generated"),
         filename_extension(),
         lang(IDLOptions::kJava),
@@ -657,6 +687,7 @@ struct IDLOptions {
 struct ParserState {
   ParserState()
       : cursor_(nullptr),
+        source_end_(nullptr),
         line_start_(nullptr),
         line_(0),
         token_(-1),
@@ -665,6 +696,7 @@ struct ParserState {
  protected:
   void ResetState(const char *source) {
     cursor_ = source;
+    source_end_ = source + strlen(source);
     line_ = 0;
     MarkNewLine();
   }
@@ -680,6 +712,7 @@ struct ParserState {
   }
 
   const char *cursor_;
+  const char *source_end_;  // The terminating '\0' of the source.
   const char *line_start_;
   int line_;  // the current line being parsed
   int token_;
@@ -748,6 +781,7 @@ class Parser : public ParserState {
         opts(options),
         uses_flexbuffers_(false),
         source_(nullptr),
+        nested_depth_(0),
         anonymous_counter(0),
         recurse_protection_counter(0) {
     if (opts.force_defaults) { builder_.ForceDefaults(true); }
@@ -807,6 +841,15 @@ class Parser : public ParserState {
   // Mark all definitions as already having code generated.
   void MarkGenerated();
 
+  // Remembers what has been parsed so far, such as the include files shared
+  // by a number of schemas, for RestoreCheckpoint() to go back to after
+  // parsing one of them. Not for .proto files, which may change definitions
+  // parsed before.
+  void SetCheckpoint();
+
+  // Drops all that was parsed since SetCheckpoint().
+  void RestoreCheckpoint();
+
   // Get the files recursively included by the given file. The returned
   // container will have at least the given file.
   std::set<std::string> GetIncludedFilesRecursive(
@@ -837,6 +880,11 @@ class Parser : public ParserState {
 
   StructDef *LookupStruct(const std::string &id) const;
 
+  // Whether the languages being generated for support these, which the
+  // parser checks for.
+  bool SupportsAdvancedUnionFeatures() const;
+  bool SupportsAdvancedArrayFeatures() const;
+
   std::string UnqualifiedName(const std::string &fullQualifiedName);
 
   FLATBUFFERS_CHECKED_ERROR Error(const std::string &msg);
@@ -844,7 +892,6 @@ class Parser : public ParserState {
  private:
   void Message(const std::string &msg);
   void Warning(const std::string &msg);
-  FLATBUFFERS_CHECKED_ERROR ParseHexNum(int nibbles, uint64_t *val);
   FLATBUFFERS_CHECKED_ERROR Next();
   FLATBUFFERS_CHECKED_ERROR SkipByteOrderMark();
   bool Is(int t) const;
@@ -928,8 +975,6 @@ class Parser : public ParserState {
                                        StructDef *struct_def,
                                        const char *suffix, BaseType baseType);
 
-  bool SupportsAdvancedUnionFeatures() const;
-  bool SupportsAdvancedArrayFeatures() const;
   Namespace *UniqueNamespace(Namespace *ns);
 
   FLATBUFFERS_CHECKED_ERROR RecurseError();
@@ -971,8 +1016,46 @@ class Parser : public ParserState {
 
   std::vector<std::pair<Value, FieldDef *>> field_stack_;
 
+  // Builders for nested flatbuffers, one per level of nesting, kept around
+  // to be reused by the next nested flatbuffer at the same level.
+  std::vector<flatbuffers::unique_ptr<FlatBufferBuilder>> nested_builders_;
+  size_t nested_depth_;
+
   int anonymous_counter;
   int recurse_protection_counter;
+
+  // The state SetCheckpoint() saved: how many of each kind of definition
+  // there were, what parsing later ones may change in those, and copies of
+  // the rest.
+  struct Checkpoint {
+    Checkpoint()
+        : types(0),
+          structs(0),
+          enums(0),
+          services(0),
+          namespaces(0),
+          root_struct_def(nullptr),
+          uses_flexbuffers(false),
+          anonymous_counter(0) {}
+
+    size_t types;
+    size_t structs;
+    size_t enums;
+    size_t services;
+    size_t namespaces;
+    std::vector<std::pair<int, bool>> definitions;  // refcount, generated
+    StructDef *root_struct_def;
+    std::string file_identifier;
+    std::string go_module;
+    std::string file_extension;
+    std::map<std::string, std::string> included_files;
+    std::map<std::string, std::set<std::string>> files_included_per_file;
+    std::vector<std::string> native_included_files;
+    std::map<std::string, bool> known_attributes;
+    bool uses_flexbuffers;
+    int anonymous_counter;
+  };
+  Checkpoint checkpoint_;
 };
 
 // Utility functions for multiple generators:
@@ -994,15 +1077,57 @@ extern bool GenerateTextFromTable(const Parser &parser, const void *table,
                                   std::string *text);
 extern bool GenerateText(const Parser &parser, const void *flatbuffer,
                          std::string *text);
+// Same as above, but hands the text to `sink` in chunks as it is generated,
+// so memory use stays bounded for large buffers.
+extern bool GenerateText(const Parser &parser, const void *flatbuffer,
+                         TextSink *sink);
 extern bool GenerateTextFile(const Parser &parser, const std::string &path,
                              const std::string &file_name);
 
+// Tuning for ParseNdjson().
+struct NdjsonOptions {
+  NdjsonOptions() : num_threads(0), chunk_size(1 << 20) {}
+
+  unsigned num_threads;  // Parser threads, 0 for one per hardware thread.
+  size_t chunk_size;     // Bytes of input (rounded up to whole lines) a
+                         // thread parses at a time.
+};
+
+// Parse newline-delimited JSON, one object per line (blank lines are skipped),
+// with the binary schema `schema` (see Parser::Serialize()) and `opts`.
+// Every object is written to `sink` as a size-prefixed FlatBuffer, in input
+// order. Chunks of lines are parsed concurrently, each thread with its own
+// Parser loaded from `schema`, so the output does not depend on the number
+// of threads. On failure, returns false with the first error in input order
+// in *error, and all the objects before it written to `sink`.
+// See ndjson.cpp.
+extern bool ParseNdjson(const uint8_t *schema, size_t schema_size,
+                        const IDLOptions &opts, const char *ndjson,
+                        size_t size, TextSink *sink, std::string *error,
+                        const NdjsonOptions &ndjson_opts = NdjsonOptions());
+
+// Parse schemaless JSON straight into `builder`, and Finish() it. This accepts
+// the same input as Parser::Parse() with opts.use_flexbuffers, and honors
+// opts.strict_json and opts.allow_non_utf8, but is much lighter: there is no
+// tokenizer or Parser state, and the builder can be Clear()-ed and reused for
+// the next document. On failure, returns false with the error in *error and,
+// if error_pos is given, where in `json` it was found.
+// See idl_parser.cpp.
+extern bool ParseFlexBufferJson(const char *json, const IDLOptions &opts,
+                                flexbuffers::Builder *builder,
+                                std::string *error,
+                                const char **error_pos = nullptr);
+
 // Generate binary files from a given FlatBuffer, and a given Parser
 // object that has been populated with the corresponding schema.
 // See code_generators.cpp.
 extern bool GenerateBinary(const Parser &parser, const std::string &path,
                            const std::string &file_name);
 
+// The name of the file GenerateBinary() writes to.
+extern std::string BinaryFileName(const Parser &parser, const std::string &path,
+                                  const std::string &file_name);
+
 // Generate a C++ header from the definitions in the Parser object.
 // See idl_gen_cpp.
 extern bool GenerateCPP(const Parser &parser, const std::string &path,
@@ -0,0 +1,571 @@
+/*
+ * Copyright 2020 Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FLATBUFFERS_QUERY_H_
+#define FLATBUFFERS_QUERY_H_
+
+#include "flatbuffers/flatbuffers.h"
+#include "flatbuffers/minireflect.h"
+
+// clang-format off
+#if defined(__AVX2__) && FLATBUFFERS_LITTLEENDIAN && \
+    !defined(FLATBUFFERS_QUERY_NO_SIMD)
+  #include <immintrin.h>
+  #define FLATBUFFERS_QUERY_AVX2 1
+#endif
+// clang-format on
+
+namespace flatbuffers {
+
+// Predicate scans over vectors of tables or structs.
+// A Query is a conjunction of `field op constant` comparisons that is resolved
+// once against the "mini reflection" type table of the element type (generate
+// code with --reflect-names), and can then be evaluated over any number of
+// vectors without per-schema code:
+//
+//   flatbuffers::Query q(MonsterTypeTable());
+//   q.Where("hp", flatbuffers::QO_GT, 100, 100);
+//   q.WhereEnum("color", flatbuffers::QO_EQ, "Red", "Blue");
+//   std::vector<flatbuffers::uoffset_t> rows;
+//   q.Filter(monsters, &rows);
+//
+// Results are produced as a selection bitmap (bit i of word i / 64 is set if
+// element i matched), or as a list of matching indices.
+// Predicates are evaluated column-at-a-time over blocks of 64 elements, and
+// blocks that an earlier predicate already rejected are skipped.
+// When compiled with AVX2, 32-bit fields are loaded with hardware gathers,
+// for tables this includes the vtable lookups.
+
+enum QueryOp { QO_EQ, QO_NE, QO_LT, QO_LE, QO_GT, QO_GE };
+
+// A single comparison, resolved against a type table.
+struct QueryPredicate {
+  ElementaryType type;
+  // vtable offset of the field for tables, byte offset for structs.
+  uoffset_t offset;
+  QueryOp op;
+  // The constant in the domain of the field type (only one is used).
+  int64_t ival;
+  uint64_t uval;
+  double dval;
+  // Value of a table field that is not present in the buffer.
+  int64_t idef;
+  uint64_t udef;
+  double ddef;
+};
+
+/// @cond FLATBUFFERS_INTERNAL
+struct QueryEq {
+  template<typename T> bool operator()(T a, T b) const { return a == b; }
+};
+struct QueryNe {
+  template<typename T> bool operator()(T a, T b) const { return a != b; }
+};
+struct QueryLt {
+  template<typename T> bool operator()(T a, T b) const { return a < b; }
+};
+struct QueryLe {
+  template<typename T> bool operator()(T a, T b) const { return a <= b; }
+};
+struct QueryGt {
+  template<typename T> bool operator()(T a, T b) const { return a > b; }
+};
+struct QueryGe {
+  template<typename T> bool operator()(T a, T b) const { return a >= b; }
+};
+
+inline size_t QueryPopCount(uint64_t w) {
+  // clang-format off
+  #if defined(__GNUC__) || defined(__clang__)
+    return static_cast<size_t>(__builtin_popcountll(w));
+  #else
+    size_t n = 0;
+    for (; w; w &= w - 1) n++;
+    return n;
+  #endif
+  // clang-format on
+}
+
+inline size_t QueryLowestBit(uint64_t w) {
+  FLATBUFFERS_ASSERT(w);
+  // clang-format off
+  #if defined(__GNUC__) || defined(__clang__)
+    return static_cast<size_t>(__builtin_ctzll(w));
+  #else
+    size_t n = 0;
+    while (!(w & 1)) { w >>= 1; n++; }
+    return n;
+  #endif
+  // clang-format on
+}
+
+// Where the elements of the scanned vector live.
+struct QuerySource {
+  const uint8_t *data;  // Vector::Data().
+  size_t count;
+  size_t stride;  // sizeof(uoffset_t) for tables, struct size otherwise.
+  bool is_table;
+};
+
+// Scalar kernels, producing the match bits of elements [start, start + n).
+template<typename Cmp, typename T, typename W>
+uint64_t QueryStructBlock(const QuerySource &src, uoffset_t offset,
+                          size_t start, size_t n, W value) {
+  Cmp cmp;
+  uint64_t bits = 0;
+  auto p = src.data + start * src.stride + offset;
+  for (size_t j = 0; j < n; j++, p += src.stride) {
+    bits |= static_cast<uint64_t>(cmp(static_cast<W>(ReadScalar<T>(p)), value))
+            << j;
+  }
+  return bits;
+}
+
+template<typename Cmp, typename T, typename W>
+uint64_t QueryTableBlock(const QuerySource &src, uoffset_t offset,
+                         size_t start, size_t n, W value, W def) {
+  Cmp cmp;
+  uint64_t bits = 0;
+  auto p = src.data + start * sizeof(uoffset_t);
+  for (size_t j = 0; j < n; j++, p += sizeof(uoffset_t)) {
+    auto table = reinterpret_cast<const Table *>(p + ReadScalar<uoffset_t>(p));
+    auto field = table->GetAddressOf(static_cast<voffset_t>(offset));
+    auto v = field ? static_cast<W>(ReadScalar<T>(field)) : def;
+    bits |= static_cast<uint64_t>(cmp(v, value)) << j;
+  }
+  return bits;
+}
+
+template<typename T, typename W>
+uint64_t QueryBlock(const QuerySource &src, const QueryPredicate &pred,
+                    size_t start, size_t n, W value, W def) {
+  // clang-format off
+  #define FLATBUFFERS_QUERY_BLOCK(CMP) \
+    return src.is_table \
+      ? QueryTableBlock<CMP, T, W>(src, pred.offset, start, n, value, def) \
+      : QueryStructBlock<CMP, T, W>(src, pred.offset, start, n, value)
+  switch (pred.op) {
+    case QO_EQ: FLATBUFFERS_QUERY_BLOCK(QueryEq);
+    case QO_NE: FLATBUFFERS_QUERY_BLOCK(QueryNe);
+    case QO_LT: FLATBUFFERS_QUERY_BLOCK(QueryLt);
+    case QO_LE: FLATBUFFERS_QUERY_BLOCK(QueryLe);
+    case QO_GT: FLATBUFFERS_QUERY_BLOCK(QueryGt);
+    case QO_GE: FLATBUFFERS_QUERY_BLOCK(QueryGe);
+  }
+  #undef FLATBUFFERS_QUERY_BLOCK
+  // clang-format on
+  return 0;
+}
+
+#ifdef FLATBUFFERS_QUERY_AVX2
+// Compares 8 lanes of 32-bit values, returns one bit per lane.
+inline uint64_t QueryCompare8(__m256i a, __m256i b, QueryOp op,
+                              ElementaryType type) {
+  if (type == ET_FLOAT) {
+    auto fa = _mm256_castsi256_ps(a);
+    auto fb = _mm256_castsi256_ps(b);
+    __m256 m;
+    switch (op) {
+      case QO_EQ: m = _mm256_cmp_ps(fa, fb, _CMP_EQ_OQ); break;
+      case QO_NE: m = _mm256_cmp_ps(fa, fb, _CMP_NEQ_UQ); break;
+      case QO_LT: m = _mm256_cmp_ps(fa, fb, _CMP_LT_OQ); break;
+      case QO_LE: m = _mm256_cmp_ps(fa, fb, _CMP_LE_OQ); break;
+      case QO_GT: m = _mm256_cmp_ps(fa, fb, _CMP_GT_OQ); break;
+      default: m = _mm256_cmp_ps(fa, fb, _CMP_GE_OQ); break;
+    }
+    return static_cast<uint64_t>(_mm256_movemask_ps(m));
+  }
+  if (type == ET_UINT) {
+    // Bias to make the signed compares below order unsigned values.
+    auto bias = _mm256_set1_epi32(static_cast<int32_t>(0x80000000u));
+    a = _mm256_xor_si256(a, bias);
+    b = _mm256_xor_si256(b, bias);
+  }
+  __m256i m;
+  bool negate = false;
+  switch (op) {
+    case QO_EQ: m = _mm256_cmpeq_epi32(a, b); break;
+    case QO_NE: m = _mm256_cmpeq_epi32(a, b); negate = true; break;
+    case QO_LT: m = _mm256_cmpgt_epi32(b, a); break;
+    case QO_LE: m = _mm256_cmpgt_epi32(a, b); negate = true; break;
+    case QO_GT: m = _mm256_cmpgt_epi32(a, b); break;
+    default: m = _mm256_cmpgt_epi32(b, a); negate = true; break;
+  }
+  auto bits = static_cast<uint64_t>(_mm256_movemask_ps(_mm256_castsi256_ps(m)));
+  return negate ? bits ^ 0xFF : bits;
+}
+
+// Returns the 32-bit pattern of the predicate constant (or default) if the
+// gather kernel can represent it exactly in the field type.
+inline bool QueryLane32(const QueryPredicate &pred, bool def, int32_t *out) {
+  switch (pred.type) {
+    case ET_INT: {
+      auto v = def ? pred.idef : pred.ival;
+      if (v != static_cast<int32_t>(v)) return false;
+      *out = static_cast<int32_t>(v);
+      return true;
+    }
+    case ET_UINT: {
+      auto v = def ? pred.udef : pred.uval;
+      if (v != static_cast<uint32_t>(v)) return false;
+      *out = static_cast<int32_t>(static_cast<uint32_t>(v));
+      return true;
+    }
+    case ET_FLOAT: {
+      auto v = def ? pred.ddef : pred.dval;
+      auto f = static_cast<float>(v);
+      if (static_cast<double>(f) != v) return false;
+      memcpy(out, &f, sizeof(f));
+      return true;
+    }
+    default: return false;
+  }
+}
+
+// Gather kernel for 32-bit fields. Processes whole groups of 8 elements and
+// returns how many elements it handled, the rest goes to the scalar kernel.
+// All indices are 32-bit offsets relative to the vector data, which holds
+// for any buffer within FLATBUFFERS_MAX_BUFFER_SIZE.
+inline size_t QueryGatherBlock(const QuerySource &src,
+                               const QueryPredicate &pred, size_t start,
+                               size_t n, uint64_t *bits) {
+  int32_t value, def = 0;
+  if (!QueryLane32(pred, false, &value)) return 0;
+  if (src.is_table && !QueryLane32(pred, true, &def)) return 0;
+  if ((src.count + 8) * src.stride + pred.offset >= FLATBUFFERS_MAX_BUFFER_SIZE)
+    return 0;
+  auto base = reinterpret_cast<const int *>(src.data);
+  auto vvalue = _mm256_set1_epi32(value);
+  auto lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+  auto stride = _mm256_set1_epi32(static_cast<int32_t>(src.stride));
+  auto lane_offsets = _mm256_mullo_epi32(lanes, stride);
+  size_t j = 0;
+  for (; j + 8 <= n; j += 8) {
+    auto first = static_cast<int32_t>((start + j) * src.stride);
+    auto elems = _mm256_add_epi32(_mm256_set1_epi32(first), lane_offsets);
+    __m256i vals;
+    if (src.is_table) {
+      auto zero = _mm256_setzero_si256();
+      // Table positions, then vtable positions.
+      auto uoffs = _mm256_loadu_si256(
+          reinterpret_cast<const __m256i *>(src.data + first));
+      auto tables = _mm256_add_epi32(elems, uoffs);
+      auto vtables =
+          _mm256_sub_epi32(tables, _mm256_i32gather_epi32(base, tables, 1));
+      // Field offset if voffset < vtable size, else 0. The 16-bit entry is
+      // read as the upper half of a 32-bit load so it stays inside the vtable.
+      auto vsizes = _mm256_and_si256(_mm256_i32gather_epi32(base, vtables, 1),
+                                     _mm256_set1_epi32(0xFFFF));
+      auto voff = _mm256_set1_epi32(static_cast<int32_t>(pred.offset));
+      auto in_vtable = _mm256_cmpgt_epi32(vsizes, voff);
+      auto field_offs = _mm256_srli_epi32(
+          _mm256_mask_i32gather_epi32(
+              zero, base,
+              _mm256_add_epi32(vtables, _mm256_set1_epi32(
+                                            static_cast<int32_t>(pred.offset) -
+                                            2)),
+              in_vtable, 1),
+          16);
+      auto present = _mm256_xor_si256(_mm256_cmpeq_epi32(field_offs, zero),
+                                      _mm256_set1_epi32(-1));
+      vals = _mm256_mask_i32gather_epi32(_mm256_set1_epi32(def), base,
+                                         _mm256_add_epi32(tables, field_offs),
+                                         present, 1);
+    } else {
+      vals = _mm256_i32gather_epi32(
+          base,
+          _mm256_add_epi32(elems,
+                           _mm256_set1_epi32(static_cast<int32_t>(pred.offset))),
+          1);
+    }
+    *bits |= QueryCompare8(vals, vvalue, pred.op, pred.type) << j;
+  }
+  return j;
+}
+#endif  // FLATBUFFERS_QUERY_AVX2
+
+// Splits a constant into sign and magnitude, if it is an integer whose
+// magnitude fits in 64 bits.
+template<typename T>
+bool QueryIntegerValue(T value, bool *negative, uint64_t *magnitude) {
+  if (flatbuffers::is_floating_point<T>::value) {
+    auto d = static_cast<double>(value);
+    const double limit = 18446744073709551616.0;  // 2^64.
+    if (!(d > -limit && d < limit)) return false;  // Also rejects NaN.
+    *negative = d < 0;
+    auto m = *negative ? -d : d;
+    *magnitude = static_cast<uint64_t>(m);
+    return static_cast<double>(*magnitude) == m;
+  }
+  auto s = static_cast<int64_t>(value);
+  *negative = numeric_limits<T>::is_signed && s < 0;
+  *magnitude = *negative ? 0 - static_cast<uint64_t>(s)
+                         : static_cast<uint64_t>(value);
+  return true;
+}
+
+// Converts a constant to the domain QueryEvalBlock compares a field of type
+// `type` in. Returns false if the field can't hold the constant: it is out of
+// range, or not an integer for an integer field.
+template<typename T>
+bool QueryConstant(ElementaryType type, T value, int64_t *ival, uint64_t *uval,
+                   double *dval) {
+  bool is_signed;
+  unsigned bits;
+  switch (type) {
+    case ET_FLOAT:
+    case ET_DOUBLE: *dval = static_cast<double>(value); return true;
+    case ET_UTYPE:
+    case ET_BOOL:
+    case ET_UCHAR: is_signed = false; bits = 8; break;
+    case ET_CHAR: is_signed = true; bits = 8; break;
+    case ET_SHORT: is_signed = true; bits = 16; break;
+    case ET_USHORT: is_signed = false; bits = 16; break;
+    case ET_INT: is_signed = true; bits = 32; break;
+    case ET_UINT: is_signed = false; bits = 32; break;
+    case ET_LONG: is_signed = true; bits = 64; break;
+    case ET_ULONG: is_signed = false; bits = 64; break;
+    default: return false;
+  }
+  bool negative;
+  uint64_t magnitude;
+  if (!QueryIntegerValue(value, &negative, &magnitude)) return false;
+  if (!is_signed) {
+    if (negative || (bits < 64 && magnitude >> bits)) return false;
+    *uval = magnitude;
+    return true;
+  }
+  // The magnitude of the smallest value of the type.
+  auto min_magnitude = static_cast<uint64_t>(1) << (bits - 1);
+  if (negative ? magnitude > min_magnitude : magnitude >= min_magnitude)
+    return false;
+  *ival = negative ? -static_cast<int64_t>(magnitude - 1) - 1
+                   : static_cast<int64_t>(magnitude);
+  return true;
+}
+
+inline uint64_t QueryEvalBlock(const QuerySource &src,
+                               const QueryPredicate &pred, size_t start,
+                               size_t n) {
+  uint64_t bits = 0;
+  size_t done = 0;
+  // clang-format off
+  #ifdef FLATBUFFERS_QUERY_AVX2
+    done = QueryGatherBlock(src, pred, start, n, &bits);
+    if (done == n) return bits;
+  #endif
+  // clang-format on
+  start += done;
+  n -= done;
+  uint64_t rest = 0;
+  switch (pred.type) {
+    case ET_UTYPE:
+    case ET_BOOL:
+    case ET_UCHAR:
+      rest = QueryBlock<uint8_t>(src, pred, start, n, pred.uval, pred.udef);
+      break;
+    case ET_CHAR:
+      rest = QueryBlock<int8_t>(src, pred, start, n, pred.ival, pred.idef);
+      break;
+    case ET_SHORT:
+      rest = QueryBlock<int16_t>(src, pred, start, n, pred.ival, pred.idef);
+      break;
+    case ET_USHORT:
+      rest = QueryBlock<uint16_t>(src, pred, start, n, pred.uval, pred.udef);
+      break;
+    case ET_INT:
+      rest = QueryBlock<int32_t>(src, pred, start, n, pred.ival, pred.idef);
+      break;
+    case ET_UINT:
+      rest = QueryBlock<uint32_t>(src, pred, start, n, pred.uval, pred.udef);
+      break;
+    case ET_LONG:
+      rest = QueryBlock<int64_t>(src, pred, start, n, pred.ival, pred.idef);
+      break;
+    case ET_ULONG:
+      rest = QueryBlock<uint64_t>(src, pred, start, n, pred.uval, pred.udef);
+      break;
+    case ET_FLOAT:
+      rest = QueryBlock<float>(src, pred, start, n, pred.dval, pred.ddef);
+      break;
+    case ET_DOUBLE:
+      rest = QueryBlock<double>(src, pred, start, n, pred.dval, pred.ddef);
+      break;
+    default: FLATBUFFERS_ASSERT(false);
+  }
+  return bits | (rest << done);
+}
+/// @endcond
+
+class Query {
+ public:
+  explicit Query(const TypeTable *type_table) : type_table_(type_table) {
+    FLATBUFFERS_ASSERT(type_table_->st == ST_TABLE ||
+                       type_table_->st == ST_STRUCT);
+  }
+
+  // Adds the conjunct `field op value`. The value is converted to the domain
+  // of the field type (64-bit signed, unsigned or floating point).
+  // Type tables carry no default values: `default_value` is what a table
+  // field that is absent from the buffer compares as, and should match the
+  // default in the schema. It is ignored for structs.
+  // Returns false if the field is unknown or not a scalar, or if the value or
+  // default is not a value of the field type (e.g. -1 for an unsigned field,
+  // or 2.5 for an integer field).
+  template<typename T>
+  bool Where(const char *field, QueryOp op, T value, T default_value = 0) {
+    QueryPredicate pred;
+    if (!Resolve(field, op, &pred)) return false;
+    pred.ival = pred.idef = 0;
+    pred.uval = pred.udef = 0;
+    pred.dval = pred.ddef = 0;
+    if (!QueryConstant(pred.type, value, &pred.ival, &pred.uval, &pred.dval))
+      return false;
+    if (type_table_->st == ST_TABLE &&
+        !QueryConstant(pred.type, default_value, &pred.idef, &pred.udef,
+                       &pred.ddef))
+      return false;
+    predicates_.push_back(pred);
+    return true;
+  }
+
+  // As above, for a field of enum type compared to one of its values by name.
+  // A null `default_name` means the enum value 0.
+  bool WhereEnum(const char *field, QueryOp op, const char *name,
+                 const char *default_name = nullptr) {
+    int64_t value = 0, def = 0;
+    if (!LookupEnumValue(field, name, &value)) return false;
+    if (default_name && !LookupEnumValue(field, default_name, &def))
+      return false;
+    return Where(field, op, value, def);
+  }
+
+  // Number of elements matching all predicates, with their bits set in
+  // `selection`. A query without predicates selects everything.
+  template<typename T>
+  size_t Select(const Vector<Offset<T>> *vec,
+                std::vector<uint64_t> *selection) const {
+    FLATBUFFERS_ASSERT(type_table_->st == ST_TABLE);
+    QuerySource src = { vec->Data(), vec->size(), sizeof(uoffset_t), true };
+    return Select(src, selection);
+  }
+
+  template<typename T>
+  size_t Select(const Vector<const T *> *vec,
+                std::vector<uint64_t> *selection) const {
+    FLATBUFFERS_ASSERT(type_table_->st == ST_STRUCT);
+    QuerySource src = { vec->Data(), vec->size(),
+                        static_cast<size_t>(
+                            type_table_->values[type_table_->num_elems]),
+                        false };
+    return Select(src, selection);
+  }
+
+  // Indices of the elements matching all predicates, in ascending order.
+  template<typename V>
+  size_t Filter(const V *vec, std::vector<uoffset_t> *indices) const {
+    std::vector<uint64_t> selection;
+    auto n = Select(vec, &selection);
+    SelectionToIndices(selection, indices);
+    return n;
+  }
+
+  size_t Select(const QuerySource &src,
+                std::vector<uint64_t> *selection) const {
+    auto words = (src.count + 63) / 64;
+    selection->assign(words, ~static_cast<uint64_t>(0));
+    if (src.count % 64) selection->back() >>= 64 - src.count % 64;
+    for (auto it = predicates_.begin(); it != predicates_.end(); ++it) {
+      for (size_t w = 0; w < words; w++) {
+        auto &word = (*selection)[w];
+        if (!word) continue;
+        auto start = w * 64;
+        auto n = std::min(src.count - start, static_cast<size_t>(64));
+        word &= QueryEvalBlock(src, *it, start, n);
+      }
+    }
+    size_t count = 0;
+    for (size_t w = 0; w < words; w++) count += QueryPopCount((*selection)[w]);
+    return count;
+  }
+
+  static void SelectionToIndices(const std::vector<uint64_t> &selection,
+                                 std::vector<uoffset_t> *indices) {
+    indices->clear();
+    for (size_t w = 0; w < selection.size(); w++) {
+      for (auto word = selection[w]; word; word &= word - 1) {
+        indices->push_back(
+            static_cast<uoffset_t>(w * 64 + QueryLowestBit(word)));
+      }
+    }
+  }
+
+  const std::vector<QueryPredicate> &predicates() const { return predicates_; }
+
+ private:
+  // Index of `field` in the type table, or -1.
+  int64_t FieldIndex(const char *field) const {
+    // Field names are only present with --reflect-names.
+    FLATBUFFERS_ASSERT(type_table_->names);
+    if (!type_table_->names) return -1;
+    for (size_t i = 0; i < type_table_->num_elems; i++) {
+      if (!strcmp(type_table_->names[i], field)) return static_cast<int64_t>(i);
+    }
+    return -1;
+  }
+
+  bool Resolve(const char *field, QueryOp op, QueryPredicate *pred) const {
+    auto i = FieldIndex(field);
+    if (i < 0) return false;
+    auto idx = static_cast<size_t>(i);
+    auto type_code = type_table_->type_codes[idx];
+    auto type = static_cast<ElementaryType>(type_code.base_type);
+    if (type_code.is_vector || type == ET_STRING || type == ET_SEQUENCE)
+      return false;
+    pred->type = type;
+    pred->op = op;
+    pred->offset =
+        type_table_->st == ST_TABLE
+            ? FieldIndexToOffset(static_cast<voffset_t>(idx))
+            : static_cast<uoffset_t>(type_table_->values[idx]);
+    return true;
+  }
+
+  bool LookupEnumValue(const char *field, const char *name,
+                       int64_t *value) const {
+    auto i = FieldIndex(field);
+    if (i < 0) return false;
+    auto ref = type_table_->type_codes[i].sequence_ref;
+    if (ref < 0) return false;
+    auto enum_table = type_table_->type_refs[ref]();
+    if (enum_table->st != ST_ENUM || !enum_table->names) return false;
+    for (size_t j = 0; j < enum_table->num_elems; j++) {
+      if (!strcmp(enum_table->names[j], name)) {
+        *value = enum_table->values ? enum_table->values[j]
+                                    : static_cast<int64_t>(j);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  const TypeTable *type_table_;
+  std::vector<QueryPredicate> predicates_;
+};
+
+}  // namespace flatbuffers
+
+#endif  // FLATBUFFERS_QUERY_H_
@@ -26,8 +26,15 @@
 
 // Helper functionality for reflection.
 
+namespace flexbuffers {
+class Builder;
+class Reference;
+}  // namespace flexbuffers
+
 namespace flatbuffers {
 
+class TextSink;
+
 // ------------------------- GETTERS -------------------------
 
 inline bool IsScalar(reflection::BaseType t) {
@@ -473,6 +480,115 @@ bool Verify(const reflection::Schema &schema, const reflection::Object &root,
             uoffset_t max_depth = 64,
             uoffset_t max_tables = 1000000);
 
+// ------------------------- SCHEMA VIEW -------------------------
+
+// Answers the lookups otherwise made on a Parser directly from a binary
+// schema (.bfbs), e.g. one opened with MappedFile. Unlike
+// Parser::Deserialize(), nothing is copied or built up front: Init() only
+// verifies the buffer, and InitUnverified() skips even that for schemas that
+// are trusted, so it costs the same to set up however large the schema is.
+// The buffer must outlive the view.
+class SchemaView {
+ public:
+  // The IDLOptions that affect text output, with the same defaults.
+  struct TextOptions {
+    TextOptions()
+        : indent_step(2),
+          strict_json(false),
+          output_default_scalars_in_json(false),
+          output_enum_identifiers(true),
+          allow_non_utf8(false),
+          natural_utf8(false),
+          protobuf_ascii_alike(false),
+          size_prefixed(false) {}
+
+    int indent_step;
+    bool strict_json;
+    bool output_default_scalars_in_json;
+    bool output_enum_identifiers;
+    bool allow_non_utf8;
+    bool natural_utf8;
+    bool protobuf_ascii_alike;
+    bool size_prefixed;
+  };
+
+  SchemaView() : schema_(nullptr) {}
+
+  // Returns false if buf doesn't hold a valid binary schema.
+  bool Init(const uint8_t *buf, size_t size);
+
+  // Same, only checking the file identifier, for a buffer known to hold a
+  // valid schema, e.g. one built into the program.
+  bool InitUnverified(const uint8_t *buf, size_t size);
+
+  const reflection::Schema *schema() const { return schema_; }
+
+  // Finds a table or struct by name. A name that isn't fully qualified is
+  // resolved as if used in namespace `scope`, innermost namespace first.
+  const reflection::Object *LookupObject(const std::string &name,
+                                         const std::string &scope = "") const;
+
+  // Finds an enum or union by name, like LookupObject().
+  const reflection::Enum *LookupEnum(const std::string &name,
+                                     const std::string &scope = "") const;
+
+  const reflection::Object *RootTable() const {
+    return schema_ ? schema_->root_table() : nullptr;
+  }
+
+  static const reflection::Field *LookupField(const reflection::Object &object,
+                                              const std::string &name) {
+    return object.fields()->LookupByKey(name.c_str());
+  }
+
+  // The table stored in a nested_flatbuffer field of object, or null if
+  // field isn't one.
+  const reflection::Object *NestedFlatBuffer(
+      const reflection::Object &object, const reflection::Field &field) const;
+
+  // Generates the same JSON as GenerateText() does with a Parser holding the
+  // schema. The bit_flags, nested_flatbuffer and flexbuffer attributes are
+  // only stored in schemas written with --bfbs-builtins.
+  bool GenerateText(const void *flatbuffer, const TextOptions &opts,
+                    std::string *text) const;
+
+  // Same, streaming the text to a sink with bounded memory use.
+  bool GenerateText(const void *flatbuffer, const TextOptions &opts,
+                    TextSink *sink) const;
+
+  // Same, for a table or struct of the given type.
+  bool GenerateText(const reflection::Object &object, const Table *table,
+                    const TextOptions &opts, std::string *text) const;
+
+  // Writes the FlatBuffer a FlexBuffer holding the equivalent of its JSON
+  // stands for, such as the output of Parser::ParseFlexBuffer(), without
+  // going through text: maps become tables and structs, and enums and union
+  // types can be given by name, the same as in JSON. Finishes fbb. Returns
+  // false with a message in `error` if the FlexBuffer doesn't fit the
+  // schema.
+  bool FlexBufferToFlatBuffer(const flexbuffers::Reference &flex,
+                              FlatBufferBuilder *fbb, std::string *error) const;
+
+  // Same, for a table of the given type.
+  bool FlexBufferToFlatBuffer(const reflection::Object &object,
+                              const flexbuffers::Reference &flex,
+                              FlatBufferBuilder *fbb, std::string *error) const;
+
+  // The reverse: writes tables and structs as maps of their fields that are
+  // set, and enums as their values. Finishes flex. Like GenerateText(), this
+  // expects a verified FlatBuffer.
+  bool FlatBufferToFlexBuffer(const void *flatbuffer,
+                              flexbuffers::Builder *flex) const;
+
+  // Same, for a table of the given type.
+  bool FlatBufferToFlexBuffer(const reflection::Object &object,
+                              const Table *table,
+                              flexbuffers::Builder *flex) const;
+
+ private:
+  const reflection::Schema *schema_;
+};
+
 }  // namespace flatbuffers
 
 #endif  // FLATBUFFERS_REFLECTION_H_
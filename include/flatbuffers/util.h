@@ -24,10 +24,13 @@
 #ifndef FLATBUFFERS_PREFER_PRINTF
 #  include <sstream>
 #else  // FLATBUFFERS_PREFER_PRINTF
-#  include <float.h>
 #  include <stdio.h>
 #endif  // FLATBUFFERS_PREFER_PRINTF
 
+#include <float.h>
+
+#include <cmath>
+#include <cstdio>
 #include <iomanip>
 #include <string>
 
@@ -107,10 +110,53 @@ std::string NumToStringImplWrapper(T t, const char *fmt, int precision = 0) {
 }
 #endif  // FLATBUFFERS_PREFER_PRINTF
 
-// Convert an integer or floating point value to a string.
-// In contrast to std::stringstream, "char" values are
-// converted to a string of digits, and we don't use scientific notation.
-template<typename T> std::string NumToString(T t) {
+// Writes the decimal digits of `v` so that they end right before `end`, two
+// digits at a time, and returns a pointer to the first digit.
+inline char *UInt64ToDecimal(uint64_t v, char *end) {
+  static const char kDigitPairs[] =
+      "00010203040506070809101112131415161718192021222324252627282930313233343536"
+      "37383940414243444546474849505152535455565758596061626364656667686970717273"
+      "74757677787980818283848586878889909192939495969798"
+      "99";
+  while (v >= 100) {
+    auto pair = static_cast<size_t>(v % 100) * 2;
+    v /= 100;
+    end -= 2;
+    memcpy(end, kDigitPairs + pair, 2);
+  }
+  if (v >= 10) {
+    end -= 2;
+    memcpy(end, kDigitPairs + static_cast<size_t>(v) * 2, 2);
+  } else {
+    *--end = static_cast<char>('0' + v);
+  }
+  return end;
+}
+
+// Integers are formatted without going through a stream.
+template<typename T> void AppendIntToString(T t, std::string *out) {
+  char buf[24];  // 20 digits for 2^64 and a sign.
+  auto end = buf + sizeof(buf);
+  auto u = static_cast<uint64_t>(t);
+  auto neg = !flatbuffers::is_unsigned<T>::value && static_cast<int64_t>(t) < 0;
+  auto start = UInt64ToDecimal(neg ? 0 - u : u, end);
+  if (neg) *--start = '-';
+  out->append(start, end);
+}
+
+template<typename T> std::string IntToString(T t) {
+  std::string s;
+  AppendIntToString(t, &s);
+  return s;
+}
+
+template<typename T>
+std::string NumToStringImpl(T t, flatbuffers::integral_constant<bool, true>) {
+  return IntToString(t);
+}
+
+template<typename T>
+std::string NumToStringImpl(T t, flatbuffers::integral_constant<bool, false>) {
   // clang-format off
 
   #ifndef FLATBUFFERS_PREFER_PRINTF
@@ -123,6 +169,15 @@ template<typename T> std::string NumToString(T t) {
   #endif // FLATBUFFERS_PREFER_PRINTF
   // clang-format on
 }
+
+// Convert an integer or floating point value to a string.
+// In contrast to std::stringstream, "char" values are
+// converted to a string of digits, and we don't use scientific notation.
+template<typename T> std::string NumToString(T t) {
+  return NumToStringImpl(
+      t, flatbuffers::integral_constant<
+             bool, flatbuffers::is_integral<T>::value>());
+}
 // Avoid char types used as character data.
 template<> inline std::string NumToString<signed char>(signed char t) {
   return NumToString(static_cast<int>(t));
@@ -148,8 +203,95 @@ inline std::string NumToString<unsigned long long>(unsigned long long t) {
 }
 #endif  // defined(FLATBUFFERS_CPP98_STL)
 
+// Full 128-bit product of two 64-bit values.
+inline void Mul64To128(uint64_t a, uint64_t b, uint64_t *hi, uint64_t *lo) {
+  const uint64_t mask = 0xFFFFFFFFULL;
+  auto a0 = a & mask, a1 = a >> 32, b0 = b & mask, b1 = b >> 32;
+  auto p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+  auto mid = (p00 >> 32) + (p01 & mask) + (p10 & mask);
+  *lo = (mid << 32) | (p00 & mask);
+  *hi = p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+}
+
+// Fixed notation with `precision` fractional digits, without trailing zeros.
+// The result is rounded exactly (half to even) from the binary value, like
+// printf("%.*f") in the default rounding mode, but using integer arithmetic
+// only. Handles finite values below 2^53, returns false for anything else.
+inline bool FixedFloatToString(double t, int precision, std::string *out) {
+  if (precision < 1 || precision > 19) return false;
+  uint64_t bits;
+  memcpy(&bits, &t, sizeof(bits));
+  auto neg = (bits >> 63) != 0;
+  auto a = neg ? -t : t;
+  if (!(a < 9007199254740992.0)) return false;  // 2^53, also NaN and Inf.
+  auto ip = static_cast<uint64_t>(a);
+  auto f = a - static_cast<double>(ip);  // Exact.
+  uint64_t scale = 1;
+  for (int i = 0; i < precision; i++) scale *= 10;
+  uint64_t q = 0;
+  if (f > 0) {
+    // f = m * 2^-s, with s >= 53 since f < 1.
+    memcpy(&bits, &f, sizeof(bits));
+    auto exponent = static_cast<int>((bits >> 52) & 0x7FF);
+    auto m = bits & ((1ULL << 52) - 1);
+    int s = 1074;
+    if (exponent) {
+      m |= 1ULL << 52;
+      s = 1075 - exponent;
+    }
+    // q = round(m * scale / 2^s), the product has at most 117 bits.
+    uint64_t hi, lo;
+    Mul64To128(m, scale, &hi, &lo);
+    if (s < 128) {
+      uint64_t rem_hi, rem_lo, half_hi, half_lo;
+      if (s < 64) {
+        q = (hi << (64 - s)) | (lo >> s);
+        rem_hi = 0;
+        rem_lo = lo & ((1ULL << s) - 1);
+        half_hi = 0;
+        half_lo = 1ULL << (s - 1);
+      } else if (s == 64) {
+        q = hi;
+        rem_hi = 0;
+        rem_lo = lo;
+        half_hi = 0;
+        half_lo = 1ULL << 63;
+      } else {
+        q = hi >> (s - 64);
+        rem_hi = hi & ((1ULL << (s - 64)) - 1);
+        rem_lo = lo;
+        half_hi = 1ULL << (s - 65);
+        half_lo = 0;
+      }
+      auto above = rem_hi > half_hi || (rem_hi == half_hi && rem_lo > half_lo);
+      auto tie = rem_hi == half_hi && rem_lo == half_lo;
+      if (above || (tie && (q & 1))) q++;
+    }  // Else the product is below 2^-11: rounds to 0.
+    if (q >= scale) {
+      q -= scale;
+      ip++;
+    }
+  }
+  char buf[48];
+  auto end = buf + sizeof(buf);
+  // Fractional digits, zero padded to `precision`, then trailing zeros
+  // stripped except for one.
+  auto frac = UInt64ToDecimal(q, end);
+  while (frac > end - precision) *--frac = '0';
+  auto last = end;
+  while (last - frac > 1 && last[-1] == '0') last--;
+  *--frac = '.';
+  auto start = UInt64ToDecimal(ip, frac);
+  if (neg) *--start = '-';
+  out->assign(start, last);
+  return true;
+}
+
 // Special versions for floats/doubles.
 template<typename T> std::string FloatToString(T t, int precision) {
+  std::string fast;
+  if (FixedFloatToString(static_cast<double>(t), precision, &fast))
+    return fast;
   // clang-format off
 
   #ifndef FLATBUFFERS_PREFER_PRINTF
@@ -241,6 +383,22 @@ inline std::string IntToStringHex(int i, int xdigits) {
   #endif
 #endif
 
+// Float parsing of the strto* functions above is correctly rounded for float
+// only if strtof is used, otherwise the double result is narrowed.
+#if defined(FLATBUFFERS_LOCALE_INDEPENDENT) && (FLATBUFFERS_LOCALE_INDEPENDENT > 0)
+  #define FLATBUFFERS_EXACT_STRTOF 1
+#else
+  #define FLATBUFFERS_EXACT_STRTOF 0
+#endif
+
+// The fast float path below relies on float/double arithmetic not being
+// evaluated with extra precision (e.g. x87).
+#if defined(FLT_EVAL_METHOD) && (FLT_EVAL_METHOD == 0)
+  #define FLATBUFFERS_FAST_FLOAT_PARSE 1
+#else
+  #define FLATBUFFERS_FAST_FLOAT_PARSE 0
+#endif
+
 inline void strtoval_impl(int64_t *val, const char *str, char **endptr,
                                  int base) {
     *val = __strtoll_impl(str, endptr, base);
@@ -266,6 +424,291 @@ inline void strtoval_impl(float *val, const char *str, char **endptr) {
 #undef __strtof_impl
 // clang-format on
 
+// Fast paths for plain decimal numbers, which is most of what JSON contains.
+// They produce exactly the results of the strto* functions above, and return
+// false for anything else (hex, inf/nan, whitespace, too many digits), which
+// then goes through the general code.
+
+// True if all 8 bytes (loaded little-endian) are ASCII digits.
+inline bool IsEightDigits(uint64_t v) {
+  return ((v & 0xF0F0F0F0F0F0F0F0ULL) == 0x3030303030303030ULL) &&
+         (((v + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) ==
+          0x3030303030303030ULL);
+}
+
+// Converts 8 ASCII digits, first digit in the lowest byte, in a few
+// multiplications instead of a loop (SWAR).
+inline uint64_t EightDigitsToNumber(uint64_t v) {
+  v -= 0x3030303030303030ULL;
+  v = (v * 10) + (v >> 8);
+  return (((v & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32))) +
+          (((v >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))) >>
+         32;
+}
+
+// Accumulates up to `len` leading digits of `s` into `*val`, returns the
+// number of digits consumed. The caller guards against overflow.
+inline size_t ParseDecimalDigits(const char *s, size_t len, uint64_t *val) {
+  size_t i = 0;
+  // clang-format off
+  #if FLATBUFFERS_LITTLEENDIAN
+    for (; i + 8 <= len; i += 8) {
+      uint64_t chunk;
+      memcpy(&chunk, s + i, sizeof(chunk));
+      if (!IsEightDigits(chunk)) break;
+      *val = *val * 100000000 + EightDigitsToNumber(chunk);
+    }
+  #endif
+  // clang-format on
+  for (; i < len && is_digit(s[i]); i++) {
+    *val = *val * 10 + static_cast<uint64_t>(s[i] - '0');
+  }
+  return i;
+}
+
+// Parses `[+-]?[0-9]{1,18}` (the entire string), which always fits int64_t.
+inline bool FastStringToInt64(const char *str, int64_t *val) {
+  auto s = str;
+  auto neg = *s == '-';
+  if (neg || *s == '+') s++;
+  auto len = strlen(s);
+  if (len == 0 || len > 18) return false;
+  uint64_t u = 0;
+  if (ParseDecimalDigits(s, len, &u) != len) return false;
+  *val = neg ? -static_cast<int64_t>(u) : static_cast<int64_t>(u);
+  return true;
+}
+
+// Splits `[+-]?digits[.digits]([eE][+-]?digits)?` (the entire string) into
+// sign * w * 10^e10, if w has at most 19 significant digits.
+inline bool ParseSimpleDecimal(const char *str, bool *neg, uint64_t *w,
+                               int *e10) {
+  auto s = str;
+  *neg = *s == '-';
+  if (*neg || *s == '+') s++;
+  while (*s == '0' && s[1] == '0') s++;  // Leading zeros are not significant.
+  auto len = strlen(s);
+  *w = 0;
+  auto int_digits = ParseDecimalDigits(s, len < 19 ? len : 19, w);
+  s += int_digits;
+  if (is_digit(*s)) return false;  // More than 19 digits.
+  size_t frac_digits = 0;
+  if (*s == '.') {
+    s++;
+    len = strlen(s);
+    auto room = 19 - int_digits;
+    // Zeros right after the point of "0.00123" are not significant either.
+    if (!*w) {
+      while (s[frac_digits] == '0' && frac_digits < len) frac_digits++;
+      room = 19;
+    }
+    auto n = ParseDecimalDigits(s + frac_digits, len - frac_digits < room
+                                                     ? len - frac_digits
+                                                     : room,
+                                w);
+    frac_digits += n;
+    s += frac_digits;
+    if (is_digit(*s)) return false;
+  }
+  if (!int_digits && !frac_digits) return false;
+  auto exponent = -static_cast<int>(frac_digits);
+  if (*s == 'e' || *s == 'E') {
+    s++;
+    auto eneg = *s == '-';
+    if (eneg || *s == '+') s++;
+    int e = 0, n = 0;
+    for (; is_digit(*s) && n < 4; s++, n++) e = e * 10 + (*s - '0');
+    if (!n || is_digit(*s)) return false;
+    exponent += eneg ? -e : e;
+  }
+  *e10 = exponent;
+  return !*s;
+}
+
+// Number of significant bits in v.
+inline int BitLength(uint64_t v) {
+  int n = 0;
+  for (; v >= 0x10000; v >>= 16) n += 16;
+  for (; v; v >>= 1) n++;
+  return n;
+}
+
+// Divides the 128-bit value (hi, lo) by d, if hi < d (so the quotient fits in
+// 64 bits). Long division with 32-bit digits, see Hacker's Delight, divlu.
+inline uint64_t Div128By64(uint64_t hi, uint64_t lo, uint64_t d,
+                           uint64_t *rem) {
+  FLATBUFFERS_ASSERT(hi < d);
+  const uint64_t b = 1ULL << 32;
+  auto s = 64 - BitLength(d);
+  d <<= s;
+  auto dn1 = d >> 32, dn0 = d & 0xFFFFFFFF;
+  auto un32 = (hi << s) | (s ? lo >> (64 - s) : 0);
+  auto un10 = lo << s;
+  auto un1 = un10 >> 32, un0 = un10 & 0xFFFFFFFF;
+  auto q1 = un32 / dn1, rhat = un32 - q1 * dn1;
+  while (q1 >= b || q1 * dn0 > b * rhat + un1) {
+    q1--;
+    rhat += dn1;
+    if (rhat >= b) break;
+  }
+  auto un21 = un32 * b + un1 - q1 * d;
+  auto q0 = un21 / dn1;
+  rhat = un21 - q0 * dn1;
+  while (q0 >= b || q0 * dn0 > b * rhat + un0) {
+    q0--;
+    rhat += dn1;
+    if (rhat >= b) break;
+  }
+  *rem = (un21 * b + un0 - q0 * d) >> s;
+  return q1 * b + q0;
+}
+
+// Rounds q * 2^e2 (plus a non-zero fraction below q's last bit if `sticky`)
+// to `bits` significant bits, half to even.
+inline void RoundMantissa(uint64_t q, bool sticky, int bits, uint64_t *m,
+                          int *e2) {
+  auto shift = BitLength(q) - bits;
+  if (shift <= 0) {
+    FLATBUFFERS_ASSERT(!sticky);
+    *m = q;
+    return;
+  }
+  auto rem = q & ((1ULL << shift) - 1);
+  auto half = 1ULL << (shift - 1);
+  *m = q >> shift;
+  if (rem > half || (rem == half && (sticky || (*m & 1)))) {
+    if (++*m >> bits) {
+      *m >>= 1;
+      shift++;
+    }
+  }
+  *e2 += shift;
+}
+
+// Correctly rounds w * 10^e10 (w > 0, |e10| <= 19) to a binary floating point
+// value with `bits` of mantissa, returned as m * 2^e2. All the intermediate
+// values fit in 128 bits, so no approximation is involved.
+inline bool DecimalToBinary(uint64_t w, int e10, int bits, uint64_t *m,
+                            int *e2) {
+  static const uint64_t kPow10[] = { 1ULL,
+                                     10ULL,
+                                     100ULL,
+                                     1000ULL,
+                                     10000ULL,
+                                     100000ULL,
+                                     1000000ULL,
+                                     10000000ULL,
+                                     100000000ULL,
+                                     1000000000ULL,
+                                     10000000000ULL,
+                                     100000000000ULL,
+                                     1000000000000ULL,
+                                     10000000000000ULL,
+                                     100000000000000ULL,
+                                     1000000000000000ULL,
+                                     10000000000000000ULL,
+                                     100000000000000000ULL,
+                                     1000000000000000000ULL,
+                                     10000000000000000000ULL };
+  if (!w || e10 < -19 || e10 > 19) return false;
+  if (e10 >= 0) {
+    uint64_t hi, lo;
+    Mul64To128(w, kPow10[e10], &hi, &lo);
+    *e2 = 0;
+    if (hi) {
+      // Drop the low bits of the 128-bit product into the sticky bit.
+      auto shift = BitLength(hi);
+      *e2 = shift;
+      auto q = hi;
+      auto sticky = lo != 0;
+      if (shift < 64) {
+        q = (hi << (64 - shift)) | (lo >> shift);
+        sticky = (lo << (64 - shift)) != 0;
+      }
+      RoundMantissa(q, sticky, bits, m, e2);
+    } else {
+      RoundMantissa(lo, false, bits, m, e2);
+    }
+    return true;
+  }
+  // w / 10^k: scale w up so the quotient has 63 or 64 significant bits.
+  auto d = kPow10[-e10];
+  auto sh = 63 - BitLength(w) + BitLength(d);
+  auto hi = sh >= 64 ? w << (sh - 64) : (sh ? w >> (64 - sh) : 0);
+  auto lo = sh >= 64 ? 0 : w << sh;
+  uint64_t rem;
+  auto q = Div128By64(hi, lo, d, &rem);
+  *e2 = -sh;
+  RoundMantissa(q, rem != 0, bits, m, e2);
+  return true;
+}
+
+// Clinger's fast path: if w and 10^|e10| are both exact in the floating
+// point type, a single multiplication or division is correctly rounded.
+// Otherwise, DecimalToBinary handles up to 19 digits and |e10| <= 19.
+inline bool FastStringToFloat(const char *str, double *val) {
+  // clang-format off
+  #if FLATBUFFERS_FAST_FLOAT_PARSE
+    static const double kPow10[] = {
+      1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+      1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+    bool neg;
+    uint64_t w;
+    int e10;
+    if (!ParseSimpleDecimal(str, &neg, &w, &e10)) return false;
+    double d;
+    if (w <= (1ULL << 53) && e10 >= -22 && e10 <= 22) {
+      d = static_cast<double>(w);
+      d = e10 < 0 ? d / kPow10[-e10] : d * kPow10[e10];
+    } else {
+      uint64_t m;
+      int e2;
+      if (!DecimalToBinary(w, e10, 53, &m, &e2)) return false;
+      d = std::ldexp(static_cast<double>(m), e2);
+    }
+    *val = neg ? -d : d;
+    return true;
+  #else
+    (void)str;
+    (void)val;
+    return false;
+  #endif
+  // clang-format on
+}
+
+inline bool FastStringToFloat(const char *str, float *val) {
+  // clang-format off
+  #if FLATBUFFERS_FAST_FLOAT_PARSE && FLATBUFFERS_EXACT_STRTOF
+    static const float kPow10[] = {
+      1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f
+    };
+    bool neg;
+    uint64_t w;
+    int e10;
+    if (!ParseSimpleDecimal(str, &neg, &w, &e10)) return false;
+    float f;
+    if (w <= (1ULL << 24) && e10 >= -10 && e10 <= 10) {
+      f = static_cast<float>(w);
+      f = e10 < 0 ? f / kPow10[-e10] : f * kPow10[e10];
+    } else {
+      uint64_t m;
+      int e2;
+      if (!DecimalToBinary(w, e10, 24, &m, &e2)) return false;
+      f = std::ldexp(static_cast<float>(m), e2);
+    }
+    *val = neg ? -f : f;
+    return true;
+  #else
+    // Matches strtod() followed by a narrowing conversion.
+    double d;
+    if (!FastStringToFloat(str, &d)) return false;
+    *val = static_cast<float>(d);
+    return true;
+  #endif
+  // clang-format on
+}
+
 // Adaptor for strtoull()/strtoll().
 // Flatbuffers accepts numbers with any count of leading zeros (-009 is -9),
 // while strtoll with base=0 interprets first leading zero as octal prefix.
@@ -309,6 +752,7 @@ template<typename T>
 inline bool StringToFloatImpl(T *val, const char *const str) {
   // Type T must be either float or double.
   FLATBUFFERS_ASSERT(str && val);
+  if (FastStringToFloat(str, val)) return true;
   auto end = str;
   strtoval_impl(val, str, const_cast<char **>(&end));
   auto done = (end != str) && (*end == '\0');
@@ -326,7 +770,7 @@ template<typename T> inline bool StringToNumber(const char *s, T *val) {
   FLATBUFFERS_ASSERT(s && val);
   int64_t i64;
   // The errno check isn't needed, will return MAX/MIN on overflow.
-  if (StringToIntegerImpl(&i64, s, 0, false)) {
+  if (FastStringToInt64(s, &i64) || StringToIntegerImpl(&i64, s, 0, false)) {
     const int64_t max = (flatbuffers::numeric_limits<T>::max)();
     const int64_t min = flatbuffers::numeric_limits<T>::lowest();
     if (i64 > max) {
@@ -347,11 +791,16 @@ template<typename T> inline bool StringToNumber(const char *s, T *val) {
 }
 
 template<> inline bool StringToNumber<int64_t>(const char *str, int64_t *val) {
-  return StringToIntegerImpl(val, str);
+  return FastStringToInt64(str, val) || StringToIntegerImpl(val, str);
 }
 
 template<>
 inline bool StringToNumber<uint64_t>(const char *str, uint64_t *val) {
+  int64_t i64;
+  if (*str != '-' && FastStringToInt64(str, &i64)) {
+    *val = static_cast<uint64_t>(i64);
+    return true;
+  }
   if (!StringToIntegerImpl(val, str)) return false;
   // The strtoull accepts negative numbers:
   // If the minus sign was part of the input sequence, the numeric value
@@ -393,12 +842,22 @@ inline uint64_t StringToUInt(const char *s, int base = 10) {
 typedef bool (*LoadFileFunction)(const char *filename, bool binary,
                                  std::string *dest);
 typedef bool (*FileExistsFunction)(const char *filename);
+typedef bool (*SaveFileFunction)(const char *filename, const char *buf,
+                                 size_t len, bool binary);
 
 LoadFileFunction SetLoadFileFunction(LoadFileFunction load_file_function);
 
 FileExistsFunction SetFileExistsFunction(
     FileExistsFunction file_exists_function);
 
+typedef bool (*SaveTempFileFunction)(const char *tmp_filename,
+                                     const char *filename, bool binary);
+
+SaveFileFunction SetSaveFileFunction(SaveFileFunction save_file_function);
+
+SaveTempFileFunction SetSaveTempFileFunction(
+    SaveTempFileFunction save_temp_file_function);
+
 // Check if file "name" exists.
 bool FileExists(const char *name);
 
@@ -426,6 +885,57 @@ inline bool SaveFile(const char *name, const std::string &buf, bool binary) {
   return SaveFile(name, buf.c_str(), buf.size(), binary);
 }
 
+// Replace file "name" with the already written file "tmp_name", which is
+// gone afterwards, returning true if successful, false otherwise. For output
+// too large to hold in memory: "tmp_name" is written in pieces and then
+// saved here, which like SaveFile can be intercepted. "binary" is the mode
+// "tmp_name" was written in. On failure "name" is left as it was.
+bool SaveTempFile(const char *tmp_name, const char *name, bool binary);
+
+// The contents of a file, mapped into memory where the platform allows, so
+// that even large files open without being read up front. Falls back to
+// reading the file with LoadFile.
+class MappedFile {
+ public:
+  MappedFile() : data_(nullptr), size_(0), mapped_(false) {}
+  ~MappedFile() { Close(); }
+
+  bool Open(const char *name);
+  void Close();
+
+  const uint8_t *data() const { return data_; }
+  size_t size() const { return size_; }
+
+ private:
+  FLATBUFFERS_DELETE_FUNC(MappedFile(const MappedFile &))
+  FLATBUFFERS_DELETE_FUNC(MappedFile &operator=(const MappedFile &))
+
+  const uint8_t *data_;
+  size_t size_;
+  bool mapped_;
+  std::string contents_;  // When not mapped.
+};
+
+// Receives generated text in chunks, so that output larger than memory can
+// be produced. Write() returns false to abort generation.
+class TextSink {
+ public:
+  virtual ~TextSink() {}
+  virtual bool Write(const char *data, size_t size) = 0;
+};
+
+// A TextSink that writes to a stdio FILE, which it doesn't own.
+class FileTextSink : public TextSink {
+ public:
+  explicit FileTextSink(FILE *file) : file_(file) {}
+  bool Write(const char *data, size_t size) FLATBUFFERS_OVERRIDE {
+    return fwrite(data, 1, size, file_) == size;
+  }
+
+ private:
+  FILE *file_;
+};
+
 // Functionality for minimalistic portable path handling.
 
 // The functions below behave correctly regardless of whether posix ('/') or
@@ -16,44 +16,868 @@
 
 #include "flatbuffers/flatc.h"
 
+#include <algorithm>
+#include <condition_variable>
 #include <list>
+#include <mutex>
+#include <thread>
+
+// clang-format off
+#ifndef _WIN32
+  #include <errno.h>
+  #include <signal.h>
+  #include <sys/socket.h>
+  #include <sys/un.h>
+  #include <unistd.h>
+#endif
+// clang-format on
 
 namespace flatbuffers {
 
 const char *FLATC_VERSION() { return FLATBUFFERS_VERSION(); }
 
-void FlatCompiler::ParseFile(
-    flatbuffers::Parser &parser, const std::string &filename,
-    const std::string &contents,
-    std::vector<const char *> &include_directories) const {
+namespace {
+
+// Runs task(0) ... task(count - 1) on up to num_threads threads, starting
+// the tasks in order.
+class TaskPool {
+ public:
+  TaskPool(size_t count, unsigned num_threads,
+           const std::function<void(size_t)> &task)
+      : count_(count),
+        task_(task),
+        next_(0),
+        finished_(count, false),
+        stopped_(false) {
+    for (unsigned i = 0; i < num_threads && i < count; i++)
+      threads_.push_back(std::thread(&TaskPool::Work, this));
+  }
+
+  ~TaskPool() { Stop(); }
+
+  // Waits for task i, and all tasks before it, to finish. Runs task i on the
+  // calling thread if no thread has started it yet.
+  void Wait(size_t i) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (next_ == i) {
+      next_++;
+      lock.unlock();
+      task_(i);
+      lock.lock();
+      finished_[i] = true;
+      return;
+    }
+    while (!finished_[i]) cv_.wait(lock);
+  }
+
+  // Starts no more tasks on the threads, and waits for the running ones.
+  void Stop() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopped_ = true;
+    }
+    for (auto it = threads_.begin(); it != threads_.end(); ++it) it->join();
+    threads_.clear();
+  }
+
+ private:
+  void Work() {
+    for (;;) {
+      size_t i;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopped_ || next_ == count_) return;
+        i = next_++;
+      }
+      task_(i);
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        finished_[i] = true;
+      }
+      cv_.notify_all();
+    }
+  }
+
+  const size_t count_;
+  const std::function<void(size_t)> task_;
+  std::vector<std::thread> threads_;
+
+  // Guarded by mutex_.
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  size_t next_;  // The next task to start.
+  std::vector<bool> finished_;
+  bool stopped_;
+};
+
+// Adds len bytes at data to hash.
+uint64_t HashBytes(uint64_t hash, const char *data, size_t len) {
+  for (size_t i = 0; i < len; i++) {
+    hash ^= static_cast<uint8_t>(data[i]);
+    hash *= FnvTraits<uint64_t>::kFnvPrime;
+  }
+  return hash;
+}
+
+// Hashes all of contents, which may hold zero bytes.
+uint64_t HashContents(const std::string &contents) {
+  return HashBytes(FnvTraits<uint64_t>::kOffsetBasis, contents.data(),
+                   contents.size());
+}
+
+// Hashes the file at path a chunk at a time, like HashContents would its
+// contents.
+bool HashFile(const char *path, bool binary, uint64_t *hash) {
+  auto file = fopen(path, binary ? "rb" : "r");
+  if (!file) return false;
+  *hash = FnvTraits<uint64_t>::kOffsetBasis;
+  char chunk[16384];
+  size_t len;
+  while ((len = fread(chunk, 1, sizeof(chunk), file)) > 0)
+    *hash = HashBytes(*hash, chunk, len);
+  auto ok = !ferror(file);
+  fclose(file);
+  return ok;
+}
+
+// True if the files at path_a and path_b both exist and hold the same bytes.
+bool SameFileContents(const char *path_a, const char *path_b, bool binary) {
+  auto mode = binary ? "rb" : "r";
+  auto a = fopen(path_a, mode);
+  if (!a) return false;
+  auto b = fopen(path_b, mode);
+  if (!b) {
+    fclose(a);
+    return false;
+  }
+  char chunk_a[16384], chunk_b[sizeof(chunk_a)];
+  auto same = true;
+  while (same) {
+    auto len = fread(chunk_a, 1, sizeof(chunk_a), a);
+    same = fread(chunk_b, 1, sizeof(chunk_b), b) == len &&
+           !memcmp(chunk_a, chunk_b, len);
+    if (len < sizeof(chunk_a)) break;
+  }
+  same = same && !ferror(a) && !ferror(b);
+  fclose(a);
+  fclose(b);
+  return same;
+}
+
+// A file written by a generator, and the hash of its contents.
+struct GeneratedFile {
+  std::string path;
+  uint64_t hash;
+  bool binary;
+};
+
+// What a group of input files was last compiled from and into.
+struct GenerationRecord {
+  GenerationRecord() : complete(true) {}
+
+  // Adds a file read while compiling, unless it is already listed.
+  void AddInput(const std::string &path) {
+    for (auto it = inputs.begin(); it != inputs.end(); ++it)
+      if (it->first == path) return;
+    std::string contents;
+    if (!LoadFile(path.c_str(), true, &contents)) {
+      complete = false;
+      return;
+    }
+    inputs.push_back(std::make_pair(path, HashContents(contents)));
+  }
+
+  // True if no input or output changed since the record was made.
+  bool UpToDate() const {
+    std::string contents;
+    for (auto it = inputs.begin(); it != inputs.end(); ++it) {
+      if (!LoadFile(it->first.c_str(), true, &contents) ||
+          HashContents(contents) != it->second)
+        return false;
+    }
+    // Outputs such as JSON text may not fit in memory.
+    for (auto it = outputs.begin(); it != outputs.end(); ++it) {
+      uint64_t hash;
+      if (!HashFile(it->path.c_str(), it->binary, &hash) || hash != it->hash)
+        return false;
+    }
+    return true;
+  }
+
+  std::vector<std::pair<std::string, uint64_t>> inputs;
+  std::vector<GeneratedFile> outputs;
+  std::vector<std::pair<std::string, bool>> warnings;  // text, show_exe_name
+  bool complete;  // False if an input could not be read back.
+};
+
+// Records of earlier compilations, by a hash of the working directory, the
+// options and the input files of a group. Stored in a FlexBuffer.
+class GenerationCache {
+ public:
+  // Loads the manifest at path, if there is one from this version of flatc.
+  // A manifest that is not one flatc wrote is ignored as a whole.
+  void Load(const std::string &path) {
+    std::string buf;
+    if (!LoadFile(path.c_str(), true, &buf)) return;
+    auto data = reinterpret_cast<const uint8_t *>(buf.data());
+    flexbuffers::Verifier verifier(data, buf.size(), 64, buf.size());
+    if (!verifier.VerifyBuffer()) return;
+    auto root = flexbuffers::GetRoot(data, buf.size());
+    if (!root.IsMap()) return;
+    auto version = root.AsMap()["version"];
+    if (!version.IsString() ||
+        version.AsString().str() != FLATBUFFERS_VERSION())
+      return;
+    if (!Read(root.AsMap()["entries"])) records_.clear();
+  }
+
+  bool Save(const std::string &path) const {
+    flexbuffers::Builder fbb;
+    fbb.Map([&]() {
+      fbb.String("version", FLATBUFFERS_VERSION());
+      fbb.Vector("entries", [&]() {
+        for (auto it = records_.begin(); it != records_.end(); ++it) {
+          auto &record = it->second;
+          fbb.Map([&]() {
+            fbb.UInt("key", it->first);
+            fbb.Vector("inputs", [&]() {
+              for (auto in = record.inputs.begin(); in != record.inputs.end();
+                   ++in) {
+                fbb.String(in->first);
+                fbb.UInt(in->second);
+              }
+            });
+            fbb.Vector("outputs", [&]() {
+              for (auto out = record.outputs.begin();
+                   out != record.outputs.end(); ++out) {
+                fbb.String(out->path);
+                fbb.UInt(out->hash);
+                fbb.Bool(out->binary);
+              }
+            });
+            fbb.Vector("warnings", [&]() {
+              for (auto w = record.warnings.begin();
+                   w != record.warnings.end(); ++w) {
+                fbb.String(w->first);
+                fbb.Bool(w->second);
+              }
+            });
+          });
+        }
+      });
+    });
+    fbb.Finish();
+    // Replace the manifest in one step, so that flatc runs sharing it never
+    // read a partial one.
+    auto tmp = path + ".tmp";
+    auto &buf = fbb.GetBuffer();
+    if (!SaveFile(tmp.c_str(), reinterpret_cast<const char *>(buf.data()),
+                  buf.size(), true))
+      return false;
+    if (!rename(tmp.c_str(), path.c_str())) return true;
+    remove(path.c_str());
+    return !rename(tmp.c_str(), path.c_str());
+  }
+
+  const GenerationRecord *Find(uint64_t key) const {
+    auto it = records_.find(key);
+    return it == records_.end() ? nullptr : &it->second;
+  }
+
+  void Store(uint64_t key, const GenerationRecord &record) {
+    records_[key] = record;
+  }
+
+ private:
+  // Reads the entries of a verified manifest, checking their types.
+  bool Read(flexbuffers::Reference entries_ref) {
+    if (!entries_ref.IsVector()) return false;
+    auto entries = entries_ref.AsVector();
+    for (size_t i = 0; i < entries.size(); i++) {
+      if (!entries[i].IsMap()) return false;
+      auto entry = entries[i].AsMap();
+      auto key = entry["key"];
+      auto inputs = entry["inputs"];
+      auto outputs = entry["outputs"];
+      auto warnings = entry["warnings"];
+      if (!key.IsUInt() || !inputs.IsVector() || !outputs.IsVector() ||
+          !warnings.IsVector())
+        return false;
+      GenerationRecord &record = records_[key.AsUInt64()];
+      auto in = inputs.AsVector();
+      if (in.size() % 2) return false;
+      for (size_t j = 0; j < in.size(); j += 2) {
+        if (!in[j].IsString() || !in[j + 1].IsUInt()) return false;
+        record.inputs.push_back(
+            std::make_pair(in[j].AsString().str(), in[j + 1].AsUInt64()));
+      }
+      auto out = outputs.AsVector();
+      if (out.size() % 3) return false;
+      for (size_t j = 0; j < out.size(); j += 3) {
+        if (!out[j].IsString() || !out[j + 1].IsUInt() || !out[j + 2].IsBool())
+          return false;
+        GeneratedFile file = { out[j].AsString().str(), out[j + 1].AsUInt64(),
+                               out[j + 2].AsBool() };
+        record.outputs.push_back(file);
+      }
+      auto warn = warnings.AsVector();
+      if (warn.size() % 2) return false;
+      for (size_t j = 0; j < warn.size(); j += 2) {
+        if (!warn[j].IsString() || !warn[j + 1].IsBool()) return false;
+        record.warnings.push_back(
+            std::make_pair(warn[j].AsString().str(), warn[j + 1].AsBool()));
+      }
+    }
+    return true;
+  }
+
+  std::map<uint64_t, GenerationRecord> records_;
+};
+
+SaveFileFunction g_previous_save_file = nullptr;
+SaveTempFileFunction g_previous_save_temp_file = nullptr;
+std::mutex g_save_file_hook_mutex;
+int g_save_file_hook_users = 0;  // Guarded by g_save_file_hook_mutex.
+// What the group being compiled on this thread asked of SaveGeneratedFile.
+thread_local bool g_skip_unchanged = false;
+thread_local GenerationRecord *g_generation_record = nullptr;
+
+// Leaves files whose contents would not change alone, so that their
+// modification times don't trigger rebuilds, and records the generated
+// files for the cache. Other threads' files pass through.
+bool SaveGeneratedFile(const char *name, const char *buf, size_t len,
+                       bool binary) {
+  if (!g_skip_unchanged && !g_generation_record)
+    return g_previous_save_file(name, buf, len, binary);
+  std::string existing;
+  if (!g_skip_unchanged || !LoadFile(name, binary, &existing) ||
+      existing.size() != len || memcmp(existing.data(), buf, len)) {
+    if (!g_previous_save_file(name, buf, len, binary)) return false;
+  }
+  if (g_generation_record) {
+    GeneratedFile file = { name, HashContents(std::string(buf, len)), binary };
+    g_generation_record->outputs.push_back(file);
+  }
+  return true;
+}
+
+// The same for outputs streamed to a temporary file, without reading them
+// into memory.
+bool SaveGeneratedTempFile(const char *tmp_name, const char *name,
+                           bool binary) {
+  if (!g_skip_unchanged && !g_generation_record)
+    return g_previous_save_temp_file(tmp_name, name, binary);
+  uint64_t hash = 0;
+  if (g_generation_record && !HashFile(tmp_name, binary, &hash)) {
+    remove(tmp_name);
+    return false;
+  }
+  if (g_skip_unchanged && SameFileContents(tmp_name, name, binary)) {
+    remove(tmp_name);
+  } else if (!g_previous_save_temp_file(tmp_name, name, binary)) {
+    return false;
+  }
+  if (g_generation_record) {
+    GeneratedFile file = { name, hash, binary };
+    g_generation_record->outputs.push_back(file);
+  }
+  return true;
+}
+
+// Installs SaveGeneratedFile and SaveGeneratedTempFile for as long as any
+// instance is in scope, so that compilers can use them on several threads at
+// once.
+class SaveFileHook {
+ public:
+  SaveFileHook() {
+    std::lock_guard<std::mutex> lock(g_save_file_hook_mutex);
+    if (!g_save_file_hook_users++) {
+      g_previous_save_file = SetSaveFileFunction(SaveGeneratedFile);
+      g_previous_save_temp_file =
+          SetSaveTempFileFunction(SaveGeneratedTempFile);
+    }
+  }
+  ~SaveFileHook() {
+    std::lock_guard<std::mutex> lock(g_save_file_hook_mutex);
+    if (!--g_save_file_hook_users) {
+      SetSaveFileFunction(g_previous_save_file);
+      SetSaveTempFileFunction(g_previous_save_temp_file);
+    }
+  }
+};
+
+#ifndef _WIN32
+
+// Server requests and responses are a 32-bit length followed by that many
+// bytes. A request holds the client's working directory and arguments, each
+// zero terminated. A response holds the exit status, then the output.
+const size_t kMaxServerMessage = 1 << 30;
+
+bool SocketAddress(const std::string &path, sockaddr_un *addr) {
+  memset(addr, 0, sizeof(*addr));
+  addr->sun_family = AF_UNIX;
+  if (path.empty() || path.size() >= sizeof(addr->sun_path)) return false;
+  memcpy(addr->sun_path, path.c_str(), path.size());
+  return true;
+}
+
+int ConnectSocket(const sockaddr_un &addr) {
+  auto fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) return -1;
+  if (connect(fd, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr))) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+bool WriteAll(int fd, const char *data, size_t size) {
+  while (size) {
+    auto n = write(fd, data, size);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) return false;
+    data += n;
+    size -= static_cast<size_t>(n);
+  }
+  return true;
+}
+
+bool ReadAll(int fd, char *data, size_t size) {
+  while (size) {
+    auto n = read(fd, data, size);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) return false;
+    data += n;
+    size -= static_cast<size_t>(n);
+  }
+  return true;
+}
+
+bool WriteMessage(int fd, const std::string &message) {
+  auto size = static_cast<uint32_t>(message.size());
+  return WriteAll(fd, reinterpret_cast<const char *>(&size), sizeof(size)) &&
+         WriteAll(fd, message.data(), message.size());
+}
+
+bool ReadMessage(int fd, std::string *message) {
+  uint32_t size;
+  if (!ReadAll(fd, reinterpret_cast<char *>(&size), sizeof(size)) ||
+      size > kMaxServerMessage)
+    return false;
+  message->resize(size);
+  return !size || ReadAll(fd, &(*message)[0], size);
+}
+
+// Runs the request of one client with stdout going to the response.
+std::string ServeRequest(FlatCompiler &server, const std::string &request) {
+  std::vector<std::string> args;
+  for (size_t pos = 0; pos < request.size();) {
+    auto end = request.find('\0', pos);
+    if (end == std::string::npos) end = request.size();
+    args.push_back(request.substr(pos, end - pos));
+    pos = end + 1;
+  }
+  int32_t status = 1;
+  std::string output;
+  auto capture = tmpfile();
+  if (!args.empty() && capture && !chdir(args[0].c_str())) {
+    std::vector<const char *> argv;
+    for (auto it = args.begin() + 1; it != args.end(); ++it)
+      argv.push_back(it->c_str());
+    argv.push_back(nullptr);
+    fflush(stdout);
+    auto saved_stdout = dup(STDOUT_FILENO);
+    dup2(fileno(capture), STDOUT_FILENO);
+    status = server.Compile(static_cast<int>(args.size() - 1), &argv[0]);
+    fflush(stdout);
+    dup2(saved_stdout, STDOUT_FILENO);
+    close(saved_stdout);
+    auto size = ftell(capture);
+    if (size > 0) {
+      output.resize(static_cast<size_t>(size));
+      rewind(capture);
+      if (fread(&output[0], 1, output.size(), capture) != output.size())
+        output.clear();
+    }
+  } else {
+    output = "flatc: error: unable to run request\n";
+  }
+  if (capture) fclose(capture);
+  return std::string(reinterpret_cast<const char *>(&status), sizeof(status)) +
+         output;
+}
+
+#endif  // !_WIN32
+
+// Reads the names in the include statements a schema starts with into names,
+// up to the first statement of another kind. Returns false if unsure of what
+// the parser would make of them.
+bool ScanIncludes(const std::string &contents,
+                  std::vector<std::string> *names) {
+  auto p = contents.c_str();
+  if (!strncmp(p, "\xEF\xBB\xBF", 3)) p += 3;
+  // Skips white space and comments.
+  auto skip = [&p]() -> bool {
+    for (;;) {
+      while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') p++;
+      if (p[0] == '/' && p[1] == '/') {
+        while (*p && *p != '\n') p++;
+      } else if (p[0] == '/' && p[1] == '*') {
+        auto end = strstr(p + 2, "*/");
+        if (!end) return false;
+        p = end + 2;
+      } else {
+        return true;
+      }
+    }
+  };
+  for (;;) {
+    if (!skip()) return false;
+    if (strncmp(p, "include", 7) || is_alnum(p[7]) || p[7] == '_') return true;
+    p += 7;
+    if (!skip() || *p++ != '"') return false;
+    auto end = p;
+    while (*end && *end != '"' && *end != '\\' && *end != '\n') end++;
+    if (*end != '"') return false;
+    names->push_back(std::string(p, end));
+    p = end + 1;
+    if (!skip() || *p++ != ';') return false;
+  }
+}
+
+// The options that change what parsing a schema makes of its includes, and
+// the working directory include paths are relative to.
+std::string ParseOptionsKey(const Parser &parser) {
+  auto &opts = parser.opts;
+  std::string key = flatbuffers::AbsolutePath(".") + '\0' + opts.root_type;
+  const bool flags[] = { opts.generate_all,
+                         opts.allow_non_utf8,
+                         opts.strict_json,
+                         opts.skip_unexpected_fields_in_json,
+                         opts.protobuf_ascii_alike,
+                         opts.union_value_namespacing,
+                         opts.size_prefixed,
+                         opts.force_defaults,
+                         parser.SupportsAdvancedUnionFeatures(),
+                         parser.SupportsAdvancedArrayFeatures() };
+  key += '\0';
+  for (size_t i = 0; i < sizeof(flags) / sizeof(flags[0]); i++)
+    key += flags[i] ? '1' : '0';
+  return key + '\0';
+}
+
+}  // namespace
+
+bool FlatCompiler::ParseFile(flatbuffers::Parser &parser,
+                             const std::string &filename,
+                             const std::string &contents,
+                             std::vector<const char *> &include_directories,
+                             Report *report) const {
   auto local_include_directory = flatbuffers::StripFileName(filename);
   include_directories.push_back(local_include_directory.c_str());
   include_directories.push_back(nullptr);
-  if (!parser.Parse(contents.c_str(), &include_directories[0],
-                    filename.c_str())) {
-    Error(parser.error_, false, false);
-  }
-  if (!parser.error_.empty()) { Warn(parser.error_, false); }
+  auto ok = parser.Parse(contents.c_str(), &include_directories[0],
+                         filename.c_str());
   include_directories.pop_back();
   include_directories.pop_back();
+  if (!ok) return report->Error(parser.error_, false, false);
+  if (!parser.error_.empty()) { report->Warn(parser.error_, false); }
+  return true;
 }
 
-void FlatCompiler::LoadBinarySchema(flatbuffers::Parser &parser,
+bool FlatCompiler::LoadBinarySchema(flatbuffers::Parser &parser,
                                     const std::string &filename,
-                                    const std::string &contents) {
+                                    const std::string &contents,
+                                    Report *report) const {
   if (!parser.Deserialize(reinterpret_cast<const uint8_t *>(contents.c_str()),
                           contents.size())) {
-    Error("failed to load binary schema: " + filename, false, false);
+    return report->Error("failed to load binary schema: " + filename, false,
+                         false);
+  }
+  return true;
+}
+
+bool FlatCompiler::ConvertNdjson(flatbuffers::Parser &parser,
+                                 const std::string &filename,
+                                 const std::string &contents,
+                                 const std::string &output_path, unsigned jobs,
+                                 Report *report) const {
+  // The worker threads each load their own copy of the schema.
+  parser.Serialize();
+  std::vector<uint8_t> schema(
+      parser.builder_.GetBufferPointer(),
+      parser.builder_.GetBufferPointer() + parser.builder_.GetSize());
+  parser.builder_.Clear();
+  flatbuffers::EnsureDirExists(output_path);
+  auto binary_name = flatbuffers::BinaryFileName(
+      parser, output_path,
+      flatbuffers::StripPath(flatbuffers::StripExtension(filename)));
+  auto file = fopen(binary_name.c_str(), "wb");
+  if (!file) {
+    return report->Error("unable to write file: " + binary_name, false);
+  }
+  flatbuffers::FileTextSink sink(file);
+  flatbuffers::NdjsonOptions ndjson_opts;
+  ndjson_opts.num_threads = jobs;
+  std::string err;
+  auto ok = flatbuffers::ParseNdjson(schema.data(), schema.size(), parser.opts,
+                                     contents.c_str(), contents.size(), &sink,
+                                     &err, ndjson_opts);
+  if (fclose(file) != 0 && ok) {
+    ok = false;
+    err = "unable to write file: " + binary_name;
+  }
+  if (!ok) {
+    remove(binary_name.c_str());
+    return report->Error(filename + ": " + err, false);
+  }
+  return true;
+}
+
+thread_local FlatCompiler::Report *FlatCompiler::current_report_ = nullptr;
+
+bool FlatCompiler::RecordGeneratorMessage(const std::string &text,
+                                          bool error) {
+  if (!current_report_) return false;
+  if (error)
+    current_report_->Error(text, false);
+  else
+    current_report_->Warn(text);
+  return true;
+}
+
+bool FlatCompiler::Replay(const Report &report) const {
+  for (auto it = report.messages.begin(); it != report.messages.end(); ++it) {
+    switch (it->kind) {
+      case Report::Message::kWarning: Warn(it->text, it->show_exe_name); break;
+      case Report::Message::kError:
+        Error(it->text, it->usage, it->show_exe_name);
+        break;
+      case Report::Message::kOutput: printf("%s\n", it->text.c_str()); break;
+    }
+  }
+  return !report.HasError();
+}
+
+bool FlatCompiler::ParseOnCachedIncludes(
+    std::unique_ptr<Parser> *parser, const std::string &filename,
+    const std::string &contents, std::vector<const char *> &include_directories,
+    CachedIncludes *includes, Report *report) {
+  auto parse_alone = [&]() {
+    includes->key.clear();
+    return ParseFile(**parser, filename, contents, include_directories, report);
+  };
+  std::vector<std::string> names;
+  if (!ScanIncludes(contents, &names)) return parse_alone();
+  // The includes are looked for as ParseFile() has the parser look for them,
+  // and keyed on where they are found.
+  auto local_include_directory = flatbuffers::StripFileName(filename);
+  auto include_paths = include_directories;
+  include_paths.push_back(local_include_directory.c_str());
+  include_paths.push_back(nullptr);
+  auto key = ParseOptionsKey(**parser);
+  for (auto dir = include_paths.begin(); *dir; ++dir)
+    key += std::string(*dir) + '\0';
+  std::string includes_only;
+  for (auto it = names.begin(); it != names.end(); ++it) {
+    auto name = flatbuffers::PosixPath(it->c_str());
+    std::string filepath;
+    for (auto dir = include_paths.begin(); *dir && filepath.empty(); ++dir) {
+      filepath = flatbuffers::ConCatPathFileName(*dir, name);
+      if (!FileExists(filepath.c_str())) filepath.clear();
+    }
+    if (filepath.empty()) return parse_alone();
+    // The parser skips the schema including itself.
+    if (filepath == filename) break;
+    key += '\0' + name + '\0' + filepath;
+    includes_only += "include \"" + *it + "\";\n";
+  }
+  if (includes_only.empty()) return parse_alone();
+  includes->key = key;
+  if (!TakeCachedIncludes(includes)) {
+    // Parse just the include statements, which the parser does the same way
+    // before going on with the rest of the schema.
+    includes->parser.reset(new Parser((*parser)->opts));
+    includes->files.clear();
+    auto ok = includes->parser->Parse(includes_only.c_str(), &include_paths[0]);
+    for (auto it = includes->parser->included_files_.begin();
+         ok && it != includes->parser->included_files_.end(); ++it) {
+      std::string include;
+      ok = LoadFile(it->first.c_str(), true, &include);
+      includes->files.push_back(
+          std::make_pair(it->first, HashContents(include)));
+    }
+    // Parsing the schema reports any error.
+    if (!ok) return parse_alone();
+    includes->parser->SetCheckpoint();
+    std::lock_guard<std::mutex> lock(include_cache_mutex_);
+    includes_parsed_++;
+  }
+  // A schema its includes include in turn can't be parsed on top of them.
+  if (includes->parser->included_files_.count(filename)) return parse_alone();
+  // Options other than those the key holds may differ.
+  auto opts = (*parser)->opts;
+  *parser = std::move(includes->parser);
+  (*parser)->opts = opts;
+  (*parser)->builder_.ForceDefaults(opts.force_defaults);
+  if (ParseFile(**parser, filename, contents, include_directories, report))
+    return true;
+  // A parser that failed partway through is not reused.
+  includes->key.clear();
+  return false;
+}
+
+bool FlatCompiler::TakeCachedIncludes(CachedIncludes *includes) {
+  CachedIncludes cached;
+  {
+    std::lock_guard<std::mutex> lock(include_cache_mutex_);
+    auto it = include_cache_.find(includes->key);
+    if (it == include_cache_.end()) return false;
+    cached = std::move(it->second);
+    include_cache_.erase(it);
+  }
+  for (auto it = cached.files.begin(); it != cached.files.end(); ++it) {
+    std::string include;
+    if (!LoadFile(it->first.c_str(), true, &include) ||
+        it->second != HashContents(include))
+      return false;
+  }
+  *includes = std::move(cached);
+  std::lock_guard<std::mutex> lock(include_cache_mutex_);
+  includes_reused_++;
+  return true;
+}
+
+void FlatCompiler::CacheIncludes(CachedIncludes &&includes) {
+  includes.parser->RestoreCheckpoint();
+  std::lock_guard<std::mutex> lock(include_cache_mutex_);
+  includes.last_use = ++include_cache_uses_;
+  auto key = includes.key;
+  include_cache_[key] = std::move(includes);
+  while (include_cache_.size() > kMaxCachedIncludes) {
+    auto oldest = include_cache_.begin();
+    for (auto it = include_cache_.begin(); it != include_cache_.end(); ++it) {
+      if (it->second.last_use < oldest->second.last_use) oldest = it;
+    }
+    include_cache_.erase(oldest);
+  }
+}
+
+void FlatCompiler::ServerWarn(const FlatCompiler *flatc,
+                              const std::string &warn, bool show_exe_name) {
+  (void)flatc;
+  if (show_exe_name) { printf("flatc: "); }
+  printf("warning: %s\n", warn.c_str());
+}
+
+void FlatCompiler::ServerError(const FlatCompiler *flatc,
+                               const std::string &err, bool usage,
+                               bool show_exe_name) {
+  if (show_exe_name) { printf("flatc: "); }
+  printf("error: %s\n", err.c_str());
+  if (usage && flatc) { printf("%s", flatc->GetUsageString("flatc").c_str()); }
+}
+
+#ifndef _WIN32
+
+int FlatCompiler::Serve(const std::string &socket_path) const {
+  sockaddr_un addr;
+  if (!SocketAddress(socket_path, &addr))
+    return Error("invalid socket path: " + socket_path, false);
+  // Take over the socket of a server that is no longer running.
+  auto probe = ConnectSocket(addr);
+  if (probe >= 0) {
+    close(probe);
+    return Error("a server is already running on " + socket_path, false);
+  }
+  unlink(socket_path.c_str());
+  auto listener = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listener < 0 ||
+      bind(listener, reinterpret_cast<const sockaddr *>(&addr),
+           sizeof(addr)) ||
+      listen(listener, SOMAXCONN)) {
+    if (listener >= 0) close(listener);
+    return Error("unable to listen on " + socket_path, false);
+  }
+  // A client going away must not take the server down with it.
+  signal(SIGPIPE, SIG_IGN);
+
+  InitParams params = params_;
+  params.warn_fn = ServerWarn;
+  params.error_fn = ServerError;
+  FlatCompiler server(params);
+  server.serving_ = true;
+  for (;;) {
+    auto conn = accept(listener, nullptr, nullptr);
+    if (conn < 0) {
+      if (errno == EINTR || errno == ECONNABORTED) continue;
+      close(listener);
+      return Error("unable to accept connections on " + socket_path, false);
+    }
+    std::string request;
+    if (ReadMessage(conn, &request))
+      WriteMessage(conn, ServeRequest(server, request));
+    close(conn);
   }
 }
 
+int FlatCompiler::Connect(const std::string &socket_path,
+                          const std::vector<std::string> &args) const {
+  sockaddr_un addr;
+  if (!SocketAddress(socket_path, &addr)) return -1;
+  auto conn = ConnectSocket(addr);
+  if (conn < 0) return -1;
+  signal(SIGPIPE, SIG_IGN);
+  std::string request;
+  std::vector<char> cwd(256);
+  while (!getcwd(cwd.data(), cwd.size())) {
+    if (errno != ERANGE) {
+      close(conn);
+      return Error("unable to get the working directory", false);
+    }
+    cwd.resize(cwd.size() * 2);
+  }
+  request.append(cwd.data(), strlen(cwd.data()) + 1);
+  for (auto it = args.begin(); it != args.end(); ++it)
+    request.append(it->c_str(), it->size() + 1);
+  std::string response;
+  auto ok = WriteMessage(conn, request) && ReadMessage(conn, &response) &&
+            response.size() >= sizeof(int32_t);
+  close(conn);
+  if (!ok) {
+    return Error("lost connection to the server on " + socket_path, false);
+  }
+  int32_t status;
+  memcpy(&status, response.data(), sizeof(status));
+  fwrite(response.data() + sizeof(status), 1,
+         response.size() - sizeof(status), stdout);
+  return status;
+}
+
+#else
+
+int FlatCompiler::Serve(const std::string &socket_path) const {
+  (void)socket_path;
+  return Error("--server is not supported on this platform", false);
+}
+
+int FlatCompiler::Connect(const std::string &socket_path,
+                          const std::vector<std::string> &args) const {
+  (void)socket_path;
+  (void)args;
+  return -1;
+}
+
+#endif  // !_WIN32
+
 void FlatCompiler::Warn(const std::string &warn, bool show_exe_name) const {
   params_.warn_fn(this, warn, show_exe_name);
 }
 
-void FlatCompiler::Error(const std::string &err, bool usage,
-                         bool show_exe_name) const {
+int FlatCompiler::Error(const std::string &err, bool usage,
+                        bool show_exe_name) const {
   params_.error_fn(this, err, usage, show_exe_name);
+  return 1;
 }
 
 std::string FlatCompiler::GetUsageString(const char *program_name) const {
@@ -141,6 +965,7 @@ std::string FlatCompiler::GetUsageString(const char *program_name) const {
     "    SUFFIX                 from protobufs.\n"
     "  --oneof-union          Translate .proto oneofs to flatbuffer unions.\n"
     "  --grpc                 Generate GRPC interfaces for the specified languages.\n"
+    "  --grpc-callback-api    Also generate the GRPC C++ callback API (reactors).\n"
     "  --schema               Serialize schemas instead of JSON (use with -b).\n"
     "  --bfbs-comments        Add doc comments to the binary schema files.\n"
     "  --bfbs-builtins        Add builtin attributes to the binary schema files.\n"
@@ -168,6 +993,26 @@ std::string FlatCompiler::GetUsageString(const char *program_name) const {
     "                         force vectors to empty rather than null.\n"
     "  --flexbuffers          Used with \"binary\" and \"json\" options, it generates\n"
     "                         data using schema-less FlexBuffers.\n"
+    "  --ndjson               JSON files hold one object per line (newline-delimited\n"
+    "                         JSON). Used with -b, writes them to a single file as\n"
+    "                         consecutive size-prefixed buffers, in input order.\n"
+    "  --jobs N               Number of threads used to compile schemas (default:\n"
+    "                         1), and by --ndjson (default: one per hardware\n"
+    "                         thread).\n"
+    "  --skip-unchanged       Don't rewrite generated files whose contents would\n"
+    "                         not change.\n"
+    "  --cache-manifest FILE  Skip schemas whose inputs, options and outputs did\n"
+    "                         not change since the run that recorded them in FILE.\n"
+    "                         Implies --skip-unchanged.\n"
+    "  --server SOCKET        Compile the requests of --connect clients, listening\n"
+    "                         on the Unix domain socket SOCKET. Parsed include\n"
+    "                         files are kept in memory for schemas that include\n"
+    "                         the same files.\n"
+    "  --connect SOCKET       Have the server on SOCKET compile the remaining\n"
+    "                         arguments, or compile them here if none is running.\n"
+    "                         Both --server and --connect must come first.\n"
+    "  --server-stats         With --connect, print how often the server parsed\n"
+    "                         and reused include files.\n"
     "FILEs may be schemas (must end in .fbs), binary schemas (must end in .bfbs),\n"
     "or JSON files (conforming to preceding schema). FILEs after the -- must be\n"
     "binary flatbuffer format files.\n"
@@ -184,6 +1029,33 @@ int FlatCompiler::Compile(int argc, const char **argv) {
     return 0;
   }
 
+  if (argc && !serving_) {
+    std::string arg = argv[0];
+    if (arg == "--server") {
+      if (argc != 2)
+        return Error("--server takes a socket path, and no other arguments",
+                     true);
+      return Serve(argv[1]);
+    }
+    if (arg == "--connect") {
+      if (argc < 2) return Error("missing socket path following: " + arg, true);
+      auto status =
+          Connect(argv[1], std::vector<std::string>(argv + 2, argv + argc));
+      if (status >= 0) return status;
+      // No server is running, so compile the arguments here.
+      argc -= 2;
+      argv += 2;
+    }
+  }
+  if (argc == 1 && serving_ && !strcmp(argv[0], "--server-stats")) {
+    std::lock_guard<std::mutex> lock(include_cache_mutex_);
+    printf("includes parsed: %llu, reused: %llu, cached: %llu\n",
+           static_cast<unsigned long long>(includes_parsed_),
+           static_cast<unsigned long long>(includes_reused_),
+           static_cast<unsigned long long>(include_cache_.size()));
+    return 0;
+  }
+
   flatbuffers::IDLOptions opts;
   std::string output_path;
 
@@ -192,6 +1064,8 @@ int FlatCompiler::Compile(int argc, const char **argv) {
   bool raw_binary = false;
   bool schema_binary = false;
   bool grpc_enabled = false;
+  bool ndjson = false;
+  unsigned jobs = 0;
   std::vector<std::string> filenames;
   std::list<std::string> include_directories_storage;
   std::vector<const char *> include_directories;
@@ -199,33 +1073,41 @@ int FlatCompiler::Compile(int argc, const char **argv) {
   std::vector<bool> generator_enabled(params_.num_generators, false);
   size_t binary_files_from = std::numeric_limits<size_t>::max();
   std::string conform_to_schema;
+  std::string cache_manifest;
+  bool skip_unchanged = false;
+  std::vector<bool> is_input(static_cast<size_t>(argc), false);
 
   for (int argi = 0; argi < argc; argi++) {
     std::string arg = argv[argi];
     if (arg[0] == '-') {
       if (filenames.size() && arg[1] != '-')
-        Error("invalid option location: " + arg, true);
+        return Error("invalid option location: " + arg, true);
       if (arg == "-o") {
-        if (++argi >= argc) Error("missing path following: " + arg, true);
+        if (++argi >= argc)
+          return Error("missing path following: " + arg, true);
         output_path = flatbuffers::ConCatPathFileName(
             flatbuffers::PosixPath(argv[argi]), "");
       } else if (arg == "-I") {
-        if (++argi >= argc) Error("missing path following: " + arg, true);
+        if (++argi >= argc)
+          return Error("missing path following: " + arg, true);
         include_directories_storage.push_back(
             flatbuffers::PosixPath(argv[argi]));
         include_directories.push_back(
             include_directories_storage.back().c_str());
       } else if (arg == "--conform") {
-        if (++argi >= argc) Error("missing path following: " + arg, true);
+        if (++argi >= argc)
+          return Error("missing path following: " + arg, true);
         conform_to_schema = flatbuffers::PosixPath(argv[argi]);
       } else if (arg == "--conform-includes") {
-        if (++argi >= argc) Error("missing path following: " + arg, true);
+        if (++argi >= argc)
+          return Error("missing path following: " + arg, true);
         include_directories_storage.push_back(
             flatbuffers::PosixPath(argv[argi]));
         conform_include_directories.push_back(
             include_directories_storage.back().c_str());
       } else if (arg == "--include-prefix") {
-        if (++argi >= argc) Error("missing path following: " + arg, true);
+        if (++argi >= argc)
+          return Error("missing path following: " + arg, true);
         opts.include_prefix = flatbuffers::ConCatPathFileName(
             flatbuffers::PosixPath(argv[argi]), "");
       } else if (arg == "--keep-prefix") {
@@ -245,10 +1127,11 @@ int FlatCompiler::Compile(int argc, const char **argv) {
         opts.use_goog_js_export_format = false;
         opts.use_ES6_js_export_format = true;
       } else if (arg == "--go-namespace") {
-        if (++argi >= argc) Error("missing golang namespace" + arg, true);
+        if (++argi >= argc)
+          return Error("missing golang namespace" + arg, true);
         opts.go_namespace = argv[argi];
       } else if (arg == "--go-import") {
-        if (++argi >= argc) Error("missing golang import" + arg, true);
+        if (++argi >= argc) return Error("missing golang import" + arg, true);
         opts.go_import = argv[argi];
       } else if (arg == "--defaults-json") {
         opts.output_default_scalars_in_json = true;
@@ -270,13 +1153,16 @@ int FlatCompiler::Compile(int argc, const char **argv) {
       } else if (arg == "--gen-compare") {
         opts.gen_compare = true;
       } else if (arg == "--cpp-include") {
-        if (++argi >= argc) Error("missing include following: " + arg, true);
+        if (++argi >= argc)
+          return Error("missing include following: " + arg, true);
         opts.cpp_includes.push_back(argv[argi]);
       } else if (arg == "--cpp-ptr-type") {
-        if (++argi >= argc) Error("missing type following: " + arg, true);
+        if (++argi >= argc)
+          return Error("missing type following: " + arg, true);
         opts.cpp_object_api_pointer_type = argv[argi];
       } else if (arg == "--cpp-str-type") {
-        if (++argi >= argc) Error("missing type following: " + arg, true);
+        if (++argi >= argc)
+          return Error("missing type following: " + arg, true);
         opts.cpp_object_api_string_type = argv[argi];
       } else if (arg == "--cpp-str-flex-ctor") {
         opts.cpp_object_api_string_flexible_constructor = true;
@@ -287,10 +1173,12 @@ int FlatCompiler::Compile(int argc, const char **argv) {
       } else if (arg == "--gen-generated") {
         opts.gen_generated = true;
       } else if (arg == "--object-prefix") {
-        if (++argi >= argc) Error("missing prefix following: " + arg, true);
+        if (++argi >= argc)
+          return Error("missing prefix following: " + arg, true);
         opts.object_prefix = argv[argi];
       } else if (arg == "--object-suffix") {
-        if (++argi >= argc) Error("missing suffix following: " + arg, true);
+        if (++argi >= argc)
+          return Error("missing suffix following: " + arg, true);
         opts.object_suffix = argv[argi];
       } else if (arg == "--gen-all") {
         opts.generate_all = true;
@@ -311,7 +1199,8 @@ int FlatCompiler::Compile(int argc, const char **argv) {
       } else if (arg == "--proto") {
         opts.proto_mode = true;
       } else if (arg == "--proto-namespace-suffix") {
-        if (++argi >= argc) Error("missing namespace suffix" + arg, true);
+        if (++argi >= argc)
+          return Error("missing namespace suffix" + arg, true);
         opts.proto_namespace_suffix = argv[argi];
       } else if (arg == "--oneof-union") {
         opts.proto_oneof_union = true;
@@ -324,6 +1213,8 @@ int FlatCompiler::Compile(int argc, const char **argv) {
         exit(0);
       } else if (arg == "--grpc") {
         grpc_enabled = true;
+      } else if (arg == "--grpc-callback-api") {
+        opts.grpc_callback_api = true;
       } else if (arg == "--bfbs-comments") {
         opts.binary_schema_comments = true;
       } else if (arg == "--bfbs-builtins") {
@@ -341,13 +1232,16 @@ int FlatCompiler::Compile(int argc, const char **argv) {
       } else if (arg == "--reflect-names") {
         opts.mini_reflect = IDLOptions::kTypesAndNames;
       } else if (arg == "--root-type") {
-        if (++argi >= argc) Error("missing type following: " + arg, true);
+        if (++argi >= argc)
+          return Error("missing type following: " + arg, true);
         opts.root_type = argv[argi];
       } else if (arg == "--filename-suffix") {
-        if (++argi >= argc) Error("missing filename suffix: " + arg, true);
+        if (++argi >= argc)
+          return Error("missing filename suffix: " + arg, true);
         opts.filename_suffix = argv[argi];
       } else if (arg == "--filename-ext") {
-        if (++argi >= argc) Error("missing filename extension: " + arg, true);
+        if (++argi >= argc)
+          return Error("missing filename extension: " + arg, true);
         opts.filename_extension = argv[argi];
       } else if (arg == "--force-defaults") {
         opts.force_defaults = true;
@@ -362,10 +1256,28 @@ int FlatCompiler::Compile(int argc, const char **argv) {
         opts.cs_gen_json_serializer = true;
       } else if (arg == "--flexbuffers") {
         opts.use_flexbuffers = true;
+      } else if (arg == "--ndjson") {
+        ndjson = true;
+      } else if (arg == "--jobs") {
+        if (++argi >= argc)
+          return Error("missing number following: " + arg, true);
+        if (!flatbuffers::StringToNumber(argv[argi], &jobs))
+          return Error("invalid number of jobs: " + std::string(argv[argi]),
+                       true);
       } else if (arg == "--cpp-std") {
         if (++argi >= argc)
-          Error("missing C++ standard specification" + arg, true);
+          return Error("missing C++ standard specification" + arg, true);
         opts.cpp_std = argv[argi];
+      } else if (arg == "--skip-unchanged") {
+        skip_unchanged = true;
+      } else if (arg == "--cache-manifest") {
+        if (++argi >= argc)
+          return Error("missing path following: " + arg, true);
+        cache_manifest = flatbuffers::PosixPath(argv[argi]);
+      } else if (arg == "--server" || arg == "--connect") {
+        return Error(arg + " must be the first argument", true);
+      } else if (arg == "--server-stats") {
+        return Error(arg + " must be sent to a server with --connect", true);
       } else {
         for (size_t i = 0; i < params_.num_generators; ++i) {
           if (arg == params_.generators[i].generator_opt_long ||
@@ -377,49 +1289,74 @@ int FlatCompiler::Compile(int argc, const char **argv) {
             goto found;
           }
         }
-        Error("unknown commandline argument: " + arg, true);
+        return Error("unknown commandline argument: " + arg, true);
       found:;
       }
     } else {
       filenames.push_back(flatbuffers::PosixPath(argv[argi]));
+      is_input[static_cast<size_t>(argi)] = true;
+    }
+  }
+
+  // Earlier results are reused only in the same directory, with the same
+  // options.
+  std::string options_key;
+  if (!cache_manifest.empty()) {
+    options_key = flatbuffers::AbsolutePath(".") + '\0';
+    for (int argi = 0; argi < argc; argi++) {
+      if (!is_input[static_cast<size_t>(argi)])
+        options_key += std::string(argv[argi]) + '\0';
     }
   }
 
-  if (!filenames.size()) Error("missing input files", false, true);
+  if (!filenames.size()) return Error("missing input files", false, true);
 
   if (opts.proto_mode) {
     if (any_generator)
-      Error("cannot generate code directly from .proto files", true);
+      return Error("cannot generate code directly from .proto files", true);
   } else if (!any_generator && conform_to_schema.empty()) {
-    Error("no options: specify at least one generator.", true);
+    return Error("no options: specify at least one generator.", true);
+  }
+
+  if (ndjson && (opts.use_flexbuffers ||
+                 !(opts.lang_to_generate & IDLOptions::kBinary))) {
+    return Error("--ndjson requires --binary and no --flexbuffers", true);
   }
 
   flatbuffers::Parser conform_parser;
   if (!conform_to_schema.empty()) {
     std::string contents;
     if (!flatbuffers::LoadFile(conform_to_schema.c_str(), true, &contents))
-      Error("unable to load schema: " + conform_to_schema);
+      return Error("unable to load schema: " + conform_to_schema);
 
+    Report report;
     if (flatbuffers::GetExtension(conform_to_schema) ==
         reflection::SchemaExtension()) {
-      LoadBinarySchema(conform_parser, conform_to_schema, contents);
+      LoadBinarySchema(conform_parser, conform_to_schema, contents, &report);
     } else {
       ParseFile(conform_parser, conform_to_schema, contents,
-                conform_include_directories);
+                conform_include_directories, &report);
     }
+    if (!Replay(report)) return 1;
   }
 
-  std::unique_ptr<flatbuffers::Parser> parser(new flatbuffers::Parser(opts));
-
-  for (auto file_it = filenames.begin(); file_it != filenames.end();
-       ++file_it) {
-    auto &filename = *file_it;
+  // Compiles one input file with the parser of its group, stopping at the
+  // first error.
+  auto compile_file = [&](size_t file_index,
+                          std::unique_ptr<flatbuffers::Parser> &parser,
+                          std::vector<const char *> &include_dirs,
+                          CachedIncludes *includes,
+                          Report *report) -> bool {
+    auto &filename = filenames[file_index];
     std::string contents;
     if (!flatbuffers::LoadFile(filename.c_str(), true, &contents))
-      Error("unable to load file: " + filename);
+      return report->Error("unable to load file: " + filename);
+    if (g_generation_record) {
+      g_generation_record->inputs.push_back(
+          std::make_pair(filename, HashContents(contents)));
+    }
 
-    bool is_binary =
-        static_cast<size_t>(file_it - filenames.begin()) >= binary_files_from;
+    bool is_binary = file_index >= binary_files_from;
     auto ext = flatbuffers::GetExtension(filename);
     auto is_schema = ext == "fbs" || ext == "proto";
     auto is_binary_schema = ext == reflection::SchemaExtension();
@@ -435,24 +1372,31 @@ int FlatCompiler::Compile(int argc, const char **argv) {
         // We'd expect that typically any binary used as a file would have
         // such an identifier, so by default we require them to match.
         if (!parser->file_identifier_.length()) {
-          Error("current schema has no file_identifier: cannot test if \"" +
-                filename +
-                "\" matches the schema, use --raw-binary to read this file"
-                " anyway.");
+          return report->Error(
+              "current schema has no file_identifier: cannot test if \"" +
+              filename +
+              "\" matches the schema, use --raw-binary to read this file"
+              " anyway.");
         } else if (!flatbuffers::BufferHasIdentifier(
                        contents.c_str(), parser->file_identifier_.c_str(),
                        opts.size_prefixed)) {
-          Error("binary \"" + filename +
-                "\" does not have expected file_identifier \"" +
-                parser->file_identifier_ +
-                "\", use --raw-binary to read this file anyway.");
+          return report->Error(
+              "binary \"" + filename +
+              "\" does not have expected file_identifier \"" +
+              parser->file_identifier_ +
+              "\", use --raw-binary to read this file anyway.");
         }
       }
     } else {
       // Check if file contains 0 bytes.
       if (!opts.use_flexbuffers && !is_binary_schema &&
           contents.length() != strlen(contents.c_str())) {
-        Error("input file appears to be binary: " + filename, true);
+        return report->Error("input file appears to be binary: " + filename,
+                             true);
+      }
+      if (ndjson && !is_schema && !is_binary_schema) {
+        return ConvertNdjson(*parser.get(), filename, contents, output_path,
+                             jobs, report);
       }
       if (is_schema) {
         // If we're processing multiple schemas, make sure to start each
@@ -460,31 +1404,50 @@ int FlatCompiler::Compile(int argc, const char **argv) {
         // so explicitly using an include.
         parser.reset(new flatbuffers::Parser(opts));
       }
-      if (is_binary_schema) {
-        LoadBinarySchema(*parser.get(), filename, contents);
+      if (is_binary_schema &&
+          !LoadBinarySchema(*parser.get(), filename, contents, report)) {
+        return false;
       }
       if (opts.use_flexbuffers) {
         if (opts.lang_to_generate == IDLOptions::kJson) {
-          parser->flex_root_ = flexbuffers::GetRoot(
-              reinterpret_cast<const uint8_t *>(contents.c_str()),
-              contents.size());
+          auto flex = reinterpret_cast<const uint8_t *>(contents.c_str());
+          // Printing reads the buffer without any checks. Every value that
+          // isn't shared takes at least a byte, which bounds their number.
+          flexbuffers::Verifier verifier(flex, contents.size(), 64,
+                                         contents.size());
+          if (!verifier.VerifyBuffer()) {
+            return report->Error("flexbuffer verification failed: " +
+                                 filename);
+          }
+          parser->flex_root_ = flexbuffers::GetRoot(flex, contents.size());
         } else {
           parser->flex_builder_.Clear();
-          ParseFile(*parser.get(), filename, contents, include_directories);
+          if (!ParseFile(*parser.get(), filename, contents, include_dirs,
+                         report))
+            return false;
         }
       } else {
-        ParseFile(*parser.get(), filename, contents, include_directories);
+        if (ext == "fbs" && includes) {
+          if (!ParseOnCachedIncludes(&parser, filename, contents, include_dirs,
+                                     includes, report))
+            return false;
+        } else if (!ParseFile(*parser.get(), filename, contents, include_dirs,
+                              report)) {
+          return false;
+        }
         if (!is_schema && !parser->builder_.GetSize()) {
           // If a file doesn't end in .fbs, it must be json/binary. Ensure we
           // didn't just parse a schema with a different extension.
-          Error("input file is neither json nor a .fbs (schema) file: " +
-                    filename,
-                true);
+          return report->Error(
+              "input file is neither json nor a .fbs (schema) file: " +
+                  filename,
+              true);
         }
       }
       if ((is_schema || is_binary_schema) && !conform_to_schema.empty()) {
         auto err = parser->ConformTo(conform_parser);
-        if (!err.empty()) Error("schemas don\'t conform: " + err);
+        if (!err.empty())
+          return report->Error("schemas don\'t conform: " + err);
       }
       if (schema_binary || opts.binary_schema_gen_embed) {
         parser->Serialize();
@@ -506,31 +1469,34 @@ int FlatCompiler::Compile(int argc, const char **argv) {
                (is_schema || is_binary_schema)) &&
               !params_.generators[i].generate(*parser.get(), output_path,
                                               filebase)) {
-            Error(std::string("Unable to generate ") +
-                  params_.generators[i].lang_name + " for " + filebase);
+            return report->Error(std::string("Unable to generate ") +
+                                 params_.generators[i].lang_name + " for " +
+                                 filebase);
           }
+          if (report->HasError()) return false;
         } else {
           if (params_.generators[i].make_rule == nullptr) {
-            Error(std::string("Cannot generate make rule for ") +
-                  params_.generators[i].lang_name);
+            return report->Error(std::string("Cannot generate make rule for ") +
+                                 params_.generators[i].lang_name);
           } else {
             std::string make_rule = params_.generators[i].make_rule(
                 *parser.get(), output_path, filename);
             if (!make_rule.empty())
-              printf("%s\n",
-                     flatbuffers::WordWrap(make_rule, 80, " ", " \\").c_str());
+              report->Print(flatbuffers::WordWrap(make_rule, 80, " ", " \\"));
           }
         }
         if (grpc_enabled) {
           if (params_.generators[i].generateGRPC != nullptr) {
             if (!params_.generators[i].generateGRPC(*parser.get(), output_path,
                                                     filebase)) {
-              Error(std::string("Unable to generate GRPC interface for") +
-                    params_.generators[i].lang_name);
+              return report->Error(
+                  std::string("Unable to generate GRPC interface for") +
+                  params_.generators[i].lang_name);
             }
           } else {
-            Warn(std::string("GRPC interface generator not implemented for ") +
-                 params_.generators[i].lang_name);
+            report->Warn(
+                std::string("GRPC interface generator not implemented for ") +
+                params_.generators[i].lang_name);
           }
         }
       }
@@ -538,17 +1504,131 @@ int FlatCompiler::Compile(int argc, const char **argv) {
 
     if (!opts.root_type.empty()) {
       if (!parser->SetRootType(opts.root_type.c_str()))
-        Error("unknown root type: " + opts.root_type);
+        return report->Error("unknown root type: " + opts.root_type);
       else if (parser->root_struct_def_->fixed)
-        Error("root type must be a table");
+        return report->Error("root type must be a table");
     }
 
     if (opts.proto_mode) GenerateFBS(*parser.get(), output_path, filebase);
 
+    if (g_generation_record) {
+      for (auto it = parser->included_files_.begin();
+           it != parser->included_files_.end(); ++it)
+        g_generation_record->AddInput(it->first);
+    }
+
     // We do not want to generate code for the definitions in this file
     // in any files coming up next.
     parser->MarkGenerated();
+    return true;
+  };
+
+  // Each schema starts from a fresh parser, so it and the JSON/binary files
+  // that follow it make up a group that is independent of the other groups.
+  std::vector<size_t> groups;
+  for (size_t i = 0; i < filenames.size(); i++) {
+    auto ext = flatbuffers::GetExtension(filenames[i]);
+    if (!i || (i < binary_files_from && (ext == "fbs" || ext == "proto")))
+      groups.push_back(i);
+  }
+  groups.push_back(filenames.size());
+  std::vector<Report> reports(groups.size() - 1);
+
+  // Groups whose inputs and outputs are unchanged since the last run are
+  // skipped. Make rules and --ndjson bypass SaveFile, and --conform checks
+  // another schema, so those are always compiled.
+  GenerationCache generation_cache;
+  auto use_generation_cache = !cache_manifest.empty() && !print_make_rules &&
+                              !ndjson && conform_to_schema.empty();
+  if (use_generation_cache) generation_cache.Load(cache_manifest);
+  // The cache also keeps unchanged outputs, so their modification times
+  // match what it recorded.
+  skip_unchanged = skip_unchanged || use_generation_cache;
+  std::unique_ptr<SaveFileHook> save_file_hook;
+  if (skip_unchanged) save_file_hook.reset(new SaveFileHook());
+  std::vector<uint64_t> group_keys(reports.size());
+  std::vector<std::unique_ptr<GenerationRecord>> records(reports.size());
+
+  // Records the groups that compiled without errors, even if others failed.
+  auto save_generation_cache = [&]() {
+    if (!use_generation_cache) return;
+    auto updated = false;
+    for (size_t group = 0; group < records.size(); group++) {
+      if (records[group] && records[group]->complete &&
+          !reports[group].HasError()) {
+        generation_cache.Store(group_keys[group], *records[group]);
+        updated = true;
+      }
+    }
+    if (updated && !generation_cache.Save(cache_manifest))
+      Warn("unable to write cache manifest: " + cache_manifest);
+  };
+
+  auto compile_group = [&](size_t group) {
+    auto &report = reports[group];
+    if (use_generation_cache) {
+      std::string key = options_key;
+      for (auto i = groups[group]; i < groups[group + 1]; i++)
+        key += filenames[i] + '\0';
+      group_keys[group] = HashContents(key);
+      auto cached = generation_cache.Find(group_keys[group]);
+      if (cached && cached->UpToDate()) {
+        for (auto it = cached->warnings.begin(); it != cached->warnings.end();
+             ++it)
+          report.Warn(it->first, it->second);
+        return;
+      }
+      records[group].reset(new GenerationRecord());
+    }
+    std::unique_ptr<flatbuffers::Parser> parser(new flatbuffers::Parser(opts));
+    auto include_dirs = include_directories;
+    // A server parses .fbs schemas on top of the parsed includes they share.
+    CachedIncludes includes;
+    auto use_include_cache =
+        serving_ && !opts.use_flexbuffers && !opts.proto_mode;
+    current_report_ = &report;
+    g_generation_record = records[group].get();
+    g_skip_unchanged = skip_unchanged;
+    for (auto i = groups[group]; i < groups[group + 1]; i++) {
+      if (!compile_file(i, parser, include_dirs,
+                        use_include_cache ? &includes : nullptr, &report))
+        break;
+    }
+    // Nothing else uses the includes, so keep them for the next request.
+    if (!includes.key.empty()) {
+      includes.parser = std::move(parser);
+      CacheIncludes(std::move(includes));
+    }
+    current_report_ = nullptr;
+    g_generation_record = nullptr;
+    g_skip_unchanged = false;
+    if (records[group]) {
+      for (auto it = report.messages.begin(); it != report.messages.end();
+           ++it) {
+        if (it->kind == Report::Message::kWarning)
+          records[group]->warnings.push_back(
+              std::make_pair(it->text, it->show_exe_name));
+      }
+    }
+  };
+
+  // The calling thread compiles groups too, and passes the reports on in
+  // order as groups finish, so output and errors do not depend on timing.
+  // Groups may write the same files (e.g. with --gen-all), so they are only
+  // compiled concurrently when asked for.
+  TaskPool pool(reports.size(), jobs ? jobs - 1 : 0, compile_group);
+  for (size_t group = 0; group < reports.size(); group++) {
+    pool.Wait(group);
+    // The error callback usually exits, so let the running groups finish,
+    // and keep what they generated, first.
+    if (reports[group].HasError()) {
+      pool.Stop();
+      save_generation_cache();
+    }
+    if (!Replay(reports[group])) return 1;
+    reports[group].messages.clear();
   }
+  save_generation_cache();
   return 0;
 }
 
@@ -38,9 +38,11 @@ static void Error(const flatbuffers::FlatCompiler *flatc,
 
 namespace flatbuffers {
 void LogCompilerWarn(const std::string &warn) {
+  if (flatbuffers::FlatCompiler::RecordGeneratorMessage(warn, false)) return;
   Warn(static_cast<const flatbuffers::FlatCompiler *>(nullptr), warn, true);
 }
 void LogCompilerError(const std::string &err) {
+  if (flatbuffers::FlatCompiler::RecordGeneratorMessage(err, true)) return;
   Error(static_cast<const flatbuffers::FlatCompiler *>(nullptr), err, false,
         true);
 }
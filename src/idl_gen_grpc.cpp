@@ -321,6 +321,7 @@ bool GenerateCppGRPC(const Parser &parser, const std::string &path,
   grpc_cpp_generator::Parameters generator_parameters;
   // TODO(wvo): make the other parameters in this struct configurable.
   generator_parameters.use_system_headers = true;
+  generator_parameters.generate_callback_api = parser.opts.grpc_callback_api;
 
   FlatBufFile fbfile(parser, file_name, FlatBufFile::kLanguageCpp);
 
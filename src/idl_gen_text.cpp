@@ -28,7 +28,205 @@ struct PrintPointerTag {};
 template<typename T> struct PrintTag { typedef PrintScalarTag type; };
 template<> struct PrintTag<const void *> { typedef PrintPointerTag type; };
 
-struct JsonPrinter {
+// Where JsonPrinter gets the types of what it prints from: the definitions
+// of a Parser here, or a binary schema (SchemaTypes below).
+class ParserTypes {
+ public:
+  typedef flatbuffers::Type Type;
+  typedef StructDef Object;
+  typedef FieldDef Field;
+  typedef EnumDef Enum;
+  typedef std::vector<FieldDef *> FieldList;
+  typedef IDLOptions Options;
+
+  static BaseType GetBaseType(const Type &type) { return type.base_type; }
+  static Type VectorType(const Type &type) { return type.VectorType(); }
+  static uint16_t FixedLength(const Type &type) { return type.fixed_length; }
+  static const Object *StructOf(const Type &type) { return type.struct_def; }
+  static const Enum *EnumOf(const Type &type) { return type.enum_def; }
+
+  static bool IsFixed(const Object &object) { return object.fixed; }
+  static size_t ByteSize(const Object &object) { return object.bytesize; }
+  // In declaration order.
+  static const FieldList &Fields(const Object &object) {
+    return object.fields.vec;
+  }
+
+  static const std::string &Name(const Field &field) { return field.name; }
+  static voffset_t Offset(const Field &field) { return field.value.offset; }
+  static bool Deprecated(const Field &field) { return field.deprecated; }
+  static const Type &FieldType(const Field &field) { return field.value.type; }
+  template<typename T> static T Default(const Field &field) {
+    T val;
+    auto check = StringToNumber(field.value.constant.c_str(), &val);
+    (void)check;
+    FLATBUFFERS_ASSERT(check);
+    return val;
+  }
+  static bool IsFlexBuffer(const Field &field) { return field.flexbuffer; }
+  static const Object *NestedFlatBuffer(const Object &, const Field &field) {
+    return field.nested_flatbuffer;
+  }
+
+  static const char *ValueName(const Enum &enum_def, int64_t val) {
+    auto ev = enum_def.ReverseLookup(val);
+    return ev ? ev->name.c_str() : nullptr;
+  }
+  static bool IsBitFlags(const Enum &enum_def) {
+    return enum_def.attributes.Lookup("bit_flags") != nullptr;
+  }
+  static size_t NumValues(const Enum &enum_def) { return enum_def.size(); }
+  static const std::string &ValueNameAt(const Enum &enum_def, size_t i) {
+    return enum_def.Vals()[i]->name;
+  }
+  static uint64_t ValueAt(const Enum &enum_def, size_t i) {
+    return enum_def.Vals()[i]->GetAsUInt64();
+  }
+  // The type of the member of union enum_def with the given type.
+  static bool UnionMember(const Enum &enum_def, uint8_t union_type,
+                          Type *member) {
+    auto ev = enum_def.ReverseLookup(union_type, true);
+    if (!ev) return false;
+    *member = ev->union_type;
+    return true;
+  }
+};
+
+class SchemaTypes {
+ public:
+  // A reflection::Type with its index resolved, the way Type has its
+  // definitions.
+  struct Type {
+    Type()
+        : base_type(BASE_TYPE_NONE),
+          element(BASE_TYPE_NONE),
+          object(nullptr),
+          enum_def(nullptr),
+          fixed_length(0) {}
+
+    BaseType base_type;
+    BaseType element;
+    const reflection::Object *object;
+    const reflection::Enum *enum_def;
+    uint16_t fixed_length;
+  };
+  typedef reflection::Object Object;
+  typedef reflection::Field Field;
+  typedef reflection::Enum Enum;
+  typedef std::vector<const reflection::Field *> FieldList;
+  typedef SchemaView::TextOptions Options;
+
+  explicit SchemaTypes(const SchemaView &view)
+      : view_(view), schema_(*view.schema()) {}
+
+  static BaseType GetBaseType(const Type &type) { return type.base_type; }
+  static Type VectorType(const Type &type) {
+    auto elem = type;
+    elem.base_type = type.element;
+    elem.element = BASE_TYPE_NONE;
+    return elem;
+  }
+  static uint16_t FixedLength(const Type &type) { return type.fixed_length; }
+  static const Object *StructOf(const Type &type) { return type.object; }
+  static const Enum *EnumOf(const Type &type) { return type.enum_def; }
+
+  static bool IsFixed(const Object &object) { return object.is_struct(); }
+  static size_t ByteSize(const Object &object) {
+    return static_cast<size_t>(object.bytesize());
+  }
+  // In declaration order, which is the order a Parser prints them in. The
+  // schema stores them sorted by name.
+  const FieldList &Fields(const Object &object) {
+    auto &fields = fields_by_id_[&object];
+    if (fields.empty()) {
+      fields.resize(object.fields()->size());
+      for (auto it = object.fields()->begin(); it != object.fields()->end();
+           ++it) {
+        FLATBUFFERS_ASSERT(it->id() < fields.size());
+        fields[it->id()] = *it;
+      }
+    }
+    return fields;
+  }
+
+  static const char *Name(const Field &field) { return field.name()->c_str(); }
+  static voffset_t Offset(const Field &field) { return field.offset(); }
+  static bool Deprecated(const Field &field) { return field.deprecated(); }
+  Type FieldType(const Field &field) const { return Resolve(*field.type()); }
+  Type Resolve(const reflection::Type &type) const {
+    Type t;
+    t.base_type = static_cast<BaseType>(type.base_type());
+    t.element = static_cast<BaseType>(type.element());
+    t.fixed_length = type.fixed_length();
+    if (type.index() >= 0) {
+      if (t.base_type == BASE_TYPE_STRUCT || t.element == BASE_TYPE_STRUCT) {
+        t.object = schema_.objects()->Get(type.index());
+      } else {
+        t.enum_def = schema_.enums()->Get(type.index());
+      }
+    }
+    return t;
+  }
+  template<typename T> static T Default(const Field &field) {
+    return is_floating_point<T>::value
+               ? static_cast<T>(field.default_real())
+               : static_cast<T>(field.default_integer());
+  }
+  static bool IsFlexBuffer(const Field &field) {
+    return field.attributes() &&
+           field.attributes()->LookupByKey("flexbuffer") != nullptr;
+  }
+  const Object *NestedFlatBuffer(const Object &object,
+                                 const Field &field) const {
+    return view_.NestedFlatBuffer(object, field);
+  }
+
+  static const char *ValueName(const Enum &enum_def, int64_t val) {
+    auto ev = enum_def.values()->LookupByKey(val);
+    return ev ? ev->name()->c_str() : nullptr;
+  }
+  static bool IsBitFlags(const Enum &enum_def) {
+    return enum_def.attributes() &&
+           enum_def.attributes()->LookupByKey("bit_flags") != nullptr;
+  }
+  static size_t NumValues(const Enum &enum_def) {
+    return enum_def.values()->size();
+  }
+  static const char *ValueNameAt(const Enum &enum_def, size_t i) {
+    return enum_def.values()->Get(static_cast<uoffset_t>(i))->name()->c_str();
+  }
+  static uint64_t ValueAt(const Enum &enum_def, size_t i) {
+    return static_cast<uint64_t>(
+        enum_def.values()->Get(static_cast<uoffset_t>(i))->value());
+  }
+  bool UnionMember(const Enum &enum_def, uint8_t union_type,
+                   Type *member) const {
+    auto ev = union_type ? enum_def.values()->LookupByKey(union_type)
+                         : nullptr;
+    if (!ev) return false;
+    if (auto ut = ev->union_type()) {
+      *member = Resolve(*ut);
+      return true;
+    }
+    // Schemas from before union_type only have tables as members.
+    if (!ev->object()) return false;
+    *member = Type();
+    member->base_type = BASE_TYPE_STRUCT;
+    member->object = ev->object();
+    return true;
+  }
+
+ private:
+  const SchemaView &view_;
+  const reflection::Schema &schema_;
+  std::map<const reflection::Object *, FieldList> fields_by_id_;
+};
+
+template<typename Types> struct JsonPrinter {
+  typedef typename Types::Type Type;
+  typedef typename Types::Object Object;
+  typedef typename Types::Field Field;
+
   // If indentation is less than 0, that indicates we don't want any newlines
   // either.
   void AddNewLine() {
@@ -39,41 +237,56 @@ struct JsonPrinter {
 
   int Indent() const { return std::max(opts.indent_step, 0); }
 
+  // When streaming, hands the text generated so far to the sink.
+  bool Flush() {
+    if (!sink || text.empty()) return true;
+    auto ok = sink->Write(text.data(), text.size());
+    text.clear();
+    return ok;
+  }
+
+  // Called between values, keeps the buffered text around kChunkSize.
+  bool MaybeFlush() { return text.size() < kChunkSize || Flush(); }
+
   // Output an identifier with or without quotes depending on strictness.
-  void OutputIdentifier(const std::string &name) {
+  void OutputIdentifier(const Field &fd) {
     if (opts.strict_json) text += '\"';
-    text += name;
+    text += types.Name(fd);
     if (opts.strict_json) text += '\"';
   }
 
+  bool IsStructType(const Type &type) const {
+    return types.GetBaseType(type) == BASE_TYPE_STRUCT &&
+           types.IsFixed(*types.StructOf(type));
+  }
+
   // Print (and its template specialization below for pointers) generate text
   // for a single FlatBuffer value into JSON format.
   // The general case for scalars:
   template<typename T>
   bool PrintScalar(T val, const Type &type, int /*indent*/) {
-    if (IsBool(type.base_type)) {
+    if (IsBool(types.GetBaseType(type))) {
       text += val != 0 ? "true" : "false";
       return true;  // done
     }
 
-    if (opts.output_enum_identifiers && type.enum_def) {
-      const auto &enum_def = *type.enum_def;
-      if (auto ev = enum_def.ReverseLookup(static_cast<int64_t>(val))) {
+    if (opts.output_enum_identifiers && types.EnumOf(type)) {
+      const auto &enum_def = *types.EnumOf(type);
+      if (auto name = types.ValueName(enum_def, static_cast<int64_t>(val))) {
         text += '\"';
-        text += ev->name;
+        text += name;
         text += '\"';
         return true;  // done
-      } else if (val && enum_def.attributes.Lookup("bit_flags")) {
+      } else if (val && types.IsBitFlags(enum_def)) {
         const auto entry_len = text.length();
         const auto u64 = static_cast<uint64_t>(val);
         uint64_t mask = 0;
         text += '\"';
-        for (auto it = enum_def.Vals().begin(), e = enum_def.Vals().end();
-             it != e; ++it) {
-          auto f = (*it)->GetAsUInt64();
+        for (size_t i = 0, n = types.NumValues(enum_def); i < n; i++) {
+          auto f = types.ValueAt(enum_def, i);
           if (f & u64) {
             mask |= f;
-            text += (*it)->name;
+            text += types.ValueNameAt(enum_def, i);
             text += ' ';
           }
         }
@@ -104,6 +317,7 @@ struct JsonPrinter {
     text += '[';
     AddNewLine();
     for (uoffset_t i = 0; i < size; i++) {
+      if (!MaybeFlush()) return false;
       if (i) {
         AddComma();
         AddNewLine();
@@ -122,19 +336,21 @@ struct JsonPrinter {
   template<typename Container>
   bool PrintContainer(PrintPointerTag, const Container &c, size_t size,
                       const Type &type, int indent, const uint8_t *prev_val) {
-    const auto is_struct = IsStruct(type);
+    const auto is_struct = IsStructType(type);
     const auto elem_indent = indent + Indent();
     text += '[';
     AddNewLine();
     for (uoffset_t i = 0; i < size; i++) {
+      if (!MaybeFlush()) return false;
       if (i) {
         AddComma();
         AddNewLine();
       }
       AddIndent(elem_indent);
-      auto ptr = is_struct ? reinterpret_cast<const void *>(
-                                 c.Data() + type.struct_def->bytesize * i)
-                           : c[i];
+      auto ptr = is_struct
+                     ? reinterpret_cast<const void *>(
+                           c.Data() + types.ByteSize(*types.StructOf(type)) * i)
+                     : c[i];
       if (!PrintOffset(ptr, type, elem_indent, prev_val,
                        static_cast<soffset_t>(i))) {
         return false;
@@ -167,7 +383,7 @@ struct JsonPrinter {
 
   bool PrintOffset(const void *val, const Type &type, int indent,
                    const uint8_t *prev_val, soffset_t vector_index) {
-    switch (type.base_type) {
+    switch (types.GetBaseType(type)) {
       case BASE_TYPE_UNION: {
         // If this assert hits, you have an corrupt buffer, a union type field
         // was not present or was out of range.
@@ -178,26 +394,26 @@ struct JsonPrinter {
               prev_val + ReadScalar<uoffset_t>(prev_val));
           union_type_byte = type_vec->Get(static_cast<uoffset_t>(vector_index));
         }
-        auto enum_val = type.enum_def->ReverseLookup(union_type_byte, true);
-        if (enum_val) {
-          return PrintOffset(val, enum_val->union_type, indent, nullptr, -1);
+        Type member;
+        if (types.UnionMember(*types.EnumOf(type), union_type_byte, &member)) {
+          return PrintOffset(val, member, indent, nullptr, -1);
         } else {
           return false;
         }
       }
       case BASE_TYPE_STRUCT:
-        return GenStruct(*type.struct_def, reinterpret_cast<const Table *>(val),
-                         indent);
+        return GenStruct(*types.StructOf(type),
+                         reinterpret_cast<const Table *>(val), indent);
       case BASE_TYPE_STRING: {
         auto s = reinterpret_cast<const String *>(val);
         return EscapeString(s->c_str(), s->size(), &text, opts.allow_non_utf8,
                             opts.natural_utf8);
       }
       case BASE_TYPE_VECTOR: {
-        const auto vec_type = type.VectorType();
+        const auto vec_type = types.VectorType(type);
         // Call PrintVector above specifically for each element type:
         // clang-format off
-        switch (vec_type.base_type) {
+        switch (types.GetBaseType(vec_type)) {
         #define FLATBUFFERS_TD(ENUM, IDLTYPE, CTYPE, ...) \
           case BASE_TYPE_ ## ENUM: \
             if (!PrintVector<CTYPE>( \
@@ -212,14 +428,14 @@ struct JsonPrinter {
         return true;
       }
       case BASE_TYPE_ARRAY: {
-        const auto vec_type = type.VectorType();
+        const auto vec_type = types.VectorType(type);
         // Call PrintArray above specifically for each element type:
         // clang-format off
-        switch (vec_type.base_type) {
+        switch (types.GetBaseType(vec_type)) {
         #define FLATBUFFERS_TD(ENUM, IDLTYPE, CTYPE, ...) \
           case BASE_TYPE_ ## ENUM: \
             if (!PrintArray<CTYPE>( \
-                val, type.fixed_length, vec_type, indent)) { \
+                val, types.FixedLength(type), vec_type, indent)) { \
             return false; \
             } \
             break;
@@ -236,79 +452,76 @@ struct JsonPrinter {
     }
   }
 
-  template<typename T> static T GetFieldDefault(const FieldDef &fd) {
-    T val;
-    auto check = StringToNumber(fd.value.constant.c_str(), &val);
-    (void)check;
-    FLATBUFFERS_ASSERT(check);
-    return val;
-  }
-
   // Generate text for a scalar field.
   template<typename T>
-  bool GenField(const FieldDef &fd, const Table *table, bool fixed,
-                int indent) {
+  bool GenField(const Field &fd, const Table *table, bool fixed, int indent) {
     return PrintScalar(
         fixed ? reinterpret_cast<const Struct *>(table)->GetField<T>(
-                    fd.value.offset)
-              : table->GetField<T>(fd.value.offset, GetFieldDefault<T>(fd)),
-        fd.value.type, indent);
+                    types.Offset(fd))
+              : table->GetField<T>(types.Offset(fd),
+                                   types.template Default<T>(fd)),
+        types.FieldType(fd), indent);
   }
 
   // Generate text for non-scalar field.
-  bool GenFieldOffset(const FieldDef &fd, const Table *table, bool fixed,
-                      int indent, const uint8_t *prev_val) {
+  bool GenFieldOffset(const Object &struct_def, const Field &fd,
+                      const Table *table, bool fixed, int indent,
+                      const uint8_t *prev_val) {
     const void *val = nullptr;
+    const auto &type = types.FieldType(fd);
     if (fixed) {
       // The only non-scalar fields in structs are structs or arrays.
-      FLATBUFFERS_ASSERT(IsStruct(fd.value.type) || IsArray(fd.value.type));
+      FLATBUFFERS_ASSERT(IsStructType(type) ||
+                         types.GetBaseType(type) == BASE_TYPE_ARRAY);
       val = reinterpret_cast<const Struct *>(table)->GetStruct<const void *>(
-          fd.value.offset);
-    } else if (fd.flexbuffer) {
-      auto vec = table->GetPointer<const Vector<uint8_t> *>(fd.value.offset);
+          types.Offset(fd));
+    } else if (types.IsFlexBuffer(fd)) {
+      auto vec = table->GetPointer<const Vector<uint8_t> *>(types.Offset(fd));
       auto root = flexbuffers::GetRoot(vec->data(), vec->size());
-      root.ToString(true, opts.strict_json, text);
-      return true;
-    } else if (fd.nested_flatbuffer) {
-      auto vec = table->GetPointer<const Vector<uint8_t> *>(fd.value.offset);
+      // Large flexbuffers are streamed to the sink as they are printed.
+      return root.ToString(true, opts.strict_json, text, sink);
+    } else if (auto nested = types.NestedFlatBuffer(struct_def, fd)) {
+      auto vec = table->GetPointer<const Vector<uint8_t> *>(types.Offset(fd));
       auto root = GetRoot<Table>(vec->data());
-      return GenStruct(*fd.nested_flatbuffer, root, indent);
+      return GenStruct(*nested, root, indent);
     } else {
-      val = IsStruct(fd.value.type)
-                ? table->GetStruct<const void *>(fd.value.offset)
-                : table->GetPointer<const void *>(fd.value.offset);
+      val = IsStructType(type)
+                ? table->GetStruct<const void *>(types.Offset(fd))
+                : table->GetPointer<const void *>(types.Offset(fd));
     }
-    return PrintOffset(val, fd.value.type, indent, prev_val, -1);
+    return PrintOffset(val, type, indent, prev_val, -1);
   }
 
   // Generate text for a struct or table, values separated by commas, indented,
   // and bracketed by "{}"
-  bool GenStruct(const StructDef &struct_def, const Table *table, int indent) {
+  bool GenStruct(const Object &struct_def, const Table *table, int indent) {
     text += '{';
     int fieldout = 0;
     const uint8_t *prev_val = nullptr;
     const auto elem_indent = indent + Indent();
-    for (auto it = struct_def.fields.vec.begin();
-         it != struct_def.fields.vec.end(); ++it) {
-      FieldDef &fd = **it;
-      auto is_present = struct_def.fixed || table->CheckField(fd.value.offset);
+    const auto fixed = types.IsFixed(struct_def);
+    const auto &fields = types.Fields(struct_def);
+    for (auto it = fields.begin(); it != fields.end(); ++it) {
+      const Field &fd = **it;
+      const auto base_type = types.GetBaseType(types.FieldType(fd));
+      auto is_present = fixed || table->CheckField(types.Offset(fd));
       auto output_anyway = opts.output_default_scalars_in_json &&
-                           IsScalar(fd.value.type.base_type) && !fd.deprecated;
+                           IsScalar(base_type) && !types.Deprecated(fd);
       if (is_present || output_anyway) {
+        if (!MaybeFlush()) return false;
         if (fieldout++) { AddComma(); }
         AddNewLine();
         AddIndent(elem_indent);
-        OutputIdentifier(fd.name);
+        OutputIdentifier(fd);
         if (!opts.protobuf_ascii_alike ||
-            (fd.value.type.base_type != BASE_TYPE_STRUCT &&
-             fd.value.type.base_type != BASE_TYPE_VECTOR))
+            (base_type != BASE_TYPE_STRUCT && base_type != BASE_TYPE_VECTOR))
           text += ':';
         text += ' ';
         // clang-format off
-        switch (fd.value.type.base_type) {
+        switch (base_type) {
         #define FLATBUFFERS_TD(ENUM, IDLTYPE, CTYPE, ...) \
           case BASE_TYPE_ ## ENUM: \
-            if (!GenField<CTYPE>(fd, table, struct_def.fixed, elem_indent)) { \
+            if (!GenField<CTYPE>(fd, table, fixed, elem_indent)) { \
               return false; \
             } \
             break;
@@ -320,18 +533,17 @@ struct JsonPrinter {
               FLATBUFFERS_GEN_TYPES_POINTER(FLATBUFFERS_TD)
               FLATBUFFERS_GEN_TYPE_ARRAY(FLATBUFFERS_TD)
         #undef FLATBUFFERS_TD
-              if (!GenFieldOffset(fd, table, struct_def.fixed, elem_indent, prev_val)) {
+              if (!GenFieldOffset(struct_def, fd, table, fixed, elem_indent,
+                                  prev_val)) {
                 return false;
               }
             break;
         }
         // clang-format on
         // Track prev val for use with union types.
-        if (struct_def.fixed) {
-          prev_val = reinterpret_cast<const uint8_t *>(table) + fd.value.offset;
-        } else {
-          prev_val = table->GetAddressOf(fd.value.offset);
-        }
+        const auto offset = types.Offset(fd);
+        prev_val = fixed ? reinterpret_cast<const uint8_t *>(table) + offset
+                         : table->GetAddressOf(offset);
       }
     }
     AddNewLine();
@@ -340,21 +552,44 @@ struct JsonPrinter {
     return true;
   }
 
-  JsonPrinter(const Parser &parser, std::string &dest)
-      : opts(parser.opts), text(dest) {
-    text.reserve(1024);  // Reduce amount of inevitable reallocs.
+  // With a sink, `dest` is only used as the buffer for the current chunk.
+  JsonPrinter(Types &_types, const typename Types::Options &_opts,
+              std::string &dest, TextSink *_sink)
+      : types(_types), opts(_opts), text(dest), sink(_sink) {
+    // Reduce amount of inevitable reallocs.
+    text.reserve(sink ? kChunkSize + 1024 : 1024);
   }
 
-  const IDLOptions &opts;
+  static const size_t kChunkSize = 1 << 16;
+
+  Types &types;
+  const typename Types::Options &opts;
   std::string &text;
+  TextSink *sink;
 };
 
-static bool GenerateTextImpl(const Parser &parser, const Table *table,
-                             const StructDef &struct_def, std::string *_text) {
-  JsonPrinter printer(parser, *_text);
-  if (!printer.GenStruct(struct_def, table, 0)) { return false; }
+template<typename Types>
+static bool GenerateTextImpl(Types &types, const typename Types::Options &opts,
+                             const typename Types::Object &object,
+                             const Table *table, std::string *_text,
+                             TextSink *sink) {
+  JsonPrinter<Types> printer(types, opts, *_text, sink);
+  if (!printer.GenStruct(object, table, 0)) { return false; }
   printer.AddNewLine();
-  return true;
+  return printer.Flush();
+}
+
+static bool GenerateTextImpl(const Parser &parser, const Table *table,
+                             const StructDef &struct_def, std::string *_text,
+                             TextSink *sink = nullptr) {
+  ParserTypes types;
+  return GenerateTextImpl(types, parser.opts, struct_def, table, _text, sink);
+}
+
+static const Table *GetTextRoot(const Parser &parser, const void *flatbuffer) {
+  FLATBUFFERS_ASSERT(parser.root_struct_def_);  // call SetRootType()
+  return parser.opts.size_prefixed ? GetSizePrefixedRoot<Table>(flatbuffer)
+                                   : GetRoot<Table>(flatbuffer);
 }
 
 // Generate a text representation of a flatbuffer in JSON format.
@@ -369,10 +604,46 @@ bool GenerateTextFromTable(const Parser &parser, const void *table,
 // Generate a text representation of a flatbuffer in JSON format.
 bool GenerateText(const Parser &parser, const void *flatbuffer,
                   std::string *_text) {
-  FLATBUFFERS_ASSERT(parser.root_struct_def_);  // call SetRootType()
-  auto root = parser.opts.size_prefixed ? GetSizePrefixedRoot<Table>(flatbuffer)
-                                        : GetRoot<Table>(flatbuffer);
-  return GenerateTextImpl(parser, root, *parser.root_struct_def_, _text);
+  return GenerateTextImpl(parser, GetTextRoot(parser, flatbuffer),
+                          *parser.root_struct_def_, _text);
+}
+
+// Same, streaming the text to a sink with bounded memory use.
+bool GenerateText(const Parser &parser, const void *flatbuffer,
+                  TextSink *sink) {
+  std::string chunk;
+  return GenerateTextImpl(parser, GetTextRoot(parser, flatbuffer),
+                          *parser.root_struct_def_, &chunk, sink);
+}
+
+static const Table *GetTextRoot(const SchemaView::TextOptions &opts,
+                                const void *flatbuffer) {
+  return opts.size_prefixed ? GetSizePrefixedRoot<Table>(flatbuffer)
+                            : GetRoot<Table>(flatbuffer);
+}
+
+bool SchemaView::GenerateText(const void *flatbuffer, const TextOptions &opts,
+                              std::string *text) const {
+  auto root = RootTable();
+  return root && GenerateText(*root, GetTextRoot(opts, flatbuffer), opts, text);
+}
+
+bool SchemaView::GenerateText(const void *flatbuffer, const TextOptions &opts,
+                              TextSink *sink) const {
+  auto root = RootTable();
+  if (!root) return false;
+  SchemaTypes types(*this);
+  std::string chunk;
+  return GenerateTextImpl(types, opts, *root, GetTextRoot(opts, flatbuffer),
+                          &chunk, sink);
+}
+
+bool SchemaView::GenerateText(const reflection::Object &object,
+                              const Table *table, const TextOptions &opts,
+                              std::string *text) const {
+  FLATBUFFERS_ASSERT(schema_);
+  SchemaTypes types(*this);
+  return GenerateTextImpl(types, opts, object, table, text, nullptr);
 }
 
 static std::string TextFileName(const std::string &path,
@@ -382,19 +653,26 @@ static std::string TextFileName(const std::string &path,
 
 bool GenerateTextFile(const Parser &parser, const std::string &path,
                       const std::string &file_name) {
-  if (parser.opts.use_flexbuffers) {
-    std::string json;
-    parser.flex_root_.ToString(true, parser.opts.strict_json, json);
-    return flatbuffers::SaveFile(TextFileName(path, file_name).c_str(),
-                                 json.c_str(), json.size(), true);
-  }
-  if (!parser.builder_.GetSize() || !parser.root_struct_def_) return true;
-  std::string text;
-  if (!GenerateText(parser, parser.builder_.GetBufferPointer(), &text)) {
+  auto flex = parser.opts.use_flexbuffers;
+  if (!flex && (!parser.builder_.GetSize() || !parser.root_struct_def_))
+    return true;
+  // Stream to a temporary file rather than holding all of the text in
+  // memory, then save that in place of the old output.
+  auto name = TextFileName(path, file_name);
+  auto tmp_name = name + ".tmp";
+  auto file = fopen(tmp_name.c_str(), flex ? "wb" : "w");
+  if (!file) return false;
+  FileTextSink sink(file);
+  auto ok = flex ? parser.flex_root_.ToString(true, parser.opts.strict_json,
+                                              &sink)
+                 : GenerateText(parser, parser.builder_.GetBufferPointer(),
+                                &sink);
+  ok = (fclose(file) == 0) && ok;
+  if (!ok) {
+    remove(tmp_name.c_str());
     return false;
   }
-  return flatbuffers::SaveFile(TextFileName(path, file_name).c_str(), text,
-                               false);
+  return SaveTempFile(tmp_name.c_str(), name.c_str(), flex);
 }
 
 std::string TextMakeRule(const Parser &parser, const std::string &path,
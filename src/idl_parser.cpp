@@ -23,6 +23,27 @@
 #include "flatbuffers/idl.h"
 #include "flatbuffers/util.h"
 
+// Next() skips whitespace, string contents and line comments a block at a
+// time where a vector instruction set is available.
+// clang-format off
+#if !defined(FLATBUFFERS_NO_SIMD_SCAN)
+  #if defined(__AVX2__)
+    #include <immintrin.h>
+    #define FLATBUFFERS_SCAN_AVX2 1
+  #elif defined(__SSE2__) || defined(_M_X64) || \
+        (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define FLATBUFFERS_SCAN_SSE2 1
+  #elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+    #include <arm_neon.h>
+    #define FLATBUFFERS_SCAN_NEON 1
+  #endif
+  #if defined(_MSC_VER)
+    #include <intrin.h>
+  #endif
+#endif
+// clang-format on
+
 namespace flatbuffers {
 
 // Reflects the version at the compiling time of binary(lib/dll/so).
@@ -73,9 +94,7 @@ static_assert(BASE_TYPE_UNION == static_cast<BaseType>(reflection::Union),
 #define NEXT() ECHECK(Next())
 #define EXPECT(tok) ECHECK(Expect(tok))
 
-static bool ValidateUTF8(const std::string &str) {
-  const char *s = &str[0];
-  const char *const sEnd = s + str.length();
+static bool ValidateUTF8(const char *s, const char *const sEnd) {
   while (s < sEnd) {
     if (FromUTF8(&s) < 0) { return false; }
   }
@@ -237,19 +256,6 @@ std::string Parser::TokenToStringId(int t) const {
   return t == kTokenIdentifier ? attribute_ : TokenToString(t);
 }
 
-// Parses exactly nibbles worth of hex digits into a number, or error.
-CheckedError Parser::ParseHexNum(int nibbles, uint64_t *val) {
-  FLATBUFFERS_ASSERT(nibbles > 0);
-  for (int i = 0; i < nibbles; i++)
-    if (!is_xdigit(cursor_[i]))
-      return Error("escape code must be followed by " + NumToString(nibbles) +
-                   " hex digits");
-  std::string target(cursor_, cursor_ + nibbles);
-  *val = StringToUInt(target.c_str(), 16);
-  cursor_ += nibbles;
-  return NoError();
-}
-
 CheckedError Parser::SkipByteOrderMark() {
   if (static_cast<unsigned char>(*cursor_) != 0xef) return NoError();
   cursor_++;
@@ -266,6 +272,347 @@ static inline bool IsIdentifierStart(char c) {
   return is_alpha(c) || (c == '_');
 }
 
+// Block scanning primitives: ScanLoad() reads kScanBlockSize bytes, and the
+// comparisons return a mask with bit i set if byte i matches.
+// clang-format off
+#if defined(FLATBUFFERS_SCAN_AVX2)
+  typedef __m256i ScanBlock;
+  static const size_t kScanBlockSize = 32;
+
+  static inline ScanBlock ScanLoad(const char *p) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+  }
+
+  static inline uint32_t ScanEq(ScanBlock b, char c) {
+    return static_cast<uint32_t>(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(b, _mm256_set1_epi8(c))));
+  }
+
+  // Unsigned b <= c.
+  static inline uint32_t ScanLe(ScanBlock b, char c) {
+    return static_cast<uint32_t>(_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(_mm256_min_epu8(b, _mm256_set1_epi8(c)), b)));
+  }
+
+  // Unsigned b >= c.
+  static inline uint32_t ScanGe(ScanBlock b, char c) {
+    return static_cast<uint32_t>(_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(_mm256_max_epu8(b, _mm256_set1_epi8(c)), b)));
+  }
+#elif defined(FLATBUFFERS_SCAN_SSE2)
+  typedef __m128i ScanBlock;
+  static const size_t kScanBlockSize = 16;
+
+  static inline ScanBlock ScanLoad(const char *p) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+  }
+
+  static inline uint32_t ScanEq(ScanBlock b, char c) {
+    return static_cast<uint32_t>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(b, _mm_set1_epi8(c))));
+  }
+
+  static inline uint32_t ScanLe(ScanBlock b, char c) {
+    return static_cast<uint32_t>(_mm_movemask_epi8(
+        _mm_cmpeq_epi8(_mm_min_epu8(b, _mm_set1_epi8(c)), b)));
+  }
+
+  static inline uint32_t ScanGe(ScanBlock b, char c) {
+    return static_cast<uint32_t>(_mm_movemask_epi8(
+        _mm_cmpeq_epi8(_mm_max_epu8(b, _mm_set1_epi8(c)), b)));
+  }
+#elif defined(FLATBUFFERS_SCAN_NEON)
+  typedef uint8x16_t ScanBlock;
+  static const size_t kScanBlockSize = 16;
+
+  static inline ScanBlock ScanLoad(const char *p) {
+    return vld1q_u8(reinterpret_cast<const uint8_t *>(p));
+  }
+
+  // NEON has no movemask: weigh each lane by its bit and add them up.
+  static inline uint32_t ScanMoveMask(uint8x16_t m) {
+    static const uint8_t kBits[16] = { 1, 2, 4, 8, 16, 32, 64, 128,
+                                       1, 2, 4, 8, 16, 32, 64, 128 };
+    auto w = vandq_u8(m, vld1q_u8(kBits));
+    auto lo = vget_low_u8(w);
+    auto hi = vget_high_u8(w);
+    lo = vpadd_u8(lo, lo);
+    lo = vpadd_u8(lo, lo);
+    lo = vpadd_u8(lo, lo);
+    hi = vpadd_u8(hi, hi);
+    hi = vpadd_u8(hi, hi);
+    hi = vpadd_u8(hi, hi);
+    return static_cast<uint32_t>(vget_lane_u8(lo, 0)) |
+           (static_cast<uint32_t>(vget_lane_u8(hi, 0)) << 8);
+  }
+
+  static inline uint32_t ScanEq(ScanBlock b, char c) {
+    return ScanMoveMask(vceqq_u8(b, vdupq_n_u8(static_cast<uint8_t>(c))));
+  }
+
+  static inline uint32_t ScanLe(ScanBlock b, char c) {
+    return ScanMoveMask(vcleq_u8(b, vdupq_n_u8(static_cast<uint8_t>(c))));
+  }
+
+  static inline uint32_t ScanGe(ScanBlock b, char c) {
+    return ScanMoveMask(vcgeq_u8(b, vdupq_n_u8(static_cast<uint8_t>(c))));
+  }
+#endif
+
+#if defined(FLATBUFFERS_SCAN_AVX2) || defined(FLATBUFFERS_SCAN_SSE2) || \
+    defined(FLATBUFFERS_SCAN_NEON)
+  #define FLATBUFFERS_SCAN_SIMD 1
+
+  static const uint32_t kScanBlockMask =
+      static_cast<uint32_t>((1ULL << kScanBlockSize) - 1);
+
+  // Index of the lowest/highest set bit of a non-zero mask.
+  static inline size_t ScanFirst(uint32_t m) {
+    #if defined(_MSC_VER)
+      unsigned long i;
+      _BitScanForward(&i, m);
+      return i;
+    #else
+      return static_cast<size_t>(__builtin_ctz(m));
+    #endif
+  }
+
+  static inline size_t ScanLast(uint32_t m) {
+    #if defined(_MSC_VER)
+      unsigned long i;
+      _BitScanReverse(&i, m);
+      return i;
+    #else
+      return static_cast<size_t>(31 - __builtin_clz(m));
+    #endif
+  }
+
+  // The bits below bit n.
+  static inline uint32_t ScanPrefix(size_t n) {
+    return static_cast<uint32_t>((1ULL << n) - 1);
+  }
+#endif
+// clang-format on
+
+// The functions below only look at whole blocks before `end`, leaving the
+// remainder and whatever stopped them to the byte-wise code in Next(). Without
+// SIMD support they return `p` unchanged.
+
+// Skips whitespace, updating the line count and start for each '\n'.
+static inline const char *SkipWhitespaceBlocks(const char *p, const char *end,
+                                               int *line,
+                                               const char **line_start) {
+  // clang-format off
+  #ifdef FLATBUFFERS_SCAN_SIMD
+    while (static_cast<size_t>(end - p) >= kScanBlockSize) {
+      auto b = ScanLoad(p);
+      auto nl = ScanEq(b, '\n');
+      auto ws = nl | ScanEq(b, ' ') | ScanEq(b, '\t') | ScanEq(b, '\r');
+      auto stop = ~ws & kScanBlockMask;
+      auto n = stop ? ScanFirst(stop) : kScanBlockSize;
+      nl &= ScanPrefix(n);
+      if (nl) {
+        *line_start = p + ScanLast(nl) + 1;
+        for (; nl; nl &= nl - 1) (*line)++;
+      }
+      p += n;
+      if (stop) break;
+    }
+  #else
+    (void)end;
+    (void)line;
+    (void)line_start;
+  #endif
+  // clang-format on
+  return p;
+}
+
+// Skips string contents up to the closing quote, a backslash or a control
+// character. Clears *trivial_ascii if a skipped byte is not printable ASCII.
+static inline const char *SkipStringBlocks(const char *p, const char *end,
+                                           char quote, bool *trivial_ascii) {
+  // clang-format off
+  #ifdef FLATBUFFERS_SCAN_SIMD
+    while (static_cast<size_t>(end - p) >= kScanBlockSize) {
+      auto b = ScanLoad(p);
+      auto stop = ScanEq(b, quote) | ScanEq(b, '\\') | ScanLe(b, '\x1F');
+      auto n = stop ? ScanFirst(stop) : kScanBlockSize;
+      if (ScanGe(b, '\x7F') & ScanPrefix(n)) *trivial_ascii = false;
+      p += n;
+      if (stop) break;
+    }
+  #else
+    (void)end;
+    (void)quote;
+    (void)trivial_ascii;
+  #endif
+  // clang-format on
+  return p;
+}
+
+// Skips to the end of a line comment.
+static inline const char *SkipLineBlocks(const char *p, const char *end) {
+  // clang-format off
+  #ifdef FLATBUFFERS_SCAN_SIMD
+    while (static_cast<size_t>(end - p) >= kScanBlockSize) {
+      auto b = ScanLoad(p);
+      auto stop = ScanEq(b, '\n') | ScanEq(b, '\r') | ScanEq(b, '\0');
+      if (stop) return p + ScanFirst(stop);
+      p += kScanBlockSize;
+    }
+  #else
+    (void)end;
+  #endif
+  // clang-format on
+  return p;
+}
+
+// Reads exactly nibbles hex digits at *p into *val, advancing *p past them.
+static bool ScanHexNum(const char **p, int nibbles, uint32_t *val) {
+  *val = 0;
+  for (int i = 0; i < nibbles; i++) {
+    auto c = (*p)[i];
+    if (!is_xdigit(c)) return false;
+    *val = *val * 16 +
+           static_cast<uint32_t>(is_digit(c) ? c - '0' : (c & 0x0F) + 9);
+  }
+  *p += nibbles;
+  return true;
+}
+
+// Scans the rest of a string constant, from just past the opening quote to
+// just past the closing one, and appends its contents with escapes resolved
+// to *out. Clears *trivial_ascii if the string has escapes or bytes that are
+// not printable ASCII. On error returns the message, with *p left where it
+// was found. Both Next() and FlexJsonConverter scan strings with this.
+static const char *ScanStringConstant(const char **p, const char *end,
+                                      char quote, bool allow_non_utf8,
+                                      std::string *out, bool *trivial_ascii) {
+  auto &cursor = *p;
+  const auto out_start = out->size();
+  int unicode_high_surrogate = -1;
+  while (*cursor != quote) {
+    if (unicode_high_surrogate == -1) {
+      auto run = SkipStringBlocks(cursor, end, quote, trivial_ascii);
+      out->append(cursor, run);
+      cursor = run;
+      if (*cursor == quote) break;
+    }
+    if (*cursor < ' ' && static_cast<signed char>(*cursor) >= 0)
+      return "illegal character in string constant";
+    if (*cursor == '\\') {
+      *trivial_ascii = false;  // has escape sequence
+      cursor++;
+      if (unicode_high_surrogate != -1 && *cursor != 'u')
+        return "illegal Unicode sequence (unpaired high surrogate)";
+      uint32_t val;
+      switch (*cursor) {
+        case 'n': *out += '\n'; break;
+        case 't': *out += '\t'; break;
+        case 'r': *out += '\r'; break;
+        case 'b': *out += '\b'; break;
+        case 'f': *out += '\f'; break;
+        case '\"': *out += '\"'; break;
+        case '\'': *out += '\''; break;
+        case '\\': *out += '\\'; break;
+        case '/': *out += '/'; break;
+        case 'x':  // Not in the JSON standard
+          cursor++;
+          if (!ScanHexNum(p, 2, &val))
+            return "escape code must be followed by 2 hex digits";
+          *out += static_cast<char>(val);
+          continue;
+        case 'u':
+          cursor++;
+          if (!ScanHexNum(p, 4, &val))
+            return "escape code must be followed by 4 hex digits";
+          if (val >= 0xD800 && val <= 0xDBFF) {
+            if (unicode_high_surrogate != -1)
+              return "illegal Unicode sequence (multiple high surrogates)";
+            unicode_high_surrogate = static_cast<int>(val);
+          } else if (val >= 0xDC00 && val <= 0xDFFF) {
+            if (unicode_high_surrogate == -1)
+              return "illegal Unicode sequence (unpaired low surrogate)";
+            int code_point = 0x10000 +
+                             ((unicode_high_surrogate & 0x03FF) << 10) +
+                             static_cast<int>(val & 0x03FF);
+            ToUTF8(code_point, out);
+            unicode_high_surrogate = -1;
+          } else {
+            if (unicode_high_surrogate != -1)
+              return "illegal Unicode sequence (unpaired high surrogate)";
+            ToUTF8(static_cast<int>(val), out);
+          }
+          continue;
+        default: return "unknown escape code in string constant";
+      }
+      cursor++;
+    } else {  // printable chars + UTF-8 bytes
+      if (unicode_high_surrogate != -1)
+        return "illegal Unicode sequence (unpaired high surrogate)";
+      // reset if non-printable
+      *trivial_ascii &= check_ascii_range(*cursor, ' ', '~');
+      *out += *cursor++;
+    }
+  }
+  if (unicode_high_surrogate != -1)
+    return "illegal Unicode sequence (unpaired high surrogate)";
+  cursor++;
+  if (!*trivial_ascii && !allow_non_utf8 &&
+      !ValidateUTF8(out->data() + out_start, out->data() + out->size())) {
+    return "illegal UTF-8 sequence";
+  }
+  return nullptr;
+}
+
+// Scans a number at p, which starts with a digit, a sign, or a '.' followed by
+// a digit. Accepts hexadecimal-floating-literal (see C++ 5.13.4). Sets *end
+// past what was scanned and returns kTokenIntegerConstant or
+// kTokenFloatConstant, or kTokenEof if it is not a valid number. Both Next()
+// and FlexJsonConverter scan numbers with this.
+static int ScanNumber(const char *p, const char **end) {
+  auto cursor = p;
+  auto c = *cursor++;
+  auto dot_lvl = (c == '.') ? 0 : 1;  // dot_lvl==0 <=> exactly one '.' seen
+  auto start_digits = !is_digit(c) ? cursor : cursor - 1;
+  if (!is_digit(c) && is_digit(*cursor)) {
+    start_digits = cursor;  // see digit in cursor position
+    c = *cursor++;
+  }
+  // hex-float can't begind with '.'
+  auto use_hex = dot_lvl && (c == '0') && is_alpha_char(*cursor, 'X');
+  if (use_hex) start_digits = ++cursor;  // '0x' is the prefix, skip it
+  // Read an integer number or mantisa of float-point number.
+  do {
+    if (use_hex) {
+      while (is_xdigit(*cursor)) cursor++;
+    } else {
+      while (is_digit(*cursor)) cursor++;
+    }
+  } while ((*cursor == '.') && (++cursor) && (--dot_lvl >= 0));
+  // Exponent of float-point number.
+  if ((dot_lvl >= 0) && (cursor > start_digits)) {
+    // The exponent suffix of hexadecimal float number is mandatory.
+    if (use_hex && !dot_lvl) start_digits = cursor;
+    if ((use_hex && is_alpha_char(*cursor, 'P')) ||
+        is_alpha_char(*cursor, 'E')) {
+      dot_lvl = 0;  // Emulate dot to signal about float-point number.
+      cursor++;
+      if (*cursor == '+' || *cursor == '-') cursor++;
+      start_digits = cursor;  // the exponent-part has to have digits
+      // Exponent is decimal integer number
+      while (is_digit(*cursor)) cursor++;
+      if (*cursor == '.') {
+        cursor++;  // If see a dot treat it as part of invalid number.
+        dot_lvl = -1;  // Fall thru to the error.
+      }
+    }
+  }
+  *end = cursor;
+  if ((dot_lvl < 0) || (cursor <= start_digits)) return kTokenEof;
+  return dot_lvl ? kTokenIntegerConstant : kTokenFloatConstant;
+}
+
 CheckedError Parser::Next() {
   doc_comment_.clear();
   bool seen_newline = cursor_ == source_;
@@ -279,13 +626,19 @@ CheckedError Parser::Next() {
         cursor_--;
         token_ = kTokenEof;
         return NoError();
-      case ' ':
-      case '\r':
-      case '\t': break;
       case '\n':
         MarkNewLine();
         seen_newline = true;
+        FLATBUFFERS_FALLTHROUGH();
+      case ' ':
+      case '\r':
+      case '\t': {
+        auto line = line_;
+        cursor_ =
+            SkipWhitespaceBlocks(cursor_, source_end_, &line_, &line_start_);
+        seen_newline |= line != line_;
         break;
+      }
       case '{':
       case '}':
       case '(':
@@ -298,121 +651,17 @@ CheckedError Parser::Next() {
       case '=': return NoError();
       case '\"':
       case '\'': {
-        int unicode_high_surrogate = -1;
-
-        while (*cursor_ != c) {
-          if (*cursor_ < ' ' && static_cast<signed char>(*cursor_) >= 0)
-            return Error("illegal character in string constant");
-          if (*cursor_ == '\\') {
-            attr_is_trivial_ascii_string_ = false;  // has escape sequence
-            cursor_++;
-            if (unicode_high_surrogate != -1 && *cursor_ != 'u') {
-              return Error(
-                  "illegal Unicode sequence (unpaired high surrogate)");
-            }
-            switch (*cursor_) {
-              case 'n':
-                attribute_ += '\n';
-                cursor_++;
-                break;
-              case 't':
-                attribute_ += '\t';
-                cursor_++;
-                break;
-              case 'r':
-                attribute_ += '\r';
-                cursor_++;
-                break;
-              case 'b':
-                attribute_ += '\b';
-                cursor_++;
-                break;
-              case 'f':
-                attribute_ += '\f';
-                cursor_++;
-                break;
-              case '\"':
-                attribute_ += '\"';
-                cursor_++;
-                break;
-              case '\'':
-                attribute_ += '\'';
-                cursor_++;
-                break;
-              case '\\':
-                attribute_ += '\\';
-                cursor_++;
-                break;
-              case '/':
-                attribute_ += '/';
-                cursor_++;
-                break;
-              case 'x': {  // Not in the JSON standard
-                cursor_++;
-                uint64_t val;
-                ECHECK(ParseHexNum(2, &val));
-                attribute_ += static_cast<char>(val);
-                break;
-              }
-              case 'u': {
-                cursor_++;
-                uint64_t val;
-                ECHECK(ParseHexNum(4, &val));
-                if (val >= 0xD800 && val <= 0xDBFF) {
-                  if (unicode_high_surrogate != -1) {
-                    return Error(
-                        "illegal Unicode sequence (multiple high surrogates)");
-                  } else {
-                    unicode_high_surrogate = static_cast<int>(val);
-                  }
-                } else if (val >= 0xDC00 && val <= 0xDFFF) {
-                  if (unicode_high_surrogate == -1) {
-                    return Error(
-                        "illegal Unicode sequence (unpaired low surrogate)");
-                  } else {
-                    int code_point = 0x10000 +
-                                     ((unicode_high_surrogate & 0x03FF) << 10) +
-                                     (val & 0x03FF);
-                    ToUTF8(code_point, &attribute_);
-                    unicode_high_surrogate = -1;
-                  }
-                } else {
-                  if (unicode_high_surrogate != -1) {
-                    return Error(
-                        "illegal Unicode sequence (unpaired high surrogate)");
-                  }
-                  ToUTF8(static_cast<int>(val), &attribute_);
-                }
-                break;
-              }
-              default: return Error("unknown escape code in string constant");
-            }
-          } else {  // printable chars + UTF-8 bytes
-            if (unicode_high_surrogate != -1) {
-              return Error(
-                  "illegal Unicode sequence (unpaired high surrogate)");
-            }
-            // reset if non-printable
-            attr_is_trivial_ascii_string_ &=
-                check_ascii_range(*cursor_, ' ', '~');
-
-            attribute_ += *cursor_++;
-          }
-        }
-        if (unicode_high_surrogate != -1) {
-          return Error("illegal Unicode sequence (unpaired high surrogate)");
-        }
-        cursor_++;
-        if (!attr_is_trivial_ascii_string_ && !opts.allow_non_utf8 &&
-            !ValidateUTF8(attribute_)) {
-          return Error("illegal UTF-8 sequence");
-        }
+        auto error = ScanStringConstant(&cursor_, source_end_, c,
+                                        opts.allow_non_utf8, &attribute_,
+                                        &attr_is_trivial_ascii_string_);
+        if (error) return Error(error);
         token_ = kTokenStringConstant;
         return NoError();
       }
       case '/':
         if (*cursor_ == '/') {
           const char *start = ++cursor_;
+          cursor_ = SkipLineBlocks(cursor_, source_end_);
           while (*cursor_ && *cursor_ != '\n' && *cursor_ != '\r') cursor_++;
           if (*start == '/') {  // documentation comment
             if (!seen_newline)
@@ -446,54 +695,15 @@ CheckedError Parser::Next() {
           return NoError();
         }
 
-        auto dot_lvl =
-            (c == '.') ? 0 : 1;  // dot_lvl==0 <=> exactly one '.' seen
-        if (!dot_lvl && !is_digit(*cursor_)) return NoError();  // enum?
-        // Parser accepts hexadecimal-floating-literal (see C++ 5.13.4).
-        if (is_digit(c) || has_sign || !dot_lvl) {
+        if (c == '.' && !is_digit(*cursor_)) return NoError();  // enum?
+        if (is_digit(c) || has_sign || c == '.') {
           const auto start = cursor_ - 1;
-          auto start_digits = !is_digit(c) ? cursor_ : cursor_ - 1;
-          if (!is_digit(c) && is_digit(*cursor_)) {
-            start_digits = cursor_;  // see digit in cursor_ position
-            c = *cursor_++;
-          }
-          // hex-float can't begind with '.'
-          auto use_hex = dot_lvl && (c == '0') && is_alpha_char(*cursor_, 'X');
-          if (use_hex) start_digits = ++cursor_;  // '0x' is the prefix, skip it
-          // Read an integer number or mantisa of float-point number.
-          do {
-            if (use_hex) {
-              while (is_xdigit(*cursor_)) cursor_++;
-            } else {
-              while (is_digit(*cursor_)) cursor_++;
-            }
-          } while ((*cursor_ == '.') && (++cursor_) && (--dot_lvl >= 0));
-          // Exponent of float-point number.
-          if ((dot_lvl >= 0) && (cursor_ > start_digits)) {
-            // The exponent suffix of hexadecimal float number is mandatory.
-            if (use_hex && !dot_lvl) start_digits = cursor_;
-            if ((use_hex && is_alpha_char(*cursor_, 'P')) ||
-                is_alpha_char(*cursor_, 'E')) {
-              dot_lvl = 0;  // Emulate dot to signal about float-point number.
-              cursor_++;
-              if (*cursor_ == '+' || *cursor_ == '-') cursor_++;
-              start_digits = cursor_;  // the exponent-part has to have digits
-              // Exponent is decimal integer number
-              while (is_digit(*cursor_)) cursor_++;
-              if (*cursor_ == '.') {
-                cursor_++;  // If see a dot treat it as part of invalid number.
-                dot_lvl = -1;  // Fall thru to Error().
-              }
-            }
-          }
-          // Finalize.
-          if ((dot_lvl >= 0) && (cursor_ > start_digits)) {
-            attribute_.append(start, cursor_);
-            token_ = dot_lvl ? kTokenIntegerConstant : kTokenFloatConstant;
-            return NoError();
-          } else {
+          auto token = ScanNumber(start, &cursor_);
+          if (token == kTokenEof)
             return Error("invalid number: " + std::string(start, cursor_));
-          }
+          attribute_.append(start, cursor_);
+          token_ = token;
+          return NoError();
         }
         std::string ch;
         ch = c;
@@ -932,7 +1142,7 @@ CheckedError Parser::ParseAnyValue(Value &val, FieldDef *field,
         // scanning/serialization logic would get very complicated.
         auto type_name = field->name + UnionTypeFieldSuffix();
         FLATBUFFERS_ASSERT(parent_struct_def);
-        auto type_field = parent_struct_def->fields.Lookup(type_name);
+        auto type_field = parent_struct_def->LookupField(type_name);
         FLATBUFFERS_ASSERT(type_field);  // Guaranteed by ParseField().
         // Remember where we are in the source file, so we can come back here.
         auto backup = *static_cast<ParserState *>(this);
@@ -1081,7 +1291,7 @@ CheckedError Parser::ParseTable(const StructDef &struct_def, std::string *value,
           ECHECK(Expect(kTokenStringConstant));
           return NoError();
         }
-        auto field = struct_def_inner->fields.Lookup(name);
+        auto field = struct_def_inner->LookupField(name);
         if (!field) {
           if (!opts.skip_unexpected_fields_in_json) {
             return Error("unknown field: " + name);
@@ -1345,8 +1555,8 @@ CheckedError Parser::ParseVector(const Type &type, uoffset_t *ovalue,
     // globals, making parsing thread-unsafe.
     // So for now, we use SimpleQsort above.
     // TODO: replace with something better, preferably not recursive.
-    static voffset_t offset = key->value.offset;
-    static BaseType ftype = key->value.type.base_type;
+    auto offset = key->value.offset;
+    auto ftype = key->value.type.base_type;
 
     if (type.struct_def->fixed) {
       auto v =
@@ -1354,7 +1564,7 @@ CheckedError Parser::ParseVector(const Type &type, uoffset_t *ovalue,
       SimpleQsort<uint8_t>(
           v->Data(), v->Data() + v->size() * type.struct_def->bytesize,
           type.struct_def->bytesize,
-          [](const uint8_t *a, const uint8_t *b) -> bool {
+          [&](const uint8_t *a, const uint8_t *b) -> bool {
             return CompareType(a + offset, b + offset, ftype);
           },
           [&](uint8_t *a, uint8_t *b) {
@@ -1371,7 +1581,7 @@ CheckedError Parser::ParseVector(const Type &type, uoffset_t *ovalue,
       // can't be used to swap elements.
       SimpleQsort<Offset<Table>>(
           v->data(), v->data() + v->size(), 1,
-          [](const Offset<Table> *_a, const Offset<Table> *_b) -> bool {
+          [&](const Offset<Table> *_a, const Offset<Table> *_b) -> bool {
             // Indirect offset pointer to table pointer.
             auto a = reinterpret_cast<const uint8_t *>(_a) +
                      ReadScalar<uoffset_t>(_a);
@@ -1450,34 +1660,32 @@ CheckedError Parser::ParseNestedFlatbuffer(Value &val, FieldDef *field,
   if (token_ == '[') {  // backwards compat for 'legacy' ubyte buffers
     ECHECK(ParseAnyValue(val, field, fieldn, parent_struct_def, 0));
   } else {
-    auto cursor_at_value_begin = cursor_;
-    ECHECK(SkipAnyJsonValue());
-    std::string substring(cursor_at_value_begin - 1, cursor_ - 1);
-
-    // Create and initialize new parser
-    Parser nested_parser;
+    // Parse the nested table in place, into a builder of its own.
     FLATBUFFERS_ASSERT(field->nested_flatbuffer);
-    nested_parser.root_struct_def_ = field->nested_flatbuffer;
-    nested_parser.enums_ = enums_;
-    nested_parser.opts = opts;
-    nested_parser.uses_flexbuffers_ = uses_flexbuffers_;
-
-    // Parse JSON substring into new flatbuffer builder using nested_parser
-    bool ok = nested_parser.Parse(substring.c_str(), nullptr, nullptr);
-
-    // Clean nested_parser to avoid deleting the elements in
-    // the SymbolTables on destruction
-    nested_parser.enums_.dict.clear();
-    nested_parser.enums_.vec.clear();
-
-    if (!ok) { ECHECK(Error(nested_parser.error_)); }
+    if (nested_builders_.size() == nested_depth_) {
+      nested_builders_.push_back(flatbuffers::unique_ptr<FlatBufferBuilder>(
+          new FlatBufferBuilder()));
+    }
+    auto &nested_builder = *nested_builders_[nested_depth_];
+    nested_builder.Clear();
+    builder_.Swap(nested_builder);
+    nested_depth_++;
+    uoffset_t toff;
+    auto err = ParseTable(*field->nested_flatbuffer, nullptr, &toff);
+    nested_depth_--;
+    builder_.Swap(nested_builder);
+    ECHECK(err);
+    if (opts.size_prefixed) {
+      nested_builder.FinishSizePrefixed(Offset<Table>(toff));
+    } else {
+      nested_builder.Finish(Offset<Table>(toff));
+    }
     // Force alignment for nested flatbuffer
-    builder_.ForceVectorAlignment(
-        nested_parser.builder_.GetSize(), sizeof(uint8_t),
-        nested_parser.builder_.GetBufferMinAlignment());
+    builder_.ForceVectorAlignment(nested_builder.GetSize(), sizeof(uint8_t),
+                                  nested_builder.GetBufferMinAlignment());
 
-    auto off = builder_.CreateVector(nested_parser.builder_.GetBufferPointer(),
-                                     nested_parser.builder_.GetSize());
+    auto off = builder_.CreateVector(nested_builder.GetBufferPointer(),
+                                     nested_builder.GetSize());
     val.constant = NumToString(off.o);
   }
   return NoError();
@@ -1872,6 +2080,52 @@ template<typename T> static uint64_t EnumDistanceImpl(T e1, T e2) {
   return static_cast<uint64_t>(e1) - static_cast<uint64_t>(e2);
 }
 
+static uint32_t FieldNameHash(const std::string &name, uint32_t seed) {
+  // FNV-1a, with the seed mixed into the offset basis.
+  auto hash = 2166136261u ^ (seed * 16777619u);
+  for (auto it = name.begin(); it != name.end(); ++it) {
+    hash ^= static_cast<uint8_t>(*it);
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+FieldDef *StructDef::LookupField(const std::string &field_name) const {
+  const auto &slots = field_index_.slots;
+  if (slots.empty() || field_index_.num_fields != fields.vec.size()) {
+    return fields.Lookup(field_name);
+  }
+  auto field =
+      slots[FieldNameHash(field_name, field_index_.seed) & (slots.size() - 1)];
+  return field && field->name == field_name ? field : nullptr;
+}
+
+void StructDef::BuildFieldIndex() {
+  auto &slots = field_index_.slots;
+  field_index_.num_fields = fields.vec.size();
+  size_t size = 1;
+  while (size < 2 * fields.vec.size()) size <<= 1;
+  // A few seeds per size are normally enough; past that, a bigger table has
+  // fewer collisions to begin with. The limit is only there for duplicate
+  // names, which an erroneous schema can still have.
+  for (; !fields.vec.empty() && size <= 64 * fields.vec.size(); size <<= 1) {
+    for (uint32_t seed = 0; seed < 16; seed++) {
+      slots.assign(size, nullptr);
+      auto it = fields.vec.begin();
+      for (; it != fields.vec.end(); ++it) {
+        auto &slot = slots[FieldNameHash((*it)->name, seed) & (size - 1)];
+        if (slot) break;
+        slot = *it;
+      }
+      if (it == fields.vec.end()) {
+        field_index_.seed = seed;
+        return;
+      }
+    }
+  }
+  slots.clear();  // Fall back on fields.Lookup().
+}
+
 uint64_t EnumDef::Distance(const EnumVal *v1, const EnumVal *v2) const {
   return IsUInt64() ? EnumDistanceImpl(v1->GetAsUInt64(), v2->GetAsUInt64())
                     : EnumDistanceImpl(v1->GetAsInt64(), v2->GetAsInt64());
@@ -2328,6 +2582,7 @@ CheckedError Parser::ParseDecl() {
   ECHECK(CheckClash(fields, struct_def, "_byte_vector", BASE_TYPE_STRING));
   ECHECK(CheckClash(fields, struct_def, "ByteVector", BASE_TYPE_STRING));
   EXPECT('}');
+  struct_def->BuildFieldIndex();
   types_.Add(current_namespace_->GetFullyQualifiedName(struct_def->name),
              new Type(BASE_TYPE_STRUCT, struct_def, nullptr));
   return NoError();
@@ -2398,6 +2653,98 @@ void Parser::MarkGenerated() {
   }
 }
 
+template<typename T>
+static void SaveDefinitions(const std::vector<T *> &defs,
+                            std::vector<std::pair<int, bool>> *state) {
+  for (auto it = defs.begin(); it != defs.end(); ++it)
+    state->push_back(std::make_pair((*it)->refcount, (*it)->generated));
+}
+
+template<typename T>
+static size_t RestoreDefinitions(
+    const std::vector<T *> &defs, size_t count,
+    const std::vector<std::pair<int, bool>> &state, size_t pos) {
+  for (size_t i = 0; i < count; i++, pos++) {
+    defs[i]->refcount = state[pos].first;
+    defs[i]->generated = state[pos].second;
+  }
+  return pos;
+}
+
+// Deletes the entries added to table after its first size ones.
+template<typename T>
+static void TruncateSymbolTable(SymbolTable<T> *table, size_t size) {
+  if (table->vec.size() == size) return;
+  std::set<const T *> dropped(table->vec.begin() + size, table->vec.end());
+  for (auto it = table->dict.begin(); it != table->dict.end();) {
+    if (dropped.count(it->second))
+      it = table->dict.erase(it);
+    else
+      ++it;
+  }
+  for (auto it = table->vec.begin() + size; it != table->vec.end(); ++it)
+    delete *it;
+  table->vec.resize(size);
+}
+
+void Parser::SetCheckpoint() {
+  FLATBUFFERS_ASSERT(!opts.proto_mode);
+  auto &cp = checkpoint_;
+  cp.types = types_.vec.size();
+  cp.structs = structs_.vec.size();
+  cp.enums = enums_.vec.size();
+  cp.services = services_.vec.size();
+  cp.namespaces = namespaces_.size();
+  cp.definitions.clear();
+  SaveDefinitions(structs_.vec, &cp.definitions);
+  SaveDefinitions(enums_.vec, &cp.definitions);
+  SaveDefinitions(services_.vec, &cp.definitions);
+  cp.root_struct_def = root_struct_def_;
+  cp.file_identifier = file_identifier_;
+  cp.go_module = go_module_;
+  cp.file_extension = file_extension_;
+  cp.included_files = included_files_;
+  cp.files_included_per_file = files_included_per_file_;
+  cp.native_included_files = native_included_files_;
+  cp.known_attributes = known_attributes_;
+  cp.uses_flexbuffers = uses_flexbuffers_;
+  cp.anonymous_counter = anonymous_counter;
+}
+
+void Parser::RestoreCheckpoint() {
+  auto &cp = checkpoint_;
+  TruncateSymbolTable(&types_, cp.types);
+  TruncateSymbolTable(&structs_, cp.structs);
+  TruncateSymbolTable(&enums_, cp.enums);
+  TruncateSymbolTable(&services_, cp.services);
+  for (auto it = namespaces_.begin() + static_cast<std::ptrdiff_t>(
+                                          cp.namespaces);
+       it != namespaces_.end(); ++it)
+    delete *it;
+  namespaces_.resize(cp.namespaces);
+  current_namespace_ = empty_namespace_;
+  // Later definitions may refer to earlier ones, or be marked as generated
+  // along with them.
+  size_t pos = 0;
+  pos = RestoreDefinitions(structs_.vec, cp.structs, cp.definitions, pos);
+  pos = RestoreDefinitions(enums_.vec, cp.enums, cp.definitions, pos);
+  RestoreDefinitions(services_.vec, cp.services, cp.definitions, pos);
+  root_struct_def_ = cp.root_struct_def;
+  file_identifier_ = cp.file_identifier;
+  go_module_ = cp.go_module;
+  file_extension_ = cp.file_extension;
+  included_files_ = cp.included_files;
+  files_included_per_file_ = cp.files_included_per_file;
+  native_included_files_ = cp.native_included_files;
+  known_attributes_ = cp.known_attributes;
+  uses_flexbuffers_ = cp.uses_flexbuffers;
+  anonymous_counter = cp.anonymous_counter;
+  error_.clear();
+  field_stack_.clear();
+  builder_.Clear();
+  flex_builder_.Clear();
+}
+
 CheckedError Parser::ParseNamespace() {
   NEXT();
   auto ns = new Namespace();
@@ -2643,6 +2990,7 @@ CheckedError Parser::ParseProtoFields(StructDef *struct_def, bool isextend,
     }
   }
   NEXT();
+  struct_def->BuildFieldIndex();
   return NoError();
 }
 
@@ -2812,12 +3160,245 @@ CheckedError Parser::ParseFlexBufferValue(flexbuffers::Builder *builder) {
   return NoError();
 }
 
+namespace {
+
+// Converts schemaless JSON straight to FlexBuffers. It accepts the same input
+// as ParseFlexBufferValue() and makes the same calls on the builder, but has
+// no tokens or Parser state to maintain: it scans values in place, using the
+// same block scanning, ScanStringConstant() and ScanNumber() as Next().
+class FlexJsonConverter {
+ public:
+  FlexJsonConverter(const char *json, const IDLOptions &opts,
+                    flexbuffers::Builder *builder)
+      : cursor_(json),
+        end_(json + strlen(json)),
+        opts_(opts),
+        builder_(builder),
+        error_pos_(nullptr),
+        line_(0),
+        line_start_(json) {}
+
+  bool Convert() {
+    if (static_cast<unsigned char>(cursor_[0]) == 0xef) {
+      if (static_cast<unsigned char>(cursor_[1]) != 0xbb ||
+          static_cast<unsigned char>(cursor_[2]) != 0xbf) {
+        return Error("invalid utf-8 byte order mark");
+      }
+      cursor_ += 3;
+    }
+    if (!SkipSpace()) return false;
+    if (!*cursor_) return Error("input file is empty");
+    if (!ParseValue(0)) return false;
+    // Comments after JSON are allowed.
+    if (*cursor_) return Error("expecting: end of file");
+    builder_->Finish();
+    return true;
+  }
+
+  const std::string &error() const { return error_; }
+  const char *error_pos() const { return error_pos_; }
+
+ private:
+  bool Error(const std::string &msg) {
+    error_ = msg;
+    error_pos_ = cursor_;
+    return false;
+  }
+
+  // Skips whitespace and comments.
+  bool SkipSpace() {
+    for (;;) {
+      switch (*cursor_) {
+        case ' ':
+        case '\t':
+        case '\r':
+        case '\n':
+          cursor_ = SkipWhitespaceBlocks(cursor_ + 1, end_, &line_,
+                                         &line_start_);
+          break;
+        case '/':
+          if (cursor_[1] == '/') {
+            cursor_ = SkipLineBlocks(cursor_ + 2, end_);
+            while (*cursor_ && *cursor_ != '\n' && *cursor_ != '\r') cursor_++;
+          } else if (cursor_[1] == '*') {
+            cursor_ += 2;
+            while (*cursor_ != '*' || cursor_[1] != '/') {
+              if (!*cursor_) return Error("end of file in comment");
+              cursor_++;
+            }
+            cursor_ += 2;
+          } else {
+            return true;
+          }
+          break;
+        default: return true;
+      }
+    }
+  }
+
+  bool Expect(char c) {
+    if (*cursor_ != c) {
+      return Error(std::string("expecting: ") + c + " instead got: " +
+                   (*cursor_ ? std::string(1, *cursor_) : "end of file"));
+    }
+    cursor_++;
+    return SkipSpace();
+  }
+
+  bool ParseString() {
+    const auto quote = *cursor_++;
+    str_.clear();
+    auto trivial_ascii = true;
+    auto error = ScanStringConstant(&cursor_, end_, quote, opts_.allow_non_utf8,
+                                    &str_, &trivial_ascii);
+    return !error || Error(error);
+  }
+
+  bool ParseValue(int depth) {
+    if (depth >= FLATBUFFERS_MAX_PARSING_DEPTH) {
+      return Error("maximum parsing recursion of " +
+                   NumToString(FLATBUFFERS_MAX_PARSING_DEPTH) + " reached");
+    }
+    const auto start = cursor_;
+    const auto c = *cursor_;
+    switch (c) {
+      case '{': return ParseMap(depth);
+      case '[': return ParseVector(depth);
+      case '\"':
+      case '\'':
+        if (!ParseString()) return false;
+        builder_->String(str_);
+        return SkipSpace();
+      default: break;
+    }
+    const auto has_sign = c == '+' || c == '-';
+    if (IsIdentifierStart(c) || (has_sign && IsIdentifierStart(cursor_[1]))) {
+      cursor_++;
+      while (IsIdentifierStart(*cursor_) || is_digit(*cursor_)) cursor_++;
+      str_.assign(start, cursor_);
+      if (has_sign) {
+        // Like Next(), keep a signed identifier such as -inf as a string.
+        builder_->String(str_);
+      } else if (str_ == "true" || str_ == "false") {
+        builder_->Bool(str_ == "true");
+      } else if (str_ == "null") {
+        builder_->Null();
+      } else {
+        cursor_ = start;
+        return Error("cannot parse value starting with: " + str_);
+      }
+      return SkipSpace();
+    }
+    if (!(is_digit(c) || has_sign || (c == '.' && is_digit(cursor_[1])))) {
+      if (!c) return Error("cannot parse value starting with: end of file");
+      if (!check_ascii_range(c, ' ', '~')) {
+        return Error("illegal character: code: " + NumToString(c));
+      }
+      return Error("cannot parse value starting with: " + std::string(1, c));
+    }
+    auto token = ScanNumber(start, &cursor_);
+    if (token == kTokenEof) {
+      return Error("invalid number: " + std::string(start, cursor_));
+    }
+    str_.assign(start, cursor_);
+    if (token == kTokenIntegerConstant) {
+      builder_->Int(StringToInt(str_.c_str()));
+    } else {
+      double d;
+      StringToNumber(str_.c_str(), &d);
+      builder_->Double(d);
+    }
+    return SkipSpace();
+  }
+
+  bool ParseMap(int depth) {
+    auto start = builder_->StartMap();
+    if (!Expect('{')) return false;
+    for (size_t fieldn = 0;; fieldn++) {
+      if ((!opts_.strict_json || !fieldn) && *cursor_ == '}') break;
+      if (*cursor_ == '\"' || *cursor_ == '\'') {
+        if (!ParseString()) return false;
+      } else if (!opts_.strict_json && IsIdentifierStart(*cursor_)) {
+        auto key = cursor_;
+        while (IsIdentifierStart(*cursor_) || is_digit(*cursor_)) cursor_++;
+        str_.assign(key, cursor_);
+      } else {
+        return Error(opts_.strict_json ? "expecting: string constant"
+                                       : "expecting: identifier");
+      }
+      if (!SkipSpace() || !Expect(':')) return false;
+      builder_->Key(str_);
+      if (!ParseValue(depth + 1)) return false;
+      if (*cursor_ == '}') break;
+      if (!Expect(',')) return false;
+    }
+    cursor_++;
+    builder_->EndMap(start);
+    return SkipSpace();
+  }
+
+  bool ParseVector(int depth) {
+    auto start = builder_->StartVector();
+    if (!Expect('[')) return false;
+    for (size_t count = 0;; count++) {
+      if ((!opts_.strict_json || !count) && *cursor_ == ']') break;
+      if (!ParseValue(depth + 1)) return false;
+      if (*cursor_ == ']') break;
+      if (!Expect(',')) return false;
+    }
+    cursor_++;
+    builder_->EndVector(start, false, false);
+    return SkipSpace();
+  }
+
+  const char *cursor_;
+  const char *end_;
+  const IDLOptions &opts_;
+  flexbuffers::Builder *builder_;
+  std::string str_;  // The last string, key or number scanned.
+  std::string error_;
+  const char *error_pos_;
+  // SkipWhitespaceBlocks() counts lines, the converter has no use for them.
+  int line_;
+  const char *line_start_;
+};
+
+}  // namespace
+
+bool ParseFlexBufferJson(const char *json, const IDLOptions &opts,
+                         flexbuffers::Builder *builder, std::string *error,
+                         const char **error_pos) {
+  FlexJsonConverter converter(json, opts, builder);
+  if (converter.Convert()) return true;
+  *error = converter.error();
+  if (error_pos) *error_pos = converter.error_pos();
+  return false;
+}
+
 bool Parser::ParseFlexBuffer(const char *source, const char *source_filename,
                              flexbuffers::Builder *builder) {
-  auto ok = !StartParseFile(source, source_filename).Check() &&
-            !ParseFlexBufferValue(builder).Check();
-  if (ok) builder->Finish();
-  return ok;
+  if (opts.protobuf_ascii_alike) {
+    auto ok = !StartParseFile(source, source_filename).Check() &&
+              !ParseFlexBufferValue(builder).Check();
+    if (ok) builder->Finish();
+    return ok;
+  }
+  // Plain JSON doesn't need the tokenizer, see FlexJsonConverter.
+  file_being_parsed_ = source_filename ? source_filename : "";
+  source_ = source;
+  ResetState(source_);
+  error_.clear();
+  std::string error;
+  const char *error_pos = source;
+  if (ParseFlexBufferJson(source, opts, builder, &error, &error_pos)) {
+    return true;
+  }
+  // Report the error at its line and column, like any other.
+  while (cursor_ < error_pos) {
+    if (*cursor_++ == '\n') MarkNewLine();
+  }
+  Message("error: " + error);
+  return false;
 }
 
 bool Parser::Parse(const char *source, const char **include_paths,
@@ -3256,6 +3837,7 @@ bool StructDef::Deserialize(Parser &parser, const reflection::Object *object) {
     }
   }
   FLATBUFFERS_ASSERT(static_cast<int>(tmp_struct_size) == object->bytesize());
+  BuildFieldIndex();
   return true;
 }
 
@@ -3290,9 +3872,10 @@ bool FieldDef::Deserialize(Parser &parser, const reflection::Field *field) {
     value.constant = NumToString(field->default_integer());
   } else if (IsFloat(value.type.base_type)) {
     value.constant = FloatToString(field->default_real(), 16);
-    size_t last_zero = value.constant.find_last_not_of('0');
-    if (last_zero != std::string::npos && last_zero != 0) {
-      value.constant.erase(last_zero, std::string::npos);
+    // FloatToString keeps one fractional digit, drop it for whole numbers.
+    auto len = value.constant.length();
+    if (len > 2 && value.constant.compare(len - 2, 2, ".0") == 0) {
+      value.constant.resize(len - 2);
     }
   }
   deprecated = field->deprecated();
@@ -3471,8 +4054,12 @@ flatbuffers::Offset<
     flatbuffers::Vector<flatbuffers::Offset<reflection::KeyValue>>>
 Definition::SerializeAttributes(FlatBufferBuilder *builder,
                                 const Parser &parser) const {
+  // Go through the attributes by name, so the output doesn't depend on the
+  // order of the hashed dict.
+  std::map<std::string, Value *> sorted(attributes.dict.begin(),
+                                        attributes.dict.end());
   std::vector<flatbuffers::Offset<reflection::KeyValue>> attrs;
-  for (auto kv = attributes.dict.begin(); kv != attributes.dict.end(); ++kv) {
+  for (auto kv = sorted.begin(); kv != sorted.end(); ++kv) {
     auto it = parser.known_attributes_.find(kv->first);
     FLATBUFFERS_ASSERT(it != parser.known_attributes_.end());
     if (parser.opts.binary_schema_builtins || !it->second) {
@@ -0,0 +1,226 @@
+/*
+ * Copyright 2020 Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Parallel conversion of newline-delimited JSON to size-prefixed FlatBuffers.
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+#include "flatbuffers/idl.h"
+#include "flatbuffers/util.h"
+
+namespace flatbuffers {
+
+namespace {
+
+// A run of whole lines of the input, and what became of them.
+struct NdjsonChunk {
+  NdjsonChunk()
+      : begin(nullptr), end(nullptr), lines(0), done(false), failed(false) {}
+
+  const char *begin;
+  const char *end;
+  std::string output;  // The size-prefixed buffers, back to back.
+  size_t lines;        // Lines consumed, up to and including a failed one.
+  std::string error;
+  bool done;
+  bool failed;
+};
+
+class NdjsonConverter {
+ public:
+  NdjsonConverter(const uint8_t *schema, size_t schema_size,
+                  const IDLOptions &opts, const char *ndjson, size_t size,
+                  const NdjsonOptions &ndjson_opts)
+      : schema_(schema),
+        schema_size_(schema_size),
+        opts_(opts),
+        num_threads_(ndjson_opts.num_threads),
+        cursor_(ndjson),
+        end_(ndjson + size),
+        chunk_size_(ndjson_opts.chunk_size ? ndjson_opts.chunk_size : 1),
+        next_chunk_(0),
+        written_(0),
+        stop_(false) {
+    opts_.size_prefixed = true;
+    if (!num_threads_) num_threads_ = std::thread::hardware_concurrency();
+    if (!num_threads_) num_threads_ = 1;
+    // Enough chunks in flight to keep every thread busy while the writer
+    // waits on the oldest one.
+    chunks_.resize(num_threads_ * 4);
+  }
+
+  bool Convert(TextSink *sink, std::string *error) {
+    {
+      // Validate the schema once up front, rather than in every thread.
+      Parser parser(opts_);
+      if (!parser.Deserialize(schema_, schema_size_)) {
+        *error = "failed to load binary schema";
+        return false;
+      }
+      if (!parser.root_struct_def_) {
+        *error = "no root type set to parse json with";
+        return false;
+      }
+    }
+    std::vector<std::thread> threads;
+    for (unsigned i = 0; i < num_threads_; i++)
+      threads.push_back(std::thread(&NdjsonConverter::Work, this));
+    auto ok = Write(sink, error);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    cv_.notify_all();
+    for (auto it = threads.begin(); it != threads.end(); ++it) it->join();
+    return ok;
+  }
+
+ private:
+  // Hands out chunks in input order, and stops at the first failed one.
+  void Work() {
+    Parser parser(opts_);
+    auto loaded = parser.Deserialize(schema_, schema_size_);
+    FLATBUFFERS_ASSERT(loaded);
+    (void)loaded;
+    std::string line;
+    for (;;) {
+      NdjsonChunk *chunk;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stop_ && cursor_ != end_ &&
+               next_chunk_ >= written_ + chunks_.size())
+          cv_.wait(lock);
+        if (stop_ || cursor_ == end_) return;
+        chunk = &chunks_[next_chunk_++ % chunks_.size()];
+        chunk->begin = cursor_;
+        cursor_ += std::min(chunk_size_, static_cast<size_t>(end_ - cursor_));
+        auto eol = static_cast<const char *>(
+            memchr(cursor_, '\n', static_cast<size_t>(end_ - cursor_)));
+        cursor_ = eol ? eol + 1 : end_;
+        chunk->end = cursor_;
+        chunk->output.clear();
+        chunk->error.clear();
+        chunk->lines = 0;
+        chunk->done = false;
+        chunk->failed = false;
+      }
+      ParseChunk(parser, chunk, &line);
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        chunk->done = true;
+        // Chunks before this one have all been handed out already, so the
+        // writer will still get to report the first error in input order.
+        if (chunk->failed) stop_ = true;
+      }
+      cv_.notify_all();
+    }
+  }
+
+  void ParseChunk(Parser &parser, NdjsonChunk *chunk, std::string *line) {
+    for (auto p = chunk->begin; p != chunk->end;) {
+      auto eol = static_cast<const char *>(
+          memchr(p, '\n', static_cast<size_t>(chunk->end - p)));
+      if (!eol) eol = chunk->end;
+      chunk->lines++;
+      auto start = p;
+      while (start != eol &&
+             (*start == ' ' || *start == '\t' || *start == '\r'))
+        start++;
+      p = eol == chunk->end ? eol : eol + 1;
+      if (start == eol) continue;  // Blank line.
+      // Only a JSON object is allowed, not schema declarations.
+      if (*start != '{') {
+        chunk->error = "expecting a JSON object";
+        chunk->failed = true;
+        return;
+      }
+      line->assign(start, eol);
+      if (!parser.Parse(line->c_str())) {
+        chunk->error = parser.error_;
+        chunk->failed = true;
+        return;
+      }
+      chunk->output.append(
+          reinterpret_cast<const char *>(parser.builder_.GetBufferPointer()),
+          parser.builder_.GetSize());
+    }
+  }
+
+  // Writes out the chunks in input order as they complete.
+  bool Write(TextSink *sink, std::string *error) {
+    size_t line = 0;
+    for (;;) {
+      NdjsonChunk *chunk;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        chunk = &chunks_[written_ % chunks_.size()];
+        while (written_ == next_chunk_ ? cursor_ != end_ && !stop_
+                                       : !chunk->done)
+          cv_.wait(lock);
+        if (written_ == next_chunk_) return true;  // All input consumed.
+      }
+      line += chunk->lines;
+      if (chunk->failed) {
+        *error = "line " + NumToString(line) + ": " + chunk->error;
+        return false;
+      }
+      if (!chunk->output.empty() &&
+          !sink->Write(chunk->output.data(), chunk->output.size())) {
+        *error = "failed to write output";
+        return false;
+      }
+      chunk->output.clear();
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        written_++;
+      }
+      cv_.notify_all();
+    }
+  }
+
+  const uint8_t *schema_;
+  size_t schema_size_;
+  IDLOptions opts_;
+  unsigned num_threads_;
+
+  // Guarded by mutex_.
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  const char *cursor_;  // Start of the input not yet handed out.
+  const char *end_;
+  const size_t chunk_size_;
+  std::vector<NdjsonChunk> chunks_;  // Ring buffer indexed by chunk number.
+  size_t next_chunk_;                // Chunks handed out so far.
+  size_t written_;                   // Chunks written so far.
+  bool stop_;
+};
+
+}  // namespace
+
+bool ParseNdjson(const uint8_t *schema, size_t schema_size,
+                 const IDLOptions &opts, const char *ndjson, size_t size,
+                 TextSink *sink, std::string *error,
+                 const NdjsonOptions &ndjson_opts) {
+  NdjsonConverter converter(schema, schema_size, opts, ndjson, size,
+                            ndjson_opts);
+  return converter.Convert(sink, error);
+}
+
+}  // namespace flatbuffers
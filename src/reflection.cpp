@@ -16,6 +16,9 @@
 
 #include "flatbuffers/reflection.h"
 
+#include <map>
+
+#include "flatbuffers/flexbuffers.h"
 #include "flatbuffers/util.h"
 
 // Helper functionality for reflection.
@@ -710,4 +713,769 @@ bool Verify(const reflection::Schema &schema, const reflection::Object &root,
   return VerifyObject(v, schema, root, flatbuffers::GetAnyRoot(buf), true);
 }
 
+namespace {
+
+const reflection::KeyValue *LookupAttribute(
+    const Vector<Offset<reflection::KeyValue>> *attributes, const char *key) {
+  return attributes ? attributes->LookupByKey(key) : nullptr;
+}
+
+// Looks up a definition by name in each namespace enclosing scope, innermost
+// first, the way names in a schema are resolved.
+template<typename T>
+const T *LookupScoped(const Vector<Offset<T>> &defs, const std::string &name,
+                      const std::string &scope) {
+  auto prefix = scope;
+  for (;;) {
+    auto def = defs.LookupByKey(
+        (prefix.empty() ? name : prefix + "." + name).c_str());
+    if (def || prefix.empty()) return def;
+    auto dot = prefix.find_last_of('.');
+    prefix.resize(dot == std::string::npos ? 0 : dot);
+  }
+}
+
+// The namespace names used in `object` are resolved in.
+std::string Scope(const reflection::Object &object) {
+  const auto &name = object.name()->str();
+  auto dot = name.find_last_of('.');
+  return dot == std::string::npos ? "" : name.substr(0, dot);
+}
+
+// Copies a FlexBuffer value into a Builder, for FlexBuffers nested in
+// others.
+void CopyFlexBuffer(const flexbuffers::Reference &ref,
+                    flexbuffers::Builder &fbb) {
+  switch (ref.GetType()) {
+    case flexbuffers::FBT_NULL: fbb.Null(); break;
+    case flexbuffers::FBT_BOOL: fbb.Bool(ref.AsBool()); break;
+    case flexbuffers::FBT_INT:
+    case flexbuffers::FBT_INDIRECT_INT: fbb.Int(ref.AsInt64()); break;
+    case flexbuffers::FBT_UINT:
+    case flexbuffers::FBT_INDIRECT_UINT: fbb.UInt(ref.AsUInt64()); break;
+    case flexbuffers::FBT_FLOAT:
+    case flexbuffers::FBT_INDIRECT_FLOAT: fbb.Double(ref.AsDouble()); break;
+    case flexbuffers::FBT_KEY: fbb.String(ref.AsKey()); break;
+    case flexbuffers::FBT_STRING: fbb.String(ref.AsString()); break;
+    case flexbuffers::FBT_BLOB: {
+      auto blob = ref.AsBlob();
+      fbb.Blob(blob.data(), blob.size());
+      break;
+    }
+    case flexbuffers::FBT_MAP: {
+      auto map = ref.AsMap();
+      auto keys = map.Keys();
+      auto values = map.Values();
+      auto start = fbb.StartMap();
+      for (size_t i = 0; i < map.size(); i++) {
+        fbb.Key(keys[i].AsKey());
+        CopyFlexBuffer(values[i], fbb);
+      }
+      fbb.EndMap(start);
+      break;
+    }
+    default: {
+      auto vec = ref.AsVector();
+      auto start = fbb.StartVector();
+      if (ref.IsTypedVector()) {
+        auto typed = ref.AsTypedVector();
+        for (size_t i = 0; i < typed.size(); i++)
+          CopyFlexBuffer(typed[i], fbb);
+      } else if (ref.IsFixedTypedVector()) {
+        auto fixed = ref.AsFixedTypedVector();
+        for (size_t i = 0; i < fixed.size(); i++)
+          CopyFlexBuffer(fixed[i], fbb);
+      } else {
+        for (size_t i = 0; i < vec.size(); i++) CopyFlexBuffer(vec[i], fbb);
+      }
+      fbb.EndVector(start, false, false);
+      break;
+    }
+  }
+}
+
+// The elements of any kind of FlexBuffer vector.
+class FlexElements {
+ public:
+  explicit FlexElements(const flexbuffers::Reference &ref)
+      : vec_(ref.AsVector()),
+        typed_(ref.AsTypedVector()),
+        fixed_(ref.AsFixedTypedVector()),
+        kind_(ref.IsTypedVector() ? 1 : ref.IsFixedTypedVector() ? 2 : 0) {}
+
+  size_t size() const {
+    return kind_ == 1 ? typed_.size()
+                      : kind_ == 2 ? fixed_.size() : vec_.size();
+  }
+  flexbuffers::Reference operator[](size_t i) const {
+    return kind_ == 1 ? typed_[i] : kind_ == 2 ? fixed_[i] : vec_[i];
+  }
+
+ private:
+  flexbuffers::Vector vec_;
+  flexbuffers::TypedVector typed_;
+  flexbuffers::FixedTypedVector fixed_;
+  int kind_;
+};
+
+// Writes a FlatBuffer from a FlexBuffer holding the equivalent of its JSON,
+// with the same rules as Parser::ParseTable() has for the JSON itself.
+class FlexBufferReader {
+ public:
+  FlexBufferReader(const SchemaView &view, FlatBufferBuilder &fbb,
+                   std::string &error)
+      : view_(view), schema_(*view.schema()), fbb_(fbb), error_(error) {}
+
+  bool Error(const std::string &msg) {
+    error_ = msg;
+    return false;
+  }
+
+  // Writes a table, and returns its offset in `offset`.
+  bool ReadTable(const reflection::Object &object,
+                 const flexbuffers::Reference &flex, uoffset_t *offset) {
+    if (!flex.IsMap()) return Error(object.name()->str() + ": expecting a map");
+    auto map = flex.AsMap();
+    auto keys = map.Keys();
+    auto values = map.Values();
+    // Strings, vectors and tables have to be written before the table.
+    struct FieldValue {
+      const reflection::Field *field;
+      flexbuffers::Reference value;
+      uoffset_t offset;
+    };
+    std::vector<FieldValue> fields;
+    for (size_t i = 0; i < map.size(); i++) {
+      auto name = keys[i].AsKey();
+      auto field = object.fields()->LookupByKey(name);
+      if (!field) return Error("unknown field: " + std::string(name));
+      if (field->deprecated()) continue;
+      FieldValue fv = { field, values[i], 0 };
+      if (!ReadReference(object, map, *field, values[i], &fv.offset))
+        return false;
+      fields.push_back(fv);
+    }
+    for (auto it = object.fields()->begin(); it != object.fields()->end();
+         ++it) {
+      if (it->required() && map[it->name()->c_str()].IsNull()) {
+        return Error("required field is missing: " + it->name()->str() +
+                     " in " + object.name()->str());
+      }
+    }
+    auto start = fbb_.StartTable();
+    for (auto it = fields.begin(); it != fields.end(); ++it) {
+      const auto &field = *it->field;
+      const auto &type = *field.type();
+      if (IsScalar(type.base_type())) {
+        if (!AddScalar(field, it->value)) return false;
+      } else if (type.base_type() == reflection::Obj &&
+                 schema_.objects()->Get(type.index())->is_struct()) {
+        if (!PushStruct(*schema_.objects()->Get(type.index()), it->value))
+          return false;
+        fbb_.TrackField(field.offset(), fbb_.GetSize());
+      } else if (it->offset) {
+        fbb_.AddOffset(field.offset(), Offset<void>(it->offset));
+      }
+    }
+    *offset = fbb_.EndTable(start);
+    return true;
+  }
+
+ private:
+  template<typename T>
+  static T DefaultValue(const reflection::Field &field) {
+    return is_floating_point<T>::value
+               ? static_cast<T>(field.default_real())
+               : static_cast<T>(field.default_integer());
+  }
+
+  // Reads an integer, which enums may give by name, and bit flags as several
+  // names separated by spaces.
+  bool ReadInteger(const flexbuffers::Reference &flex, int32_t index,
+                   int64_t *i) {
+    if (flex.IsBool()) {
+      *i = flex.AsBool();
+    } else if (flex.IsUInt()) {
+      *i = static_cast<int64_t>(flex.AsUInt64());
+    } else if (flex.IsInt()) {
+      *i = flex.AsInt64();
+    } else if ((flex.IsString() || flex.IsKey()) && index >= 0) {
+      const auto &enum_def = *schema_.enums()->Get(index);
+      auto names = flex.AsString().str();
+      *i = 0;
+      for (size_t pos = 0; pos < names.size();) {
+        auto end = names.find(' ', pos);
+        if (end == std::string::npos) end = names.size();
+        auto name = names.substr(pos, end - pos);
+        pos = end + 1;
+        if (name.empty()) continue;
+        // Names may be qualified with the enum, as in "Color.Red".
+        auto dot = name.find_last_of('.');
+        if (dot != std::string::npos) name = name.substr(dot + 1);
+        const reflection::EnumVal *val = nullptr;
+        for (auto it = enum_def.values()->begin();
+             it != enum_def.values()->end() && !val; ++it) {
+          if (it->name()->str() == name) val = *it;
+        }
+        if (!val) {
+          return Error("unknown enum value: " + name + " in " +
+                       enum_def.name()->str());
+        }
+        *i |= val->value();
+      }
+    } else {
+      return Error("expecting an integer");
+    }
+    return true;
+  }
+
+  // Checks that the integer i fits T, like the parser does. A UInt above the
+  // range of int64_t has wrapped around in i.
+  template<typename T> bool CheckRange(int64_t i, bool is_uint) {
+    const auto lo = (numeric_limits<T>::lowest)();
+    const auto hi = (numeric_limits<T>::max)();
+    if (is_uint ? static_cast<uint64_t>(i) <= static_cast<uint64_t>(hi)
+                : i >= static_cast<int64_t>(lo) &&
+                      (i < 0 ||
+                       static_cast<uint64_t>(i) <= static_cast<uint64_t>(hi))) {
+      return true;
+    }
+    return Error("invalid number: " +
+                 (is_uint ? NumToString(static_cast<uint64_t>(i))
+                          : NumToString(i)) +
+                 ", constant does not fit [" + NumToString(lo) + "; " +
+                 NumToString(hi) + "]");
+  }
+
+  bool ReadScalar(const flexbuffers::Reference &flex,
+                  const reflection::Type &type, reflection::BaseType base_type,
+                  int64_t *i, double *d) {
+    if (IsFloat(base_type)) {
+      if (!flex.IsNumeric()) return Error("expecting a float");
+      *d = flex.AsDouble();
+      return true;
+    }
+    if (!ReadInteger(flex, type.index(), i)) return false;
+    const auto is_uint = flex.IsUInt();
+    // clang-format off
+    switch (base_type) {
+      #define FLATBUFFERS_CHECK(ENUM, T) \
+        case reflection::ENUM: return CheckRange<T>(*i, is_uint);
+      FLATBUFFERS_CHECK(UType, uint8_t)
+      FLATBUFFERS_CHECK(Bool, uint8_t)
+      FLATBUFFERS_CHECK(Byte, int8_t)
+      FLATBUFFERS_CHECK(UByte, uint8_t)
+      FLATBUFFERS_CHECK(Short, int16_t)
+      FLATBUFFERS_CHECK(UShort, uint16_t)
+      FLATBUFFERS_CHECK(Int, int32_t)
+      FLATBUFFERS_CHECK(UInt, uint32_t)
+      FLATBUFFERS_CHECK(Long, int64_t)
+      FLATBUFFERS_CHECK(ULong, uint64_t)
+      #undef FLATBUFFERS_CHECK
+      default: FLATBUFFERS_ASSERT(0); return false;
+    }
+    // clang-format on
+  }
+
+  bool AddScalar(const reflection::Field &field,
+                 const flexbuffers::Reference &flex) {
+    const auto base_type = field.type()->base_type();
+    int64_t i = 0;
+    double d = 0;
+    if (!ReadScalar(flex, *field.type(), base_type, &i, &d)) return false;
+    // clang-format off
+    switch (base_type) {
+      #define FLATBUFFERS_ADD(ENUM, T) \
+        case reflection::ENUM: \
+          fbb_.AddElement<T>(field.offset(), \
+                             IsFloat(base_type) ? static_cast<T>(d) \
+                                                : static_cast<T>(i), \
+                             DefaultValue<T>(field)); \
+          break;
+      FLATBUFFERS_ADD(UType, uint8_t)
+      FLATBUFFERS_ADD(Bool, uint8_t)
+      FLATBUFFERS_ADD(Byte, int8_t)
+      FLATBUFFERS_ADD(UByte, uint8_t)
+      FLATBUFFERS_ADD(Short, int16_t)
+      FLATBUFFERS_ADD(UShort, uint16_t)
+      FLATBUFFERS_ADD(Int, int32_t)
+      FLATBUFFERS_ADD(UInt, uint32_t)
+      FLATBUFFERS_ADD(Long, int64_t)
+      FLATBUFFERS_ADD(ULong, uint64_t)
+      FLATBUFFERS_ADD(Float, float)
+      FLATBUFFERS_ADD(Double, double)
+      #undef FLATBUFFERS_ADD
+      default: FLATBUFFERS_ASSERT(0);
+    }
+    // clang-format on
+    return true;
+  }
+
+  // Stores a scalar at `data`, in a struct or a vector.
+  bool SetScalar(const flexbuffers::Reference &flex,
+                 const reflection::Type &type, reflection::BaseType base_type,
+                 uint8_t *data) {
+    int64_t i = 0;
+    double d = 0;
+    if (!ReadScalar(flex, type, base_type, &i, &d)) return false;
+    if (IsFloat(base_type)) {
+      SetAnyValueF(base_type, data, d);
+    } else {
+      SetAnyValueI(base_type, data, i);
+    }
+    return true;
+  }
+
+  // Fills in the zeroed `data` of a struct, which needs all of its fields.
+  bool ReadStruct(const reflection::Object &object,
+                  const flexbuffers::Reference &flex, uint8_t *data) {
+    if (!flex.IsMap()) return Error(object.name()->str() + ": expecting a map");
+    auto map = flex.AsMap();
+    if (map.size() != object.fields()->size()) {
+      return Error("wrong number of fields in struct " + object.name()->str());
+    }
+    for (auto it = object.fields()->begin(); it != object.fields()->end();
+         ++it) {
+      const auto &type = *it->type();
+      auto value = map[it->name()->c_str()];
+      auto field_data = data + it->offset();
+      if (value.IsNull()) {
+        return Error("missing field " + it->name()->str() + " in struct " +
+                     object.name()->str());
+      }
+      if (type.base_type() == reflection::Array) {
+        if (!value.IsAnyVector()) return Error("expecting an array");
+        FlexElements elems(value);
+        if (elems.size() != type.fixed_length()) {
+          return Error("wrong array length for " + it->name()->str());
+        }
+        auto elem_size = GetTypeSizeInline(type.element(), type.index(),
+                                           schema_);
+        for (size_t i = 0; i < elems.size(); i++) {
+          if (!ReadInline(elems[i], type, type.element(),
+                          field_data + i * elem_size))
+            return false;
+        }
+      } else if (!ReadInline(value, type, type.base_type(), field_data)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Writes a struct by itself, for a table or union.
+  bool PushStruct(const reflection::Object &object,
+                  const flexbuffers::Reference &flex) {
+    std::vector<uint8_t> data(object.bytesize());
+    if (!ReadStruct(object, flex, data.data())) return false;
+    fbb_.Align(object.minalign());
+    fbb_.PushBytes(data.data(), data.size());
+    return true;
+  }
+
+  // A scalar or struct, in a struct or vector.
+  bool ReadInline(const flexbuffers::Reference &flex,
+                  const reflection::Type &type, reflection::BaseType base_type,
+                  uint8_t *data) {
+    if (base_type == reflection::Obj) {
+      return ReadStruct(*schema_.objects()->Get(type.index()), flex, data);
+    }
+    return SetScalar(flex, type, base_type, data);
+  }
+
+  // The type of the union `field`, or of its element `i` for a vector of
+  // unions, from its "_type" field in `map`.
+  bool UnionType(const flexbuffers::Map &map, const reflection::Field &field,
+                 size_t i, const reflection::Type **type) {
+    auto type_name = field.name()->str() + UnionTypeFieldSuffix();
+    auto flex = map[type_name.c_str()];
+    if (field.type()->base_type() == reflection::Vector) {
+      if (!flex.IsAnyVector() || i >= FlexElements(flex).size()) {
+        return Error("missing union types: " + type_name);
+      }
+      flex = FlexElements(flex)[i];
+    }
+    if (flex.IsNull()) return Error("missing union type: " + type_name);
+    int64_t value;
+    if (!ReadInteger(flex, field.type()->index(), &value)) return false;
+    auto val =
+        schema_.enums()->Get(field.type()->index())->values()->LookupByKey(
+            value);
+    if (!val) return Error("unknown union type: " + type_name);
+    *type = val->union_type();
+    return true;
+  }
+
+  // Writes what an offset in a table or vector refers to.
+  bool ReadObject(const flexbuffers::Map &map, const reflection::Field &field,
+                  reflection::BaseType base_type, int32_t index, size_t i,
+                  const flexbuffers::Reference &flex, uoffset_t *offset) {
+    switch (base_type) {
+      case reflection::String:
+        if (!flex.IsString() && !flex.IsKey())
+          return Error("expecting a string: " + field.name()->str());
+        *offset = fbb_.CreateString(flex.AsString().c_str(),
+                                    flex.AsString().size())
+                      .o;
+        return true;
+      case reflection::Obj:
+        return ReadTable(*schema_.objects()->Get(index), flex, offset);
+      case reflection::Union: {
+        const reflection::Type *type = nullptr;
+        if (!UnionType(map, field, i, &type)) return false;
+        // NONE.
+        if (!type || type->base_type() == reflection::None) return true;
+        if (type->base_type() == reflection::Obj &&
+            schema_.objects()->Get(type->index())->is_struct()) {
+          if (!PushStruct(*schema_.objects()->Get(type->index()), flex))
+            return false;
+          *offset = fbb_.GetSize();
+          return true;
+        }
+        return ReadObject(map, field, type->base_type(), type->index(), i,
+                          flex, offset);
+      }
+      default: FLATBUFFERS_ASSERT(0); return false;
+    }
+  }
+
+  // Writes the value of a field that is stored by offset, if it is.
+  bool ReadReference(const reflection::Object &object,
+                     const flexbuffers::Map &map,
+                     const reflection::Field &field,
+                     const flexbuffers::Reference &flex, uoffset_t *offset) {
+    const auto &type = *field.type();
+    switch (type.base_type()) {
+      case reflection::Obj:
+        if (schema_.objects()->Get(type.index())->is_struct()) return true;
+        FLATBUFFERS_FALLTHROUGH();
+      case reflection::String:
+      case reflection::Union:
+        return ReadObject(map, field, type.base_type(), type.index(), 0, flex,
+                          offset);
+      case reflection::Vector:
+        return ReadVector(object, map, field, flex, offset);
+      default: return true;  // Inline.
+    }
+  }
+
+  bool ReadVector(const reflection::Object &object,
+                  const flexbuffers::Map &map, const reflection::Field &field,
+                  const flexbuffers::Reference &flex, uoffset_t *offset) {
+    const auto &type = *field.type();
+    const auto elem = type.element();
+    if (elem == reflection::UByte || elem == reflection::Byte) {
+      if (LookupAttribute(field.attributes(), "flexbuffer")) {
+        flexbuffers::Builder nested;
+        CopyFlexBuffer(flex, nested);
+        nested.Finish();
+        *offset = fbb_.CreateVector(nested.GetBuffer()).o;
+        return true;
+      }
+      if (auto name =
+              LookupAttribute(field.attributes(), "nested_flatbuffer")) {
+        if (flex.IsMap()) {
+          return ReadNested(object, field, name->value()->str(), flex,
+                            offset);
+        }
+      }
+      if (flex.IsBlob()) {
+        auto blob = flex.AsBlob();
+        *offset = fbb_.CreateVector(blob.data(), blob.size()).o;
+        return true;
+      }
+    }
+    if (!flex.IsAnyVector()) {
+      return Error("expecting a vector: " + field.name()->str());
+    }
+    FlexElements elems(flex);
+    auto len = elems.size();
+    if (elem == reflection::String || elem == reflection::Union ||
+        (elem == reflection::Obj &&
+         !schema_.objects()->Get(type.index())->is_struct())) {
+      std::vector<Offset<void>> offsets(len);
+      for (size_t i = 0; i < len; i++) {
+        if (!ReadObject(map, field, elem, type.index(), i, elems[i],
+                        &offsets[i].o))
+          return false;
+      }
+      *offset = fbb_.CreateVector(offsets).o;
+      return true;
+    }
+    // Scalars and structs.
+    auto elem_size = GetTypeSizeInline(elem, type.index(), schema_);
+    std::vector<uint8_t> data(len * elem_size);
+    for (size_t i = 0; i < len; i++) {
+      if (!ReadInline(elems[i], type, elem, data.data() + i * elem_size))
+        return false;
+    }
+    auto align = elem == reflection::Obj
+                     ? schema_.objects()->Get(type.index())->minalign()
+                     : elem_size;
+    fbb_.ForceVectorAlignment(len, elem_size, align);
+    fbb_.StartVector(len, elem_size);
+    fbb_.PushBytes(data.data(), data.size());
+    *offset = fbb_.EndVector(len);
+    return true;
+  }
+
+  bool ReadNested(const reflection::Object &object,
+                  const reflection::Field &field, const std::string &name,
+                  const flexbuffers::Reference &flex, uoffset_t *offset) {
+    auto nested_def = view_.LookupObject(name, Scope(object));
+    if (!nested_def) {
+      return Error("unknown nested_flatbuffer type: " + name + " in " +
+                   field.name()->str());
+    }
+    FlatBufferBuilder nested;
+    FlexBufferReader reader(view_, nested, error_);
+    uoffset_t root;
+    if (!reader.ReadTable(*nested_def, flex, &root)) return false;
+    nested.Finish(Offset<Table>(root));
+    fbb_.ForceVectorAlignment(nested.GetSize(), sizeof(uint8_t),
+                              nested.GetBufferMinAlignment());
+    *offset = fbb_.CreateVector(nested.GetBufferPointer(), nested.GetSize()).o;
+    return true;
+  }
+
+  const SchemaView &view_;
+  const reflection::Schema &schema_;
+  FlatBufferBuilder &fbb_;
+  std::string &error_;
+};
+
+// Writes a FlexBuffer with the same shape as the JSON for a FlatBuffer.
+class FlexBufferWriter {
+ public:
+  FlexBufferWriter(const SchemaView &view, flexbuffers::Builder &fbb)
+      : view_(view), schema_(*view.schema()), fbb_(fbb) {}
+
+  // Writes a table or struct as a map.
+  bool WriteObject(const reflection::Object &object, const uint8_t *val) {
+    auto table = reinterpret_cast<const Table *>(val);
+    auto start = fbb_.StartMap();
+    for (auto it = object.fields()->begin(); it != object.fields()->end();
+         ++it) {
+      const auto &field = **it;
+      auto field_val = object.is_struct() ? val + field.offset()
+                                          : table->GetAddressOf(field.offset());
+      if (!field_val) continue;
+      fbb_.Key(field.name()->c_str());
+      if (!WriteField(object, field, table, field_val)) return false;
+    }
+    fbb_.EndMap(start);
+    return true;
+  }
+
+ private:
+  void WriteScalar(const uint8_t *val, reflection::BaseType type) {
+    if (type == reflection::Bool) {
+      fbb_.Bool(*val != 0);
+    } else if (IsFloat(type)) {
+      fbb_.Double(GetAnyValueF(type, val));
+    } else if (type == reflection::ULong) {
+      fbb_.UInt(ReadScalar<uint64_t>(val));
+    } else {
+      fbb_.Int(GetAnyValueI(type, val));
+    }
+  }
+
+  // Writes what an offset refers to. union_type is the type of a union.
+  bool WriteReference(const uint8_t *val, reflection::BaseType type,
+                      int32_t index, const uint8_t *union_type) {
+    switch (type) {
+      case reflection::Union: {
+        if (!union_type || !*union_type) return false;
+        auto ev = schema_.enums()->Get(index)->values()->LookupByKey(
+            *union_type);
+        if (!ev) return false;
+        if (auto ut = ev->union_type()) {
+          return WriteReference(val, ut->base_type(), ut->index(), nullptr);
+        }
+        return ev->object() && WriteObject(*ev->object(), val);
+      }
+      case reflection::Obj:
+        return WriteObject(*schema_.objects()->Get(index), val);
+      case reflection::String: {
+        auto s = reinterpret_cast<const String *>(val);
+        fbb_.String(s->c_str(), s->size());
+        return true;
+      }
+      default: FLATBUFFERS_ASSERT(0); return false;
+    }
+  }
+
+  bool WriteElements(const uint8_t *data, size_t size,
+                     reflection::BaseType type, int32_t index,
+                     const Vector<uint8_t> *union_types) {
+    const auto object = type == reflection::Obj ? schema_.objects()->Get(index)
+                                                : nullptr;
+    auto start = fbb_.StartVector();
+    for (size_t i = 0; i < size; i++) {
+      if (IsScalar(type)) {
+        WriteScalar(data + i * GetTypeSize(type), type);
+      } else if (object && object->is_struct()) {
+        if (!WriteObject(*object, data + i * object->bytesize())) return false;
+      } else {
+        auto elem = data + i * sizeof(uoffset_t);
+        const uint8_t *union_type = nullptr;
+        if (type == reflection::Union) {
+          if (!union_types || i >= union_types->size()) return false;
+          union_type = union_types->Data() + i;
+        }
+        if (!WriteReference(elem + ReadScalar<uoffset_t>(elem), type, index,
+                            union_type))
+          return false;
+      }
+    }
+    // Scalars all have the same type, so they fit a typed vector.
+    fbb_.EndVector(start, IsScalar(type) && size, false);
+    return true;
+  }
+
+  bool WriteField(const reflection::Object &object,
+                  const reflection::Field &field, const Table *table,
+                  const uint8_t *val) {
+    const auto &type = *field.type();
+    const auto base_type = type.base_type();
+    if (IsScalar(base_type)) {
+      WriteScalar(val, base_type);
+      return true;
+    }
+    switch (base_type) {
+      case reflection::Obj:
+        if (schema_.objects()->Get(type.index())->is_struct()) {
+          return WriteObject(*schema_.objects()->Get(type.index()), val);
+        }
+        FLATBUFFERS_FALLTHROUGH();
+      case reflection::String:
+        return WriteReference(val + ReadScalar<uoffset_t>(val), base_type,
+                              type.index(), nullptr);
+      case reflection::Union: {
+        auto type_field = object.fields()->LookupByKey(
+            (field.name()->str() + UnionTypeFieldSuffix()).c_str());
+        auto union_type =
+            type_field ? table->GetAddressOf(type_field->offset()) : nullptr;
+        return WriteReference(val + ReadScalar<uoffset_t>(val), base_type,
+                              type.index(), union_type);
+      }
+      case reflection::Array:
+        return WriteElements(val, type.fixed_length(), type.element(),
+                             type.index(), nullptr);
+      case reflection::Vector: {
+        auto vec = reinterpret_cast<const Vector<uint8_t> *>(
+            val + ReadScalar<uoffset_t>(val));
+        if (LookupAttribute(field.attributes(), "flexbuffer")) {
+          CopyFlexBuffer(flexbuffers::GetRoot(vec->data(), vec->size()),
+                         fbb_);
+          return true;
+        }
+        if (auto nested =
+                LookupAttribute(field.attributes(), "nested_flatbuffer")) {
+          auto nested_def =
+              view_.LookupObject(nested->value()->str(), Scope(object));
+          return nested_def &&
+                 WriteObject(*nested_def, GetRoot<uint8_t>(vec->data()));
+        }
+        const Vector<uint8_t> *union_types = nullptr;
+        if (type.element() == reflection::Union) {
+          auto type_field = object.fields()->LookupByKey(
+              (field.name()->str() + UnionTypeFieldSuffix()).c_str());
+          if (type_field) {
+            union_types = table->GetPointer<const Vector<uint8_t> *>(
+                type_field->offset());
+          }
+        }
+        return WriteElements(vec->Data(), vec->size(), type.element(),
+                             type.index(), union_types);
+      }
+      default: FLATBUFFERS_ASSERT(0); return false;
+    }
+  }
+
+  const SchemaView &view_;
+  const reflection::Schema &schema_;
+  flexbuffers::Builder &fbb_;
+};
+
+}  // namespace
+
+bool SchemaView::Init(const uint8_t *buf, size_t size) {
+  schema_ = nullptr;
+  Verifier verifier(buf, size);
+  if (!reflection::VerifySchemaBuffer(verifier)) return false;
+  schema_ = reflection::GetSchema(buf);
+  return true;
+}
+
+bool SchemaView::InitUnverified(const uint8_t *buf, size_t size) {
+  schema_ = nullptr;
+  if (size < sizeof(uoffset_t) + FlatBufferBuilder::kFileIdentifierLength ||
+      !reflection::SchemaBufferHasIdentifier(buf)) {
+    return false;
+  }
+  schema_ = reflection::GetSchema(buf);
+  return true;
+}
+
+const reflection::Object *SchemaView::LookupObject(
+    const std::string &name, const std::string &scope) const {
+  return schema_ ? LookupScoped(*schema_->objects(), name, scope) : nullptr;
+}
+
+const reflection::Enum *SchemaView::LookupEnum(const std::string &name,
+                                               const std::string &scope) const {
+  return schema_ ? LookupScoped(*schema_->enums(), name, scope) : nullptr;
+}
+
+const reflection::Object *SchemaView::NestedFlatBuffer(
+    const reflection::Object &object, const reflection::Field &field) const {
+  auto nested = LookupAttribute(field.attributes(), "nested_flatbuffer");
+  // The type is named as in the schema the field is declared in.
+  return nested ? LookupObject(nested->value()->str(), Scope(object)) : nullptr;
+}
+
+bool SchemaView::FlexBufferToFlatBuffer(const flexbuffers::Reference &flex,
+                                        FlatBufferBuilder *fbb,
+                                        std::string *error) const {
+  auto root = RootTable();
+  if (!root) {
+    *error = "no root type set";
+    return false;
+  }
+  return FlexBufferToFlatBuffer(*root, flex, fbb, error);
+}
+
+bool SchemaView::FlexBufferToFlatBuffer(const reflection::Object &object,
+                                        const flexbuffers::Reference &flex,
+                                        FlatBufferBuilder *fbb,
+                                        std::string *error) const {
+  FLATBUFFERS_ASSERT(schema_);
+  FlexBufferReader reader(*this, *fbb, *error);
+  uoffset_t root;
+  if (!reader.ReadTable(object, flex, &root)) return false;
+  auto ident = schema_->file_ident();
+  fbb->Finish(Offset<Table>(root),
+              ident && ident->size() ? ident->c_str() : nullptr);
+  return true;
+}
+
+bool SchemaView::FlatBufferToFlexBuffer(const void *flatbuffer,
+                                        flexbuffers::Builder *flex) const {
+  auto root = RootTable();
+  return root && FlatBufferToFlexBuffer(*root, GetRoot<Table>(flatbuffer),
+                                        flex);
+}
+
+bool SchemaView::FlatBufferToFlexBuffer(const reflection::Object &object,
+                                        const Table *table,
+                                        flexbuffers::Builder *flex) const {
+  FLATBUFFERS_ASSERT(schema_);
+  FlexBufferWriter writer(*this, *flex);
+  if (!writer.WriteObject(object, reinterpret_cast<const uint8_t *>(table)))
+    return false;
+  flex->Finish();
+  return true;
+}
+
 }  // namespace flatbuffers
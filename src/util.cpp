@@ -34,6 +34,9 @@
 #else
 #  define _XOPEN_SOURCE 600 // For PATH_MAX from limits.h (SUSv2 extension) 
 #  include <limits.h>
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <unistd.h>
 #endif
 // clang-format on
 
@@ -71,8 +74,28 @@ bool LoadFileRaw(const char *name, bool binary, std::string *buf) {
   return !ifs.bad();
 }
 
+static bool SaveFileRaw(const char *name, const char *buf, size_t len,
+                        bool binary) {
+  std::ofstream ofs(name, binary ? std::ofstream::binary : std::ofstream::out);
+  if (!ofs.is_open()) return false;
+  ofs.write(buf, len);
+  return !ofs.bad();
+}
+
+static bool SaveTempFileRaw(const char *tmp_name, const char *name,
+                            bool binary) {
+  (void)binary;
+  // rename() doesn't replace an existing file everywhere.
+  if (!rename(tmp_name, name)) return true;
+  if (!remove(name) && !rename(tmp_name, name)) return true;
+  remove(tmp_name);
+  return false;
+}
+
 static LoadFileFunction g_load_file_function = LoadFileRaw;
 static FileExistsFunction g_file_exists_function = FileExistsRaw;
+static SaveFileFunction g_save_file_function = SaveFileRaw;
+static SaveTempFileFunction g_save_temp_file_function = SaveTempFileRaw;
 
 bool LoadFile(const char *name, bool binary, std::string *buf) {
   FLATBUFFERS_ASSERT(g_load_file_function);
@@ -114,11 +137,70 @@ FileExistsFunction SetFileExistsFunction(
   return previous_function;
 }
 
+SaveFileFunction SetSaveFileFunction(SaveFileFunction save_file_function) {
+  SaveFileFunction previous_function = g_save_file_function;
+  g_save_file_function = save_file_function ? save_file_function : SaveFileRaw;
+  return previous_function;
+}
+
+SaveTempFileFunction SetSaveTempFileFunction(
+    SaveTempFileFunction save_temp_file_function) {
+  SaveTempFileFunction previous_function = g_save_temp_file_function;
+  g_save_temp_file_function =
+      save_temp_file_function ? save_temp_file_function : SaveTempFileRaw;
+  return previous_function;
+}
+
 bool SaveFile(const char *name, const char *buf, size_t len, bool binary) {
-  std::ofstream ofs(name, binary ? std::ofstream::binary : std::ofstream::out);
-  if (!ofs.is_open()) return false;
-  ofs.write(buf, len);
-  return !ofs.bad();
+  FLATBUFFERS_ASSERT(g_save_file_function);
+  return g_save_file_function(name, buf, len, binary);
+}
+
+bool SaveTempFile(const char *tmp_name, const char *name, bool binary) {
+  FLATBUFFERS_ASSERT(g_save_temp_file_function);
+  return g_save_temp_file_function(tmp_name, name, binary);
+}
+
+bool MappedFile::Open(const char *name) {
+  Close();
+  // clang-format off
+  #ifndef _WIN32
+    // Files read through a custom LoadFile function can't be mapped.
+    if (g_load_file_function == LoadFileRaw && !DirExists(name)) {
+      auto fd = open(name, O_RDONLY);
+      if (fd < 0) return false;
+      struct stat file_info;
+      if (fstat(fd, &file_info) == 0 && file_info.st_size > 0) {
+        auto size = static_cast<size_t>(file_info.st_size);
+        auto addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr != MAP_FAILED) {
+          close(fd);
+          data_ = static_cast<const uint8_t *>(addr);
+          size_ = size;
+          mapped_ = true;
+          return true;
+        }
+      }
+      close(fd);
+    }
+  #endif
+  // clang-format on
+  if (!LoadFile(name, true, &contents_)) return false;
+  data_ = reinterpret_cast<const uint8_t *>(contents_.data());
+  size_ = contents_.size();
+  return true;
+}
+
+void MappedFile::Close() {
+  // clang-format off
+  #ifndef _WIN32
+    if (mapped_) munmap(const_cast<uint8_t *>(data_), size_);
+  #endif
+  // clang-format on
+  contents_.clear();
+  data_ = nullptr;
+  size_ = 0;
+  mapped_ = false;
 }
 
 // We internally store paths in posix format ('/'). Paths supplied
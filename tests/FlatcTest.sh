@@ -0,0 +1,167 @@
+#!/bin/bash -eu
+#
+# Copyright 2020 Google Inc. All rights reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Tests of flatc command line modes that need more than one process.
+# Usage: FlatcTest.sh [path to flatc]
+
+test_dir="$(cd "$(dirname $0)" && pwd)"
+flatc="${1:-$test_dir/../flatc}"
+flatc="$(cd "$(dirname "$flatc")" && pwd)/$(basename "$flatc")"
+cd "$test_dir"
+work_dir="$(mktemp -d)"
+server_pid=
+cleanup() {
+  if [ -n "$server_pid" ]; then kill $server_pid 2>/dev/null || true; fi
+  rm -rf "$work_dir"
+}
+trap cleanup EXIT
+
+fail() {
+  echo "FlatcTest: $*" >&2
+  exit 1
+}
+
+schema_args="--cpp --gen-object-api -I include_test monster_test.fbs"
+
+# --server and --connect: the same schema compiled twice through a server,
+# the second time from its cache, matches a local compile.
+"$flatc" -o "$work_dir/local" $schema_args
+socket="$work_dir/flatc.sock"
+"$flatc" --server "$socket" &
+server_pid=$!
+for i in $(seq 100); do
+  [ -S "$socket" ] && break
+  sleep 0.1
+done
+[ -S "$socket" ] || fail "server did not start"
+for run in 1 2; do
+  rm -rf "$work_dir/served"
+  "$flatc" --connect "$socket" -o "$work_dir/served" $schema_args ||
+    fail "served compile $run failed"
+  diff -r "$work_dir/local" "$work_dir/served" >/dev/null ||
+    fail "served compile $run differs from a local compile"
+done
+# Errors come back with the client's exit status and output.
+status=0
+output="$("$flatc" --connect "$socket" --cpp -o "$work_dir/bad" \
+          no_such_file.fbs)" || status=$?
+[ $status -ne 0 ] || fail "a failed served compile exited with 0"
+case "$output" in
+  *"error: unable to load file: no_such_file.fbs"*) ;;
+  *) fail "unexpected output from a failed served compile: $output" ;;
+esac
+# Two schemas that include the same file share one parse of it, until it
+# changes. The binary schemas hold the included definitions.
+mkdir "$work_dir/shared"
+echo "namespace S; table Shared { a:int; }" > "$work_dir/shared/shared.fbs"
+for name in a b; do
+  echo "include \"shared.fbs\"; table T$name { s:S.Shared; }" \
+    > "$work_dir/shared/$name.fbs"
+done
+shared_args="--cpp -b --schema $work_dir/shared/a.fbs $work_dir/shared/b.fbs"
+stats() {
+  "$flatc" --connect "$socket" --server-stats | sed 's/, cached.*//'
+}
+# The includes of monster_test.fbs above were parsed once, and reused once.
+parsed_before="$(stats)"
+for run in 1 2; do
+  rm -rf "$work_dir/shared/local" "$work_dir/shared/served"
+  "$flatc" -o "$work_dir/shared/local" $shared_args ||
+    fail "local compile of shared includes failed"
+  "$flatc" --connect "$socket" -o "$work_dir/shared/served" $shared_args ||
+    fail "served compile of shared includes failed"
+  diff -r "$work_dir/shared/local" "$work_dir/shared/served" >/dev/null ||
+    fail "served compile $run of shared includes differs from a local one"
+  echo "namespace S; table Shared { b:int; }" > "$work_dir/shared/shared.fbs"
+done
+[ "$parsed_before" = "includes parsed: 1, reused: 1" ] ||
+  fail "unexpected server stats: $parsed_before"
+[ "$(stats)" = "includes parsed: 3, reused: 3" ] ||
+  fail "shared includes were not parsed once per change: $(stats)"
+kill $server_pid
+wait $server_pid 2>/dev/null || true
+server_pid=
+# Without a server, --connect compiles locally.
+"$flatc" --connect "$socket" -o "$work_dir/unserved" $schema_args ||
+  fail "compile without a server failed"
+diff -r "$work_dir/local" "$work_dir/unserved" >/dev/null ||
+  fail "compile without a server differs from a local compile"
+
+# --cache-manifest: a second run with nothing changed skips the schema and
+# touches neither the generated files nor the manifest.
+manifest="$work_dir/cache.manifest"
+cached_args="-o $work_dir/cached --cache-manifest $manifest $schema_args"
+"$flatc" $cached_args || fail "cached compile failed"
+diff -r "$work_dir/local" "$work_dir/cached" >/dev/null ||
+  fail "cached compile differs from a local compile"
+[ -f "$manifest" ] || fail "no cache manifest was written"
+touch -t 200001010000 "$manifest" "$work_dir"/cached/*
+touch -t 200001010001 "$work_dir/marker"
+"$flatc" $cached_args || fail "second cached compile failed"
+newer="$(find "$work_dir/cached" "$manifest" -type f -newer "$work_dir/marker")"
+[ -z "$newer" ] ||
+  fail "second cached compile rewrote files"
+# A changed output is regenerated.
+echo "// edited" >> "$work_dir"/cached/monster_test_generated.h
+"$flatc" $cached_args || fail "cached compile after an edit failed"
+diff -r "$work_dir/local" "$work_dir/cached" >/dev/null ||
+  fail "cached compile did not restore an edited file"
+# A manifest that isn't one is ignored.
+echo "not a manifest" > "$manifest"
+rm -rf "$work_dir/cached"
+"$flatc" $cached_args || fail "cached compile with a bad manifest failed"
+diff -r "$work_dir/local" "$work_dir/cached" >/dev/null ||
+  fail "cached compile with a bad manifest differs from a local compile"
+
+# --skip-unchanged: identical outputs are left alone.
+"$flatc" -o "$work_dir/skip" --skip-unchanged $schema_args ||
+  fail "compile with --skip-unchanged failed"
+touch -t 200001010000 "$work_dir"/skip/*
+"$flatc" -o "$work_dir/skip" --skip-unchanged $schema_args ||
+  fail "second compile with --skip-unchanged failed"
+[ -z "$(find "$work_dir/skip" -type f -newer "$work_dir/marker")" ] ||
+  fail "--skip-unchanged rewrote identical files"
+diff -r "$work_dir/local" "$work_dir/skip" >/dev/null ||
+  fail "compile with --skip-unchanged differs from a local compile"
+
+# JSON text output is skipped and cached the same way.
+json_args="-t -I include_test monster_test.fbs monsterdata_test.golden"
+"$flatc" -o "$work_dir/json" $json_args || fail "JSON compile failed"
+"$flatc" -o "$work_dir/json_skip" --skip-unchanged $json_args ||
+  fail "JSON compile with --skip-unchanged failed"
+diff -r "$work_dir/json" "$work_dir/json_skip" >/dev/null ||
+  fail "JSON compile with --skip-unchanged differs from a plain one"
+touch -t 200001010000 "$work_dir"/json_skip/*
+"$flatc" -o "$work_dir/json_skip" --skip-unchanged $json_args ||
+  fail "second JSON compile with --skip-unchanged failed"
+[ -z "$(find "$work_dir/json_skip" -type f -newer "$work_dir/marker")" ] ||
+  fail "--skip-unchanged rewrote identical JSON"
+json_manifest="$work_dir/json.manifest"
+"$flatc" -o "$work_dir/json_cached" --cache-manifest "$json_manifest" \
+  $json_args || fail "cached JSON compile failed"
+touch -t 200001010000 "$json_manifest" "$work_dir"/json_cached/*
+"$flatc" -o "$work_dir/json_cached" --cache-manifest "$json_manifest" \
+  $json_args || fail "second cached JSON compile failed"
+[ -z "$(find "$work_dir/json_cached" "$json_manifest" -type f \
+        -newer "$work_dir/marker")" ] ||
+  fail "second cached JSON compile rewrote files"
+echo "// edited" >> "$work_dir"/json_cached/monsterdata_test.json
+"$flatc" -o "$work_dir/json_cached" --cache-manifest "$json_manifest" \
+  $json_args || fail "cached JSON compile after an edit failed"
+diff -r "$work_dir/json" "$work_dir/json_cached" >/dev/null ||
+  fail "cached JSON compile did not restore an edited file"
+
+echo "FlatcTest: OK"
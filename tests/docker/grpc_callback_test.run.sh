@@ -0,0 +1,16 @@
+set -e
+
+# The code generated with --grpc-callback-api needs a newer gRPC than
+# grpc/build_grpc.sh builds, so this uses the one the image comes with.
+echo ""
+echo "Build the gRPC callback API test with gRPC $(pkg-config --modversion grpc++)"
+
+g++ -std=c++14 -Wall -Wno-unused-parameter \
+  -Iinclude -Itests/grpc_callback -Itests \
+  grpc/tests/grpc_callback_test.cpp \
+  tests/grpc_callback/monster_test.grpc.fb.cc \
+  tests/test_assert.cpp src/util.cpp \
+  $(pkg-config --cflags --libs grpc++) -o grpc_callback_test
+./grpc_callback_test
+
+echo "gRPC callback API test done"
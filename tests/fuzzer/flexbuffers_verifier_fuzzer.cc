@@ -0,0 +1,14 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+#include "flatbuffers/flexbuffers.h"
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+  if (flexbuffers::VerifyBuffer(data, size)) {
+    // A verified buffer must be safe to read without further checks.
+    std::string json;
+    flexbuffers::GetRoot(data, size).ToString(true, true, json);
+  }
+  return 0;
+}
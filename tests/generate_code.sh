@@ -54,6 +54,11 @@ $TEST_NOINCL_FLAGS $TEST_CPP_FLAGS $TEST_CS_FLAGS -o namespace_test namespace_te
 ../flatc --python $TEST_BASE_FLAGS arrays_test.fbs
 ../flatc --dart monster_extra.fbs
 
+# The gRPC C++ callback API, for grpc/tests/grpc_callback_test.cpp. Only the
+# gRPC files are kept, they use the monster_test_generated.h above.
+../flatc --cpp --grpc --grpc-callback-api $TEST_NOINCL_FLAGS $TEST_CPP_FLAGS -I include_test -o grpc_callback monster_test.fbs
+rm grpc_callback/monster_test_generated.h
+
 # Moves the swift generated code into the swift directory
 mv *generated.swift FlatBuffers.Test.Swift/Tests/FlatBuffers.Test.SwiftTests
 mv ./union_vector/*_generated.swift FlatBuffers.Test.Swift/Tests/FlatBuffers.Test.SwiftTests
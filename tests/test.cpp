@@ -18,6 +18,7 @@
 #include "flatbuffers/flatbuffers.h"
 #include "flatbuffers/idl.h"
 #include "flatbuffers/minireflect.h"
+#include "flatbuffers/query.h"
 #include "flatbuffers/registry.h"
 #include "flatbuffers/util.h"
 
@@ -255,6 +256,16 @@ void AccessFlatBufferTest(const uint8_t *flatbuf, size_t length,
   #endif
   // clang-format on
 
+  // Verifying just the root table, leaving the rest to be verified when read.
+  flatbuffers::Verifier lazy_verifier(flatbuf, length);
+  lazy_verifier.SetLazyDepth(1);
+  TEST_EQ(VerifyMonsterBuffer(lazy_verifier), true);
+  TEST_EQ(lazy_verifier.GetNumTables(), 1);
+  TEST_EQ(verifier.GetNumTables() > 1, true);
+  auto table = GetMonster(flatbuf)->testarrayoftables()->Get(0);
+  flatbuffers::Verifier table_verifier(flatbuf, length);
+  TEST_EQ(table_verifier.VerifyTable(table), true);
+
   TEST_EQ(strcmp(MonsterIdentifier(), "MONS"), 0);
   TEST_EQ(MonsterBufferHasIdentifier(flatbuf), true);
   TEST_EQ(strcmp(MonsterExtension(), "mon"), 0);
@@ -1046,6 +1057,332 @@ void ReflectionTest(uint8_t *flatbuf, size_t length) {
           true);
 }
 
+void SchemaViewTest() {
+  flatbuffers::MappedFile bfbsfile;
+  TEST_EQ(bfbsfile.Open((test_data_path + "monster_test.bfbs").c_str()), true);
+  flatbuffers::SchemaView view;
+  TEST_EQ(view.Init(bfbsfile.data(), bfbsfile.size()), true);
+  TEST_EQ_STR(view.RootTable()->name()->c_str(), "MyGame.Example.Monster");
+  TEST_EQ(view.LookupObject("MyGame.Example.Monster"), view.RootTable());
+  TEST_EQ(view.LookupObject("Monster", "MyGame.Example"), view.RootTable());
+  TEST_EQ_STR(view.LookupObject("InParentNamespace", "MyGame.Example")
+                  ->name()
+                  ->c_str(),
+              "MyGame.InParentNamespace");
+  TEST_EQ(view.LookupObject("Monster") == nullptr, true);
+  TEST_EQ_STR(view.LookupEnum("Color", "MyGame.Example")->name()->c_str(),
+              "MyGame.Example.Color");
+  auto hp = flatbuffers::SchemaView::LookupField(*view.RootTable(), "hp");
+  TEST_NOTNULL(hp);
+  TEST_EQ(hp->id(), 2);
+
+  // Text generated with the view matches that of a Parser for the schema.
+  std::string schemafile;
+  std::string jsonfile;
+  TEST_EQ(flatbuffers::LoadFile((test_data_path + "monster_test.fbs").c_str(),
+                                false, &schemafile),
+          true);
+  TEST_EQ(flatbuffers::LoadFile(
+              (test_data_path + "monsterdata_test.golden").c_str(), false,
+              &jsonfile),
+          true);
+  auto include_test_path =
+      flatbuffers::ConCatPathFileName(test_data_path, "include_test");
+  const char *include_directories[] = { test_data_path.c_str(),
+                                        include_test_path.c_str(), nullptr };
+  flatbuffers::IDLOptions opts;
+  opts.binary_schema_builtins = true;
+  flatbuffers::Parser parser(opts);
+  TEST_EQ(parser.Parse(schemafile.c_str(), include_directories), true);
+  TEST_EQ(parser.Parse(jsonfile.c_str(), include_directories), true);
+  flatbuffers::Parser schema_parser(opts);
+  TEST_EQ(schema_parser.Parse(schemafile.c_str(), include_directories), true);
+  schema_parser.Serialize();
+  TEST_EQ(view.Init(schema_parser.builder_.GetBufferPointer(),
+                    schema_parser.builder_.GetSize()),
+          true);
+  flatbuffers::SchemaView::TextOptions text_opts;
+  for (int i = 0; i < 2; i++) {
+    std::string expected;
+    std::string text;
+    TEST_EQ(GenerateText(parser, parser.builder_.GetBufferPointer(), &expected),
+            true);
+    TEST_EQ(view.GenerateText(parser.builder_.GetBufferPointer(), text_opts,
+                              &text),
+            true);
+    TEST_EQ_STR(text.c_str(), expected.c_str());
+    parser.opts.strict_json = text_opts.strict_json = true;
+    parser.opts.output_default_scalars_in_json =
+        text_opts.output_default_scalars_in_json = true;
+    parser.opts.indent_step = text_opts.indent_step = -1;
+  }
+
+  // Unions of structs, vectors of unions, arrays and flags.
+  opts.lang_to_generate = flatbuffers::IDLOptions::kCpp;
+  flatbuffers::Parser union_parser(opts);
+  TEST_EQ(union_parser.Parse(
+              "namespace N; enum F:ubyte (bit_flags) { A, B }"
+              "struct S { a:[int:2]; f:F; } table T { s:string; }"
+              "union U { T, S } table R { u:U; us:[U]; ss:[S]; f:F = A; }"
+              "root_type R;"
+              "{ u_type: S, u: { a: [1, 2], f: \"A B\" },"
+              "  us_type: [T, S], us: [{ s: \"x\" }, { a: [3, 4], f: B }],"
+              "  ss: [{ a: [5, 6], f: A }], f: 3 }"),
+          true);
+  flatbuffers::Parser union_schema_parser(opts);
+  TEST_EQ(union_schema_parser.Parse(
+              "namespace N; enum F:ubyte (bit_flags) { A, B }"
+              "struct S { a:[int:2]; f:F; } table T { s:string; }"
+              "union U { T, S } table R { u:U; us:[U]; ss:[S]; f:F = A; }"
+              "root_type R;"),
+          true);
+  union_schema_parser.Serialize();
+  TEST_EQ(view.Init(union_schema_parser.builder_.GetBufferPointer(),
+                    union_schema_parser.builder_.GetSize()),
+          true);
+  std::string expected;
+  std::string text;
+  TEST_EQ(GenerateText(union_parser, union_parser.builder_.GetBufferPointer(),
+                       &expected),
+          true);
+  TEST_EQ(view.GenerateText(union_parser.builder_.GetBufferPointer(),
+                            flatbuffers::SchemaView::TextOptions(), &text),
+          true);
+  TEST_EQ_STR(text.c_str(), expected.c_str());
+}
+
+void FlexBuffersTranscodeTest() {
+  std::string schemafile;
+  std::string jsonfile;
+  TEST_EQ(flatbuffers::LoadFile((test_data_path + "monster_test.fbs").c_str(),
+                                false, &schemafile),
+          true);
+  TEST_EQ(flatbuffers::LoadFile(
+              (test_data_path + "monsterdata_test.golden").c_str(), false,
+              &jsonfile),
+          true);
+  auto include_test_path =
+      flatbuffers::ConCatPathFileName(test_data_path, "include_test");
+  const char *include_directories[] = { test_data_path.c_str(),
+                                        include_test_path.c_str(), nullptr };
+  // The nested_flatbuffer and flexbuffer attributes have to be in the schema.
+  flatbuffers::IDLOptions opts;
+  opts.binary_schema_builtins = true;
+  flatbuffers::Parser parser(opts);
+  TEST_EQ(parser.Parse(schemafile.c_str(), include_directories), true);
+  TEST_EQ(parser.Parse(jsonfile.c_str(), include_directories), true);
+  flatbuffers::Parser schema_parser(opts);
+  TEST_EQ(schema_parser.Parse(schemafile.c_str(), include_directories), true);
+  schema_parser.Serialize();
+  flatbuffers::SchemaView view;
+  TEST_EQ(view.Init(schema_parser.builder_.GetBufferPointer(),
+                    schema_parser.builder_.GetSize()),
+          true);
+  std::string expected;
+  TEST_EQ(GenerateText(parser, parser.builder_.GetBufferPointer(), &expected),
+          true);
+
+  // FlatBuffer to FlexBuffer and back.
+  flexbuffers::Builder flex;
+  TEST_EQ(view.FlatBufferToFlexBuffer(parser.builder_.GetBufferPointer(),
+                                      &flex),
+          true);
+  auto root = flexbuffers::GetRoot(flex.GetBuffer()).AsMap();
+  TEST_EQ(root["hp"].AsInt32(), 80);
+  TEST_EQ_STR(root["testnestedflatbuffer"].AsMap()["name"].AsString().c_str(),
+              "NestedMonster");
+  TEST_EQ(root["flex"].AsInt32(), 1234);
+  flatbuffers::FlatBufferBuilder fbb;
+  std::string error;
+  TEST_EQ(view.FlexBufferToFlatBuffer(flexbuffers::GetRoot(flex.GetBuffer()),
+                                      &fbb, &error),
+          true);
+  flatbuffers::Verifier verifier(fbb.GetBufferPointer(), fbb.GetSize());
+  TEST_EQ(VerifyMonsterBuffer(verifier), true);
+  std::string text;
+  TEST_EQ(GenerateText(parser, fbb.GetBufferPointer(), &text), true);
+  TEST_EQ_STR(text.c_str(), expected.c_str());
+
+  // The FlexBuffer made of the JSON, with enums and union types by name.
+  flexbuffers::Builder json_flex;
+  flatbuffers::Parser flex_parser;
+  TEST_EQ(flex_parser.ParseFlexBuffer(jsonfile.c_str(), nullptr, &json_flex),
+          true);
+  fbb.Clear();
+  TEST_EQ(view.FlexBufferToFlatBuffer(
+              flexbuffers::GetRoot(json_flex.GetBuffer()), &fbb, &error),
+          true);
+  text.clear();
+  TEST_EQ(GenerateText(parser, fbb.GetBufferPointer(), &text), true);
+  TEST_EQ_STR(text.c_str(), expected.c_str());
+
+  // FlexBuffers that don't fit the schema.
+  flexbuffers::Builder bad;
+  bad.Map([&]() {
+    bad.String("name", "x");
+    bad.String("nope", "x");
+  });
+  bad.Finish();
+  fbb.Clear();
+  TEST_EQ(view.FlexBufferToFlatBuffer(flexbuffers::GetRoot(bad.GetBuffer()),
+                                      &fbb, &error),
+          false);
+  TEST_EQ_STR(error.c_str(), "unknown field: nope");
+  bad.Clear();
+  bad.Map([&]() { bad.Int("hp", 1); });
+  bad.Finish();
+  fbb.Clear();
+  TEST_EQ(view.FlexBufferToFlatBuffer(flexbuffers::GetRoot(bad.GetBuffer()),
+                                      &fbb, &error),
+          false);
+  bad.Clear();
+  bad.Map([&]() {
+    bad.String("name", "x");
+    bad.Float("hp", 1.5f);
+  });
+  bad.Finish();
+  fbb.Clear();
+  TEST_EQ(view.FlexBufferToFlatBuffer(flexbuffers::GetRoot(bad.GetBuffer()),
+                                      &fbb, &error),
+          false);
+  // Integers the field type can't hold, in a table field, a struct field and
+  // a vector element, are rejected like the parser rejects them.
+  bad.Clear();
+  bad.Map([&]() {
+    bad.String("name", "x");
+    bad.Int("hp", 100000);
+  });
+  bad.Finish();
+  fbb.Clear();
+  TEST_EQ(view.FlexBufferToFlatBuffer(flexbuffers::GetRoot(bad.GetBuffer()),
+                                      &fbb, &error),
+          false);
+  TEST_EQ_STR(error.c_str(),
+              "invalid number: 100000, constant does not fit [-32768; 32767]");
+  bad.Clear();
+  bad.Map([&]() {
+    bad.String("name", "x");
+    bad.Map("pos", [&]() {
+      bad.Float("x", 1);
+      bad.Float("y", 2);
+      bad.Float("z", 3);
+      bad.Float("test1", 4);
+      bad.Int("test2", -1);
+      bad.Map("test3", [&]() {
+        bad.Int("a", 5);
+        bad.Int("b", 6);
+      });
+    });
+  });
+  bad.Finish();
+  fbb.Clear();
+  TEST_EQ(view.FlexBufferToFlatBuffer(flexbuffers::GetRoot(bad.GetBuffer()),
+                                      &fbb, &error),
+          false);
+  TEST_EQ_STR(error.c_str(),
+              "invalid number: -1, constant does not fit [0; 255]");
+  bad.Clear();
+  bad.Map([&]() {
+    bad.String("name", "x");
+    bad.Vector("inventory", [&]() {
+      bad.Int(255);
+      bad.Int(-1);
+    });
+  });
+  bad.Finish();
+  fbb.Clear();
+  TEST_EQ(view.FlexBufferToFlatBuffer(flexbuffers::GetRoot(bad.GetBuffer()),
+                                      &fbb, &error),
+          false);
+  TEST_EQ_STR(error.c_str(),
+              "invalid number: -1, constant does not fit [0; 255]");
+  bad.Clear();
+  bad.Map([&]() {
+    bad.String("name", "x");
+    bad.UInt("hp", 0xFFFFFFFFFFFFFFFFULL);
+  });
+  bad.Finish();
+  fbb.Clear();
+  TEST_EQ(view.FlexBufferToFlatBuffer(flexbuffers::GetRoot(bad.GetBuffer()),
+                                      &fbb, &error),
+          false);
+  // The edges of the range are fine.
+  bad.Clear();
+  bad.Map([&]() {
+    bad.String("name", "x");
+    bad.Int("hp", -32768);
+    bad.Int("mana", 32767);
+    bad.Vector("inventory", [&]() {
+      bad.Int(0);
+      bad.UInt(255);
+    });
+    bad.UInt("testhashu64_fnv1", 0xFFFFFFFFFFFFFFFFULL);
+    bad.Int("testhashs64_fnv1", -0x7FFFFFFFFFFFFFFFLL - 1);
+  });
+  bad.Finish();
+  fbb.Clear();
+  TEST_EQ(view.FlexBufferToFlatBuffer(flexbuffers::GetRoot(bad.GetBuffer()),
+                                      &fbb, &error),
+          true);
+  auto edges = MyGame::Example::GetMonster(fbb.GetBufferPointer());
+  TEST_EQ(edges->hp(), -32768);
+  TEST_EQ(edges->mana(), 32767);
+  TEST_EQ(edges->inventory()->Get(1), 255);
+  TEST_EQ(edges->testhashu64_fnv1(), 0xFFFFFFFFFFFFFFFFULL);
+
+  // Unions of structs, vectors of unions, arrays and flags.
+  const char *union_schema =
+      "namespace N; enum F:ubyte (bit_flags) { A, B }"
+      "struct S { a:[int:2]; f:F; } table T { s:string; }"
+      "union U { T, S } table R { u:U; us:[U]; ss:[S]; f:F = A; }"
+      "root_type R;";
+  const char *union_json =
+      "{ u_type: S, u: { a: [1, 2], f: \"A B\" },"
+      "  us_type: [T, S], us: [{ s: \"x\" }, { a: [3, 4], f: B }],"
+      "  ss: [{ a: [5, 6], f: A }], f: 3 }";
+  opts.lang_to_generate = flatbuffers::IDLOptions::kCpp;
+  flatbuffers::Parser union_parser(opts);
+  TEST_EQ(union_parser.Parse(union_schema), true);
+  TEST_EQ(union_parser.Parse(union_json), true);
+  flatbuffers::Parser union_schema_parser(opts);
+  TEST_EQ(union_schema_parser.Parse(union_schema), true);
+  union_schema_parser.Serialize();
+  TEST_EQ(view.Init(union_schema_parser.builder_.GetBufferPointer(),
+                    union_schema_parser.builder_.GetSize()),
+          true);
+  expected.clear();
+  TEST_EQ(GenerateText(union_parser, union_parser.builder_.GetBufferPointer(),
+                       &expected),
+          true);
+  flex.Clear();
+  TEST_EQ(view.FlatBufferToFlexBuffer(union_parser.builder_.GetBufferPointer(),
+                                      &flex),
+          true);
+  fbb.Clear();
+  TEST_EQ(view.FlexBufferToFlatBuffer(flexbuffers::GetRoot(flex.GetBuffer()),
+                                      &fbb, &error),
+          true);
+  text.clear();
+  TEST_EQ(GenerateText(union_parser, fbb.GetBufferPointer(), &text), true);
+  TEST_EQ_STR(text.c_str(), expected.c_str());
+  json_flex.Clear();
+  // Without a schema, enum names have to be strings.
+  TEST_EQ(flex_parser.ParseFlexBuffer(
+              "{ u_type: \"S\", u: { a: [1, 2], f: \"A B\" },"
+              "  us_type: [\"T\", \"S\"],"
+              "  us: [{ s: \"x\" }, { a: [3, 4], f: \"B\" }],"
+              "  ss: [{ a: [5, 6], f: \"A\" }], f: 3 }",
+              nullptr, &json_flex),
+          true);
+  fbb.Clear();
+  TEST_EQ(view.FlexBufferToFlatBuffer(
+              flexbuffers::GetRoot(json_flex.GetBuffer()), &fbb, &error),
+          true);
+  text.clear();
+  TEST_EQ(GenerateText(union_parser, fbb.GetBufferPointer(), &text), true);
+  TEST_EQ_STR(text.c_str(), expected.c_str());
+}
+
 void MiniReflectFlatBuffersTest(uint8_t *flatbuf) {
   auto s =
       flatbuffers::FlatBufferToString(flatbuf, Monster::MiniReflectTypeTable());
@@ -1090,6 +1427,106 @@ void MiniReflectFlatBuffersTest(uint8_t *flatbuf) {
               "16, b: 32 } }");
 }
 
+void QueryTest() {
+  // Enough elements to span several 64-bit selection words and leave a tail
+  // that is not a multiple of the SIMD width.
+  const int num_monsters = 203;
+  flatbuffers::FlatBufferBuilder builder;
+  std::vector<flatbuffers::Offset<Monster>> monsters;
+  std::vector<Ability> abilities;
+  for (int i = 0; i < num_monsters; i++) {
+    auto name = builder.CreateString("M" + flatbuffers::NumToString(i));
+    MonsterBuilder mb(builder);
+    mb.add_name(name);
+    // Leave some fields absent so the defaults are exercised.
+    if (i % 5) mb.add_hp(static_cast<int16_t>(i * 3 % 250));
+    if (i % 7) mb.add_color(static_cast<Color>(1 << (i % 4)));
+    if (i % 3) mb.add_testhashs32_fnv1(i * 1000 - 50000);
+    if (i % 4) mb.add_testf(static_cast<float>(i) / 8);
+    monsters.push_back(mb.Finish());
+    abilities.push_back(Ability(static_cast<uint32_t>(i), i % 11 * 100u));
+  }
+  auto mvec = builder.CreateVector(monsters);
+  auto avec = builder.CreateVectorOfStructs(abilities);
+  auto name = builder.CreateString("root");
+  MonsterBuilder root(builder);
+  root.add_name(name);
+  root.add_testarrayoftables(mvec);
+  root.add_testarrayofsortedstruct(avec);
+  builder.Finish(root.Finish());
+  auto m = GetMonster(builder.GetBufferPointer());
+  auto tables = m->testarrayoftables();
+  auto structs = m->testarrayofsortedstruct();
+
+  // Tables: hp > 100 && color == Red.
+  flatbuffers::Query q(Monster::MiniReflectTypeTable());
+  TEST_EQ(q.Where("hp", flatbuffers::QO_GT, 100, 100), true);
+  TEST_EQ(q.WhereEnum("color", flatbuffers::QO_EQ, "Red", "Blue"), true);
+  TEST_EQ(q.Where("nosuchfield", flatbuffers::QO_EQ, 1), false);
+  TEST_EQ(q.Where("name", flatbuffers::QO_EQ, 1), false);
+  TEST_EQ(q.WhereEnum("color", flatbuffers::QO_EQ, "Purple"), false);
+  // Constants the field type can't hold are rejected, not wrapped.
+  TEST_EQ(q.Where("hp", flatbuffers::QO_GT, 100000), false);
+  TEST_EQ(q.Where("hp", flatbuffers::QO_GT, 2.5), false);
+  TEST_EQ(q.Where("hp", flatbuffers::QO_GT, 1e300), false);
+  TEST_EQ(q.Where("hp", flatbuffers::QO_GT, 100, 100000), false);
+  TEST_EQ(q.Where("testhashu32_fnv1", flatbuffers::QO_GT, -1), false);
+  TEST_EQ(q.Where("testhashu64_fnv1", flatbuffers::QO_GT, -1.0), false);
+  TEST_EQ(q.Where("testhashs64_fnv1", flatbuffers::QO_GT, 9.3e18), false);
+  TEST_EQ(q.predicates().size(), 2);
+  std::vector<flatbuffers::uoffset_t> rows;
+  auto n = q.Filter(tables, &rows);
+  std::vector<flatbuffers::uoffset_t> expected;
+  for (flatbuffers::uoffset_t i = 0; i < tables->size(); i++) {
+    auto t = tables->Get(i);
+    if (t->hp() > 100 && t->color() == Color_Red) expected.push_back(i);
+  }
+  TEST_EQ(n, expected.size());
+  TEST_EQ(rows == expected, true);
+  TEST_EQ(expected.empty(), false);
+
+  // The extremes of the field types are accepted.
+  flatbuffers::Query qr(Monster::MiniReflectTypeTable());
+  TEST_EQ(qr.Where("hp", flatbuffers::QO_GE, -32768, 100), true);
+  TEST_EQ(qr.Where("testhashu64_fnv1", flatbuffers::QO_LE,
+                   18446744073709551615ULL),
+          true);
+  TEST_EQ(qr.Filter(tables, &rows), tables->size());
+
+  // Tables, 32-bit fields: testhashs32_fnv1 >= 0 && testf < 10.
+  flatbuffers::Query q32(Monster::MiniReflectTypeTable());
+  q32.Where("testhashs32_fnv1", flatbuffers::QO_GE, 0);
+  q32.Where("testf", flatbuffers::QO_LT, 10.0f, 3.14159f);
+  std::vector<uint64_t> selection;
+  n = q32.Select(tables, &selection);
+  TEST_EQ(selection.size(), (tables->size() + 63) / 64);
+  size_t count = 0;
+  for (flatbuffers::uoffset_t i = 0; i < tables->size(); i++) {
+    auto t = tables->Get(i);
+    auto match = t->testhashs32_fnv1() >= 0 && t->testf() < 10.0f;
+    TEST_EQ(((selection[i / 64] >> (i % 64)) & 1) != 0, match);
+    count += match;
+  }
+  TEST_EQ(n, count);
+
+  // Structs: id != 7 && distance <= 300.
+  flatbuffers::Query qs(Ability::MiniReflectTypeTable());
+  qs.Where("id", flatbuffers::QO_NE, 7u);
+  qs.Where("distance", flatbuffers::QO_LE, 300u);
+  n = qs.Filter(structs, &rows);
+  expected.clear();
+  for (flatbuffers::uoffset_t i = 0; i < structs->size(); i++) {
+    auto s = structs->Get(i);
+    if (s->id() != 7 && s->distance() <= 300) expected.push_back(i);
+  }
+  TEST_EQ(n, expected.size());
+  TEST_EQ(rows == expected, true);
+
+  // No predicates selects everything.
+  flatbuffers::Query all(Ability::MiniReflectTypeTable());
+  TEST_EQ(all.Filter(structs, &rows), structs->size());
+}
+
 // Parse a .proto schema, output as .fbs
 void ParseProtoTest() {
   // load the .proto and the golden file from disk
@@ -2113,6 +2550,149 @@ void GenerateTableTextTest() {
   TEST_EQ_STR(jsongen.c_str(), "{a: 10,b: 20}");
 }
 
+struct ChunkedTextSink : public flatbuffers::TextSink {
+  ChunkedTextSink() : chunks(0), fail_at(-1) {}
+  bool Write(const char *data, size_t size) {
+    if (chunks++ == fail_at) return false;
+    text.append(data, size);
+    return true;
+  }
+  std::string text;
+  int chunks;
+  int fail_at;
+};
+
+void GenerateTextStreamingTest() {
+  // Large enough to be streamed in several chunks.
+  std::string json = "{ v: [";
+  for (int i = 0; i < 20000; i++) {
+    json += flatbuffers::NumToString(i / 7.0 - 1000) + ", ";
+  }
+  json += "], s: [";
+  for (int i = 0; i < 5000; i++) {
+    json += "\"s" + flatbuffers::NumToString(i * 31) + "\", ";
+  }
+  json += "], i: -9223372036854775808 }";
+  flatbuffers::Parser parser;
+  TEST_EQ(parser.Parse("table T { v:[double]; s:[string]; i:long; }"
+                       "root_type T;") &&
+              parser.Parse(json.c_str()),
+          true);
+  auto buf = parser.builder_.GetBufferPointer();
+  std::string text;
+  TEST_EQ(GenerateText(parser, buf, &text), true);
+  ChunkedTextSink sink;
+  TEST_EQ(GenerateText(parser, buf, &sink), true);
+  TEST_EQ(sink.chunks > 1, true);
+  TEST_EQ(sink.text == text, true);
+  // The text round-trips.
+  flatbuffers::Parser parser2;
+  TEST_EQ(parser2.Parse("table T { v:[double]; s:[string]; i:long; }"
+                        "root_type T;") &&
+              parser2.Parse(sink.text.c_str()),
+          true);
+  TEST_EQ(parser2.builder_.GetSize(), parser.builder_.GetSize());
+  TEST_EQ(std::memcmp(parser2.builder_.GetBufferPointer(), buf,
+                      parser.builder_.GetSize()),
+          0);
+  // A failing sink aborts generation.
+  ChunkedTextSink failing;
+  failing.fail_at = 1;
+  TEST_EQ(GenerateText(parser, buf, &failing), false);
+  TEST_EQ(failing.chunks, 2);
+  // The same from a binary schema.
+  flatbuffers::Parser schema_parser;
+  TEST_EQ(schema_parser.Parse("table T { v:[double]; s:[string]; i:long; }"
+                              "root_type T;"),
+          true);
+  schema_parser.Serialize();
+  flatbuffers::SchemaView view;
+  TEST_EQ(view.InitUnverified(schema_parser.builder_.GetBufferPointer(),
+                              schema_parser.builder_.GetSize()),
+          true);
+  ChunkedTextSink view_sink;
+  TEST_EQ(view.GenerateText(buf, flatbuffers::SchemaView::TextOptions(),
+                            &view_sink),
+          true);
+  TEST_EQ(view_sink.chunks > 1, true);
+  TEST_EQ(view_sink.text == text, true);
+  TEST_EQ(view.InitUnverified(buf, parser.builder_.GetSize()), false);
+}
+
+void NdjsonTest() {
+  const char *schema =
+      "table Point { x:float = 3.5; y:double; tag:string; }"
+      "table Line { name:string; points:[Point]; kind:int; }"
+      "root_type Line;"
+      "file_identifier \"LINE\";";
+  flatbuffers::IDLOptions opts;
+  opts.size_prefixed = true;
+  flatbuffers::Parser parser(opts);
+  TEST_EQ(parser.Parse(schema), true);
+  // Parse line by line with the schema parser to get the expected output.
+  std::string ndjson, expected;
+  for (int i = 0; i < 500; i++) {
+    std::string line = "{ name: \"line" + flatbuffers::NumToString(i) +
+                       "\", kind: " + flatbuffers::NumToString(i % 7) +
+                       ", points: [";
+    for (int j = 0; j < i % 5; j++) {
+      line += "{ x: " + flatbuffers::NumToString(j % 2 ? 3.0 : 3.5) +
+              ", y: " + flatbuffers::NumToString(i * 0.25) + ", tag: \"" +
+              std::string(static_cast<size_t>(j * 3), 't') + "\" }, ";
+    }
+    line += "] }";
+    TEST_EQ(parser.Parse(line.c_str()), true);
+    expected.append(
+        reinterpret_cast<const char *>(parser.builder_.GetBufferPointer()),
+        parser.builder_.GetSize());
+    ndjson += line + (i % 3 ? "\n" : "\r\n");
+    if (i % 11 == 0) ndjson += "  \n";  // Blank lines are skipped.
+  }
+  parser.Serialize();
+  std::vector<uint8_t> bfbs(
+      parser.builder_.GetBufferPointer(),
+      parser.builder_.GetBufferPointer() + parser.builder_.GetSize());
+
+  for (unsigned threads = 1; threads <= 4; threads++) {
+    flatbuffers::NdjsonOptions ndjson_opts;
+    ndjson_opts.num_threads = threads;
+    ndjson_opts.chunk_size = 100 * threads;
+    ChunkedTextSink sink;
+    std::string error;
+    TEST_EQ(flatbuffers::ParseNdjson(bfbs.data(), bfbs.size(), opts,
+                                     ndjson.c_str(), ndjson.size(), &sink,
+                                     &error, ndjson_opts),
+            true);
+    TEST_EQ(sink.text == expected, true);
+    TEST_EQ(flatbuffers::BufferHasIdentifier(sink.text.c_str(), "LINE", true),
+            true);
+  }
+
+  // Errors are reported for the first bad line, after everything before it
+  // has been written.
+  auto bad = ndjson;
+  auto pos = bad.find("line123");
+  bad.replace(pos, 7, "line123\", kind: [");
+  auto good_lines = std::count(bad.begin(), bad.begin() + pos, '\n');
+  flatbuffers::NdjsonOptions ndjson_opts;
+  ndjson_opts.num_threads = 3;
+  ndjson_opts.chunk_size = 64;
+  ChunkedTextSink sink;
+  std::string error;
+  TEST_EQ(flatbuffers::ParseNdjson(bfbs.data(), bfbs.size(), opts, bad.c_str(),
+                                   bad.size(), &sink, &error, ndjson_opts),
+          false);
+  auto prefix = "line " + flatbuffers::NumToString(good_lines + 1) + ":";
+  TEST_EQ(error.compare(0, prefix.size(), prefix), 0);
+  TEST_EQ(expected.compare(0, sink.text.size(), sink.text), 0);
+  TEST_EQ(sink.text.empty(), false);
+  const char *schema_line = "{ name: \"a\" }\ntable T {}";
+  TEST_EQ(flatbuffers::ParseNdjson(bfbs.data(), bfbs.size(), opts, schema_line,
+                                   strlen(schema_line), &sink, &error),
+          false);
+  TEST_EQ_STR("line 2: expecting a JSON object", error.c_str());
+}
+
 template<typename T>
 void NumericUtilsTestInteger(const char *lower, const char *upper) {
   T x;
@@ -2149,6 +2729,72 @@ void NumericUtilsTest() {
   NumericUtilsTestFloat<float>("-1.7977e+308", "+1.7977e+308");
 }
 
+// The fast paths in StringToNumber must agree bit for bit with strtod/strtof
+// and StringToIntegerImpl, which they shortcut.
+template<typename T> void FastFloatParseCheck(const char *str) {
+  T fast = 0, slow = 0;
+  char *end = nullptr;
+  flatbuffers::strtoval_impl(&slow, str, &end);
+  TEST_EQ(end != str && *end == '\0', true);
+  TEST_EQ(flatbuffers::StringToNumber(str, &fast), true);
+  TEST_EQ(memcmp(&fast, &slow, sizeof(T)), 0);
+}
+
+void FastNumericParseTest() {
+  const char *floats[] = { "0",
+                           "-0",
+                           "0.1",
+                           "-2.5",
+                           "1e22",
+                           "1e23",
+                           "9007199254740993",
+                           "9007199254740992.5",
+                           "0.30000000000000004",
+                           "123456789.123456789",
+                           "-18446744073709551615e-19",
+                           "9999999999999999999e19",
+                           "16777217",
+                           "1.00000005960464477539",
+                           "3.4028235e38",
+                           "1e-19",
+                           "2.2250738585072014e-308",
+                           "1.7976931348623157e308",
+                           "00000000000000000000000000001.5" };
+  for (size_t i = 0; i < sizeof(floats) / sizeof(floats[0]); i++) {
+    FastFloatParseCheck<double>(floats[i]);
+    FastFloatParseCheck<float>(floats[i]);
+  }
+  char buf[64];
+  for (int i = 0; i < 20000; i++) {
+    auto w = (static_cast<uint64_t>(lcg_rand()) << 32) | lcg_rand();
+    w >>= lcg_rand() % 64;
+    auto e = static_cast<int>(lcg_rand() % 50) - 25;
+    snprintf(buf, sizeof(buf), "%s%llue%d", i % 2 ? "-" : "",
+             static_cast<unsigned long long>(w), e);
+    FastFloatParseCheck<double>(buf);
+    FastFloatParseCheck<float>(buf);
+    snprintf(buf, sizeof(buf), "%llu.%06u", static_cast<unsigned long long>(w),
+             lcg_rand() % 1000000);
+    FastFloatParseCheck<double>(buf);
+    FastFloatParseCheck<float>(buf);
+    snprintf(buf, sizeof(buf), "%s%llu", i % 3 ? "-" : "+",
+             static_cast<unsigned long long>(w >> 1));
+    int64_t fast = 0, slow = 0;
+    TEST_EQ(flatbuffers::StringToNumber(buf, &fast),
+            flatbuffers::StringToIntegerImpl(&slow, buf));
+    TEST_EQ(fast, slow);
+  }
+  int64_t i64;
+  TEST_EQ(flatbuffers::StringToNumber("-9223372036854775808", &i64), true);
+  TEST_EQ(i64, flatbuffers::numeric_limits<int64_t>::lowest());
+  TEST_EQ(flatbuffers::StringToNumber("123456789012345678", &i64), true);
+  TEST_EQ(i64, 123456789012345678LL);
+  uint64_t u64;
+  TEST_EQ(flatbuffers::StringToNumber("18446744073709551615", &u64), true);
+  TEST_EQ(u64, flatbuffers::numeric_limits<uint64_t>::max());
+  TEST_EQ(flatbuffers::StringToNumber("-1", &u64), false);
+}
+
 void IsAsciiUtilsTest() {
   char c = -128;
   for (int cnt = 0; cnt < 256; cnt++) {
@@ -2163,6 +2809,50 @@ void IsAsciiUtilsTest() {
   }
 }
 
+// Whitespace, strings and comments of every length around the block size of
+// the vectorized scanner in Parser::Next(), with the interesting byte at each
+// offset.
+void TokenizerBlockBoundaryTest() {
+  const char *schema = "table T { s:string; } root_type T;";
+  const char *specials[] = { "\\n", "\\u00e9", "\xC3\xA9", "\\\"", "'" };
+  const char *decoded[] = { "\n", "\xC3\xA9", "\xC3\xA9", "\"", "'" };
+  for (size_t k = 0; k < sizeof(specials) / sizeof(specials[0]); k++) {
+    for (size_t n = 0; n < 80; n += 3) {
+      std::string prefix(n, 'a'), suffix(80 - n, 'b');
+      std::string json = "{ s: \"" + prefix + specials[k] + suffix + "\" }";
+      flatbuffers::Parser parser;
+      TEST_EQ(parser.Parse(schema), true);
+      TEST_EQ(parser.Parse(json.c_str()), true);
+      auto root = flatbuffers::GetRoot<flatbuffers::Table>(
+          parser.builder_.GetBufferPointer());
+      auto str = root->GetPointer<const flatbuffers::String *>(4);
+      TEST_EQ_STR((prefix + decoded[k] + suffix).c_str(), str->c_str());
+    }
+  }
+  for (size_t n = 0; n < 100; n += 7) {
+    std::string json = "{";
+    for (size_t i = 0; i < n; i++) json += (i * 13) % 11 == 3 ? '\n' : ' ';
+    json += "// comment" + std::string(n, '-') + "\r\n";
+    json += std::string(n % 37, '\t') + " s: \"x\" #";
+    auto nl = json.rfind('\n');
+    auto line = std::count(json.begin(), json.end(), '\n') + 1;
+    auto col = json.length() - nl - 1;
+    flatbuffers::Parser parser;
+    TEST_EQ(parser.Parse(schema), true);
+    TEST_EQ(parser.Parse(json.c_str()), false);
+    // clang-format off
+    #ifdef _WIN32
+      auto pos = "(" + flatbuffers::NumToString(line) + ", " +
+                 flatbuffers::NumToString(col) + ")";
+    #else
+      auto pos = flatbuffers::NumToString(line) + ": " +
+                 flatbuffers::NumToString(col) + ":";
+    #endif
+    // clang-format on
+    TEST_NOTNULL(strstr(parser.error_.c_str(), pos.c_str()));
+  }
+}
+
 void UnicodeTest() {
   flatbuffers::Parser parser;
   // Without setting allow_non_utf8 = true, we treat \x sequences as byte
@@ -2428,6 +3118,92 @@ void ParseUnionTest() {
           true);
 }
 
+void KeySortTest() {
+  // Vectors of tables and structs are sorted on their own key, even when the
+  // key fields differ in type and offset within one buffer.
+  flatbuffers::Parser parser;
+  TEST_EQ(parser.Parse("table A { a:int (key); }"
+                       "struct S { pad:short; s:float (key); }"
+                       "table B { pad:byte; b:string (key); }"
+                       "table R { as:[A]; ss:[S]; bs:[B]; }"
+                       "root_type R;"
+                       "{ as: [{ a: 3 }, { a: 1 }, { a: 2 }],"
+                       "  ss: [{ pad: 0, s: 2.5 }, { pad: 0, s: -1.0 }],"
+                       "  bs: [{ b: \"y\" }, { b: \"x\" }, { b: \"z\" }] }"),
+          true);
+  std::string jsongen;
+  parser.opts.indent_step = -1;
+  TEST_EQ(GenerateText(parser, parser.builder_.GetBufferPointer(), &jsongen),
+          true);
+  TEST_EQ_STR(jsongen.c_str(),
+              "{as: [{a: 1},{a: 2},{a: 3}],"
+              "ss: [{pad: 0,s: -1.0},{pad: 0,s: 2.5}],"
+              "bs: [{b: \"x\"},{b: \"y\"},{b: \"z\"}]}");
+}
+
+void FieldLookupTest() {
+  // Every field is found by name when parsing JSON, however many there are.
+  std::string schema = "table T {";
+  std::string json = "{";
+  for (int i = 0; i < 100; i++) {
+    schema += " f" + flatbuffers::NumToString(i) + ":int;";
+    json += " f" + flatbuffers::NumToString(i) + ": " +
+            flatbuffers::NumToString(i + 1) + ",";
+  }
+  schema += " } root_type T;";
+  json += " }";
+  flatbuffers::Parser parser;
+  TEST_EQ(parser.Parse(schema.c_str()), true);
+  TEST_EQ(parser.Parse(json.c_str()), true);
+  auto root = flatbuffers::GetRoot<flatbuffers::Table>(
+      parser.builder_.GetBufferPointer());
+  for (int i = 0; i < 100; i++) {
+    auto offset = flatbuffers::FieldIndexToOffset(
+        static_cast<flatbuffers::voffset_t>(i));
+    TEST_EQ(root->GetField<int32_t>(offset, 0), i + 1);
+  }
+  TEST_EQ(parser.Parse("{ f100: 1 }"), false);
+  TEST_EQ(parser.Parse("{ f: 1 }"), false);
+  // Fields read from a binary schema are indexed too.
+  parser.Serialize();
+  flatbuffers::Parser deserialized;
+  TEST_EQ(deserialized.Deserialize(parser.builder_.GetBufferPointer(),
+                                   parser.builder_.GetSize()),
+          true);
+  TEST_EQ(deserialized.Parse(json.c_str()), true);
+  TEST_EQ(deserialized.root_struct_def_->LookupField("f99")->value.offset,
+          flatbuffers::FieldIndexToOffset(99));
+  TEST_EQ(deserialized.root_struct_def_->LookupField("f100") == nullptr, true);
+}
+
+void ParserCheckpointTest() {
+  // What is parsed after a checkpoint is dropped again, so that one parser
+  // of shared definitions can parse many schemas on top of them.
+  flatbuffers::Parser parser;
+  TEST_EQ(parser.Parse("namespace N; table A { a:int; } attribute \"x\";"),
+          true);
+  parser.MarkGenerated();
+  parser.SetCheckpoint();
+  for (int i = 0; i < 2; i++) {
+    TEST_EQ(parser.Parse("namespace M; attribute \"y\";"
+                         "table B { a:N.A (y); } root_type B;"),
+            true);
+    TEST_EQ(parser.structs_.vec.size(), 2);
+    TEST_EQ(parser.structs_.Lookup("N.A")->generated, true);
+    TEST_EQ(parser.structs_.Lookup("M.B")->generated, false);
+    TEST_EQ(parser.root_struct_def_, parser.structs_.Lookup("M.B"));
+    parser.MarkGenerated();
+    parser.RestoreCheckpoint();
+    TEST_EQ(parser.structs_.vec.size(), 1);
+    TEST_EQ(parser.structs_.Lookup("M.B") == nullptr, true);
+    TEST_EQ(parser.structs_.Lookup("N.A")->refcount, 1);
+    TEST_EQ(parser.root_struct_def_ == nullptr, true);
+    TEST_EQ(parser.known_attributes_.count("x"), 1);
+    TEST_EQ(parser.known_attributes_.count("y"), 0);
+  }
+  TEST_EQ(parser.Parse("table C { a:N.A (y); }"), false);
+}
+
 void InvalidNestedFlatbufferTest() {
   // First, load and parse FlatBuffer schema (.fbs)
   std::string schemafile;
@@ -2447,6 +3223,42 @@ void InvalidNestedFlatbufferTest() {
           false);
 }
 
+void NestedFlatbufferTest() {
+  std::string schemafile;
+  TEST_EQ(flatbuffers::LoadFile((test_data_path + "monster_test.fbs").c_str(),
+                                false, &schemafile),
+          true);
+  auto include_test_path =
+      flatbuffers::ConCatPathFileName(test_data_path, "include_test");
+  const char *include_directories[] = { test_data_path.c_str(),
+                                        include_test_path.c_str(), nullptr };
+  flatbuffers::Parser parser;
+  TEST_EQ(parser.Parse(schemafile.c_str(), include_directories), true);
+  // Nested flatbuffers within nested flatbuffers, and one after the other.
+  TEST_EQ(parser.Parse("{ name: \"a\", testnestedflatbuffer: {"
+                       "    name: \"b\","
+                       "    testnestedflatbuffer: { name: \"c\" } },"
+                       "  testarrayoftables: ["
+                       "    {name: \"d\", testnestedflatbuffer: {name: \"e\"}},"
+                       "    {name: \"f\", testnestedflatbuffer: {name: \"g\"}}"
+                       "  ] }"),
+          true);
+  auto monster = GetMonster(parser.builder_.GetBufferPointer());
+  auto b = monster->testnestedflatbuffer_nested_root();
+  TEST_EQ_STR(b->name()->c_str(), "b");
+  TEST_EQ_STR(b->testnestedflatbuffer_nested_root()->name()->c_str(), "c");
+  auto tables = monster->testarrayoftables();
+  auto e = tables->Get(0)->testnestedflatbuffer_nested_root();
+  auto g = tables->Get(1)->testnestedflatbuffer_nested_root();
+  TEST_EQ_STR(e->name()->c_str(), "e");
+  TEST_EQ_STR(g->name()->c_str(), "g");
+  // Errors in a nested flatbuffer are reported where they are in the input.
+  TEST_EQ(parser.Parse("{ name: \"a\",\n"
+                       "  testnestedflatbuffer: { name: \"b\", hp: \"x\" } }"),
+          false);
+  TEST_EQ(parser.error_.find("2: ") != std::string::npos, true);
+}
+
 void EvolutionTest() {
   // VS10 does not support typed enums, exclude from tests
 #if !defined(_MSC_VER) || _MSC_VER >= 1700
@@ -2960,6 +3772,700 @@ void FlexBuffersDeprecatedTest() {
   // FBT_VECTOR_KEY (call slb.Key above instead, read with AsKey or AsString).
 }
 
+void FlexBuffersJsonTest() {
+  // The direct converter must produce exactly what the tokenizer does, which
+  // ParseFlexBuffer() still uses for protobuf_ascii_alike input. That syntax
+  // has no commas, but is otherwise the same.
+  auto json =
+      "{ a: [ 1, -2, 3.5, \"x\\u00e9\" ], /* c */ b: { z: null, y: true },\n"
+      "  'c': [], d: 16, e: -inf, f: [ { g: 1 }, [ 2, [] ] ], // c\n"
+      "  h: [ 0x1F, .5, -1e3, 0x1.8p1, \"\\x41\\uD83D\\uDE00\\t\" ], }";
+  flatbuffers::IDLOptions opts;
+  flexbuffers::Builder slb;
+  std::string error;
+  TEST_EQ(flatbuffers::ParseFlexBufferJson(json, opts, &slb, &error), true);
+  flexbuffers::Builder pslb;
+  flatbuffers::IDLOptions tokenizer_opts;
+  tokenizer_opts.protobuf_ascii_alike = true;
+  flatbuffers::Parser parser(tokenizer_opts);
+  std::string ascii_alike = json;
+  ascii_alike.erase(std::remove(ascii_alike.begin(), ascii_alike.end(), ','),
+                    ascii_alike.end());
+  TEST_EQ(parser.ParseFlexBuffer(ascii_alike.c_str(), nullptr, &pslb), true);
+  TEST_EQ(slb.GetBuffer() == pslb.GetBuffer(), true);
+  auto root = flexbuffers::GetRoot(slb.GetBuffer()).AsMap();
+  TEST_EQ(root["a"].AsVector()[1].AsInt64(), -2);
+  TEST_EQ_STR(root["a"].AsVector()[3].AsString().c_str(), "x\xC3\xA9");
+  TEST_EQ(root["b"].AsMap()["z"].IsNull(), true);
+  TEST_EQ(root["d"].AsInt64(), 16);
+  TEST_EQ(root["h"].AsVector()[2].AsDouble(), -1000.0);
+  TEST_EQ(root["h"].AsVector()[3].AsDouble(), 3.0);
+  TEST_EQ_STR(root["h"].AsVector()[4].AsString().c_str(),
+              "A\xF0\x9F\x98\x80\t");
+
+  // The builder can be reused for the next document.
+  slb.Clear();
+  TEST_EQ(flatbuffers::ParseFlexBufferJson("[ 1, 2 ]", opts, &slb, &error),
+          true);
+  TEST_EQ(flexbuffers::GetRoot(slb.GetBuffer()).AsVector().size(), 2);
+
+  // Errors report where in the input they were found.
+  opts.strict_json = true;
+  slb.Clear();
+  auto bad = "{ \"a\": 1,\n  \"b\": [ 2, ] }";
+  const char *error_pos = nullptr;
+  TEST_EQ(
+      flatbuffers::ParseFlexBufferJson(bad, opts, &slb, &error, &error_pos),
+      false);
+  TEST_EQ(error.empty(), false);
+  TEST_EQ(error_pos, strchr(bad, ']'));
+  flatbuffers::Parser strict_parser(opts);
+  slb.Clear();
+  TEST_EQ(strict_parser.ParseFlexBuffer(bad, nullptr, &slb), false);
+  // Line 2, column 12, in whichever format the platform reports it.
+  TEST_NOTNULL(strstr(strict_parser.error_.c_str(), "2"));
+  TEST_NOTNULL(strstr(strict_parser.error_.c_str(), "12"));
+  slb.Clear();
+  TEST_EQ(flatbuffers::ParseFlexBufferJson("[ 1 ] 2", opts, &slb, &error),
+          false);
+  auto bad_escape = "[ \"a\\q\" ]";
+  slb.Clear();
+  TEST_EQ(flatbuffers::ParseFlexBufferJson(bad_escape, opts, &slb, &error,
+                                           &error_pos),
+          false);
+  TEST_EQ_STR(error.c_str(), "unknown escape code in string constant");
+  TEST_EQ(error_pos, strchr(bad_escape, 'q'));
+}
+
+void FlexBuffersStreamingTest() {
+  // Large enough to be streamed in several chunks.
+  flexbuffers::Builder slb;
+  slb.Map([&]() {
+    slb.TypedVector("ints", [&]() {
+      for (int i = 0; i < 20000; i++) slb.Int(i * 997 - 5000000);
+    });
+    std::vector<double> doubles;
+    for (int i = 0; i < 5000; i++) doubles.push_back(i / 7.0);
+    slb.TypedVector("doubles", [&]() {
+      for (auto it = doubles.begin(); it != doubles.end(); ++it) slb.Add(*it);
+    });
+    bool bools[100];
+    for (int i = 0; i < 100; i++) bools[i] = i % 3 == 0;
+    slb.Vector("bools", bools, 100);
+    slb.FixedTypedVector("fixed", doubles.data(), 3);
+    slb.Vector("mixed", [&]() {
+      slb.UInt(18446744073709551615ULL);
+      slb.String("a \"quoted\" string");
+      slb.Null();
+      slb.Vector([&]() { slb.Key("key"); });
+    });
+  });
+  slb.Finish();
+  auto root = flexbuffers::GetRoot(slb.GetBuffer());
+  std::string text;
+  root.ToString(true, true, text);
+  ChunkedTextSink sink;
+  TEST_EQ(root.ToString(true, true, &sink), true);
+  TEST_EQ(sink.chunks > 1, true);
+  TEST_EQ(sink.text == text, true);
+  // Typed vectors are formatted in bulk, the same as element by element.
+  auto ints = root.AsMap()["ints"];
+  std::string elementwise;
+  flexbuffers::AppendToString<flexbuffers::TypedVector>(
+      elementwise, ints.AsTypedVector(), true);
+  TEST_EQ(ints.ToString() == elementwise, true);
+  TEST_EQ(text.find("\"mixed\": [ 18446744073709551615, "
+                    "\"a \\\"quoted\\\" string\", null, [ \"key\" ] ]") !=
+              std::string::npos,
+          true);
+  // A failing sink aborts generation.
+  ChunkedTextSink failing;
+  failing.fail_at = 1;
+  TEST_EQ(root.ToString(true, true, &failing), false);
+  TEST_EQ(failing.chunks, 2);
+}
+
+void FlexBuffersKeyIndexTest() {
+  // The same maps, with and without a key index.
+  std::vector<uint8_t> bufs[2];
+  for (int indexed = 0; indexed < 2; indexed++) {
+    flexbuffers::Builder slb(
+        256, indexed ? flexbuffers::BUILDER_FLAG_INDEX_MAP_KEYS
+                     : flexbuffers::BUILDER_FLAG_SHARE_KEYS);
+    slb.Vector([&]() {
+      slb.Map([&]() {
+        for (int i = 0; i < 300; i++) {
+          slb.Int(("key" + flatbuffers::NumToString(i * 7)).c_str(), i);
+        }
+      });
+      // 64-bit wide, so padded after the index.
+      slb.Map([&]() {
+        for (int i = 0; i < 10; i++) {
+          slb.UInt(("k" + flatbuffers::NumToString(i)).c_str(), 1ULL << 40);
+        }
+      });
+      // Too small to be indexed.
+      slb.Map([&]() { slb.Int("a", 1); });
+      for (int i = 0; i < 50; i++) {
+        slb.Map([&]() {
+          for (int j = 0; j < 20; j++) {
+            slb.Int(("field" + flatbuffers::NumToString(j)).c_str(), i * j);
+          }
+        });
+      }
+    });
+    slb.Finish();
+    bufs[indexed] = slb.GetBuffer();
+  }
+  TEST_EQ(bufs[1].size() > bufs[0].size(), true);
+  auto plain = flexbuffers::GetRoot(bufs[0]).AsVector();
+  auto vec = flexbuffers::GetRoot(bufs[1]).AsVector();
+  // Readers see the same values, whether they use the index or not.
+  TEST_EQ(vec[0].ToString() == plain[0].ToString(), true);
+  auto big = vec[0].AsMap();
+  for (int i = 0; i < 300; i++) {
+    auto key = "key" + flatbuffers::NumToString(i * 7);
+    TEST_EQ(big[key].AsInt64(), i);
+    TEST_EQ(plain[0].AsMap()[key].AsInt64(), i);
+    TEST_EQ(big[("key" + flatbuffers::NumToString(i * 7 + 1)).c_str()].IsNull(),
+            true);
+  }
+  TEST_EQ(big[""].IsNull(), true);
+  TEST_EQ(vec[1].AsMap()["k9"].AsUInt64(), 1ULL << 40);
+  TEST_EQ(vec[1].AsMap()["k"].IsNull(), true);
+  TEST_EQ(vec[2].AsMap()["a"].AsInt64(), 1);
+  // A MapKey looks up the same field in many maps.
+  flexbuffers::MapKey field("field13");
+  flexbuffers::MapKey missing("field20");
+  for (size_t i = 0; i < 50; i++) {
+    TEST_EQ(vec[i + 3].AsMap()[field].AsInt64(), static_cast<int64_t>(i * 13));
+    TEST_EQ(plain[i + 3].AsMap()[field].AsInt64(),
+            static_cast<int64_t>(i * 13));
+    TEST_EQ(vec[i + 3].AsMap()[missing].IsNull(), true);
+  }
+  TEST_EQ(big[field].IsNull(), true);
+  flexbuffers::MapKey key21("key21");
+  TEST_EQ(big[key21].AsInt64(), 3);
+  TEST_EQ(plain[0].AsMap()[key21].AsInt64(), 3);
+  // Keys that an index doesn't lead to are still found.
+  auto damaged = bufs[1];
+  auto magic = std::search(damaged.begin(), damaged.end(), "FIXK", "FIXK" + 4);
+  TEST_EQ(magic == damaged.end(), false);
+  auto num_slots = flatbuffers::ReadScalar<uint32_t>(&*magic + 4);
+  TEST_EQ(num_slots >= 600, true);
+  std::fill(magic + 8, magic + 8 + num_slots * 4, 0);
+  auto damaged_big = flexbuffers::GetRoot(damaged).AsVector()[0].AsMap();
+  for (int i = 0; i < 300; i++) {
+    TEST_EQ(damaged_big["key" + flatbuffers::NumToString(i * 7)].AsInt64(), i);
+  }
+
+  // Maps that share a keys vector share its index, which directly follows
+  // it. Values written between the keys and a later map that look like an
+  // index aren't taken for one.
+  uint32_t fake_index[17] = { 0 };
+  fake_index[15] = 16;
+  fake_index[16] = flexbuffers::kKeyIndexMagic;
+  for (int indexed = 0; indexed < 2; indexed++) {
+    flexbuffers::Builder slb(
+        256, static_cast<flexbuffers::BuilderFlag>(
+                 flexbuffers::BUILDER_FLAG_SHARE_ALL |
+                 (indexed ? flexbuffers::BUILDER_FLAG_INDEX_MAP_KEYS : 0)));
+    slb.Vector([&]() {
+      slb.Map([&]() {
+        slb.Int("a", 1);
+        slb.Int("b", 2);
+      });
+      slb.Map([&]() {
+        slb.Int("a", 3);
+        slb.Vector("b", fake_index, 17);
+      });
+      for (int m = 0; m < 2; m++) {
+        slb.Map([&]() {
+          for (int i = 0; i < 10; i++) {
+            slb.Int(("s" + flatbuffers::NumToString(i)).c_str(), i + m);
+          }
+        });
+      }
+    });
+    slb.Finish();
+    auto maps = flexbuffers::GetRoot(slb.GetBuffer()).AsVector();
+    TEST_EQ(maps[0].AsMap()["a"].AsInt64(), 1);
+    TEST_EQ(maps[1].AsMap()["a"].AsInt64(), 3);
+    TEST_EQ(maps[1].AsMap()["b"].AsTypedVector().size(), 17);
+    for (size_t m = 0; m < 2; m++) {
+      auto map = maps[m + 2].AsMap();
+      TEST_EQ(map["s9"].AsUInt64(), 9 + m);
+      TEST_EQ(map["s10"].IsNull(), true);
+    }
+    const auto &buf = slb.GetBuffer();
+    auto index = std::search(buf.begin(), buf.end(), "FIXK", "FIXK" + 4);
+    // The fake index, and the real one if any.
+    index = std::search(index + 4, buf.end(), "FIXK", "FIXK" + 4);
+    TEST_EQ(index == buf.end(), !indexed);
+    if (indexed) {
+      TEST_EQ(
+          std::search(index + 4, buf.end(), "FIXK", "FIXK" + 4) == buf.end(),
+          true);
+    }
+  }
+}
+
+void FlexBuffersPoolTest() {
+  flexbuffers::Builder slb(256, flexbuffers::BUILDER_FLAG_SHARE_ALL);
+  std::vector<uint8_t> first;
+  for (int pass = 0; pass < 2; pass++) {
+    // After Clear(), nothing from the previous buffer may be shared.
+    slb.Clear();
+    slb.Vector([&]() {
+      // Enough distinct keys and strings for the pools to grow.
+      for (int i = 0; i < 200; i++) {
+        slb.Map([&]() {
+          auto s = flatbuffers::NumToString(i % 100);
+          slb.String(("k" + s).c_str(), "value" + s);
+          slb.String("prefix", i & 1 ? "ab" : "abc");
+          slb.String("nul", std::string("a\0b", 3));
+        });
+      }
+    });
+    slb.Finish();
+    if (!pass) first = slb.GetBuffer();
+  }
+  TEST_EQ(slb.GetBuffer() == first, true);
+  auto vec = flexbuffers::GetRoot(slb.GetBuffer()).AsVector();
+  for (size_t i = 0; i < vec.size(); i++) {
+    auto map = vec[i].AsMap();
+    auto s = flatbuffers::NumToString(i % 100);
+    TEST_EQ_STR(map[("k" + s).c_str()].AsString().c_str(),
+                ("value" + s).c_str());
+    TEST_EQ_STR(map["prefix"].AsString().c_str(), i & 1 ? "ab" : "abc");
+    TEST_EQ(map["nul"].AsString().length(), 3);
+  }
+  // Equal keys and strings are stored once.
+  auto m0 = vec[0].AsMap(), m100 = vec[100].AsMap();
+  TEST_EQ(m0["k0"].AsString().c_str(), m100["k0"].AsString().c_str());
+  TEST_EQ(m0.Keys()[0].AsKey(), m100.Keys()[0].AsKey());
+  TEST_EQ(vec[1].AsMap()["prefix"].AsString().c_str() !=
+              m0["prefix"].AsString().c_str(),
+          true);
+}
+
+void FlexBuffersMapTemplateTest() {
+  const char *keys[] = { "z", "x", "y", "name" };
+  auto write = [](flexbuffers::Builder &slb, int i) {
+    slb.Int(i);
+    slb.Int(i * 2);
+    slb.Double(i / 2.0);
+    slb.String("map" + flatbuffers::NumToString(i));
+  };
+  for (int flags = 0; flags < 2; flags++) {
+    auto index = flags ? flexbuffers::BUILDER_FLAG_INDEX_MAP_KEYS
+                       : flexbuffers::BUILDER_FLAG_NONE;
+    // Regular maps, written in sorted and unsorted key order, with and
+    // without sharing their keys vectors.
+    std::vector<uint8_t> bufs[3];
+    for (int b = 0; b < 3; b++) {
+      flexbuffers::Builder slb(
+          256, static_cast<flexbuffers::BuilderFlag>(
+                   index | flexbuffers::BUILDER_FLAG_SHARE_KEYS |
+                   (b == 2 ? flexbuffers::BUILDER_FLAG_SHARE_KEY_VECTORS : 0)));
+      slb.Vector([&]() {
+        for (int i = 0; i < 10; i++) {
+          slb.Map([&]() {
+            if (b) {
+              slb.Int("z", i);
+              slb.Int("x", i * 2);
+              slb.Double("y", i / 2.0);
+              slb.String("name", "map" + flatbuffers::NumToString(i));
+            } else {
+              slb.String("name", "map" + flatbuffers::NumToString(i));
+              slb.Int("x", i * 2);
+              slb.Double("y", i / 2.0);
+              slb.Int("z", i);
+            }
+          });
+        }
+      });
+      slb.Finish();
+      bufs[b] = slb.GetBuffer();
+    }
+    TEST_EQ(flexbuffers::GetRoot(bufs[0]).ToString() ==
+                flexbuffers::GetRoot(bufs[1]).ToString(),
+            true);
+    TEST_EQ(bufs[2].size() < bufs[1].size(), true);
+    // The same maps from a template, which shares its keys vector too.
+    flexbuffers::Builder slb(256, index);
+    auto tmpl = slb.RegisterMapTemplate(keys, 4);
+    for (int pass = 0; pass < 2; pass++) {
+      // Templates survive Clear().
+      slb.Clear();
+      slb.Vector([&]() {
+        for (int i = 0; i < 10; i++) {
+          slb.TemplateMap(tmpl, [&]() { write(slb, i); });
+        }
+      });
+      slb.Finish();
+    }
+    TEST_EQ(slb.GetSize() <= bufs[2].size(), true);
+    auto vec = flexbuffers::GetRoot(slb.GetBuffer()).AsVector();
+    auto expected = flexbuffers::GetRoot(bufs[0]).AsVector();
+    TEST_EQ(vec.size(), 10);
+    for (size_t i = 0; i < vec.size(); i++) {
+      auto map = vec[i].AsMap();
+      TEST_EQ(map.size(), 4);
+      TEST_EQ(map["z"].AsInt64(), static_cast<int64_t>(i));
+      TEST_EQ(map["y"].AsDouble(), i / 2.0);
+      TEST_EQ(vec[i].ToString() == expected[i].ToString(), true);
+    }
+    auto shared = flexbuffers::GetRoot(bufs[2]).AsVector();
+    TEST_EQ(shared[9].ToString() == expected[9].ToString(), true);
+    TEST_EQ(shared[9].AsMap()["name"].ToString() == "map9", true);
+  }
+  // A template with enough keys to be indexed.
+  std::vector<std::string> many;
+  for (int i = 0; i < 20; i++) {
+    many.push_back("f" + flatbuffers::NumToString(i));
+  }
+  flexbuffers::Builder slb(256, flexbuffers::BUILDER_FLAG_INDEX_MAP_KEYS);
+  auto tmpl = slb.RegisterMapTemplate(many);
+  slb.Vector([&]() {
+    for (int m = 0; m < 2; m++) {
+      slb.TemplateMap(tmpl, [&]() {
+        for (int i = 0; i < 20; i++) slb.Int(i + m);
+      });
+    }
+  });
+  slb.Finish();
+  auto maps = flexbuffers::GetRoot(slb.GetBuffer()).AsVector();
+  for (size_t m = 0; m < 2; m++) {
+    // The second map is not next to its keys vector.
+    auto map = maps[m].AsMap();
+    for (size_t i = 0; i < 20; i++) {
+      TEST_EQ(map[many[i]].AsUInt64(), i + m);
+    }
+    TEST_EQ(map["f20"].IsNull(), true);
+  }
+  // The index is written once, after the keys vector.
+  const auto &buf = slb.GetBuffer();
+  auto index = std::search(buf.begin(), buf.end(), "FIXK", "FIXK" + 4);
+  TEST_EQ(index == buf.end(), false);
+  TEST_EQ(std::search(index + 4, buf.end(), "FIXK", "FIXK" + 4) == buf.end(),
+          true);
+}
+
+void FlexBuffersTypedVectorTest() {
+  int32_t small[] = { -3, 100, 7 };
+  int32_t big[] = { -3, 100000, 7 };
+  double floats[] = { 0.5, 1.25, -2 };
+  std::vector<uint8_t> bytes(300, 255);
+  int16_t fixed[] = { 1, -2, 3 };
+  auto build = [&](flexbuffers::Builder &slb) {
+    slb.Map([&]() {
+      slb.Vector("small", small, 3);
+      slb.Vector("big", big, 3);
+      slb.Vector("floats", floats, 3);
+      slb.Vector("bytes", bytes.data(), bytes.size());
+      slb.FixedTypedVector("fixed", fixed, 3);
+    });
+    slb.Finish();
+  };
+  const auto in_place = FLATBUFFERS_LITTLEENDIAN != 0;
+  int32_t ints[3];
+  double doubles[3];
+  std::vector<uint8_t> bytes_back(300);
+
+  // By default elements are stored as their own type, so readers can use
+  // them in place.
+  flexbuffers::Builder slb;
+  build(slb);
+  auto map = flexbuffers::GetRoot(slb.GetBuffer()).AsMap();
+  auto vsmall = map["small"].AsTypedVector();
+  TEST_EQ(vsmall.data<int32_t>() != nullptr, in_place);
+  TEST_EQ(vsmall.CopyTo(ints, 3), true);
+  TEST_EQ(memcmp(ints, small, sizeof(small)), 0);
+  auto vfloats = map["floats"].AsTypedVector();
+  TEST_EQ(vfloats.data<double>() != nullptr, in_place);
+  if (in_place) {
+    TEST_EQ(memcmp(vfloats.data<double>(), floats, sizeof(floats)), 0);
+  }
+  TEST_EQ(map["fixed"].AsFixedTypedVector().data<int16_t>() != nullptr,
+          in_place);
+  // Unless the size field doesn't fit, then the vector is widened.
+  auto vbytes = map["bytes"].AsTypedVector();
+  TEST_EQ(vbytes.size(), 300);
+  TEST_EQ(vbytes.data<uint8_t>() == nullptr, true);
+  TEST_EQ(vbytes.CopyTo(bytes_back.data(), bytes_back.size()), true);
+  TEST_EQ(bytes_back == bytes, true);
+  TEST_EQ(map.Keys().CopyTo(ints, 1), false);
+
+  // Narrowed, elements are stored with the smallest width that fits them all.
+  flexbuffers::Builder nslb(
+      256, static_cast<flexbuffers::BuilderFlag>(
+               flexbuffers::BUILDER_FLAG_SHARE_KEYS |
+               flexbuffers::BUILDER_FLAG_NARROW_SCALAR_VECTORS));
+  build(nslb);
+  TEST_EQ(nslb.GetSize() < slb.GetSize(), true);
+  map = flexbuffers::GetRoot(nslb.GetBuffer()).AsMap();
+  vsmall = map["small"].AsTypedVector();
+  TEST_EQ(vsmall.data<int32_t>() == nullptr, true);
+  TEST_EQ(vsmall.CopyTo(ints, 3), true);
+  TEST_EQ(memcmp(ints, small, sizeof(small)), 0);
+  // Which readers can use in place when it matches.
+  auto vbig = map["big"].AsTypedVector();
+  TEST_EQ(vbig.data<int32_t>() != nullptr, in_place);
+  TEST_EQ(vbig.CopyTo(ints, 3), true);
+  TEST_EQ(memcmp(ints, big, sizeof(big)), 0);
+  int64_t wide[3];
+  TEST_EQ(vbig.CopyTo(wide, 3), true);
+  TEST_EQ(wide[1], 100000);
+  vfloats = map["floats"].AsTypedVector();
+  TEST_EQ(vfloats.data<double>() == nullptr, true);
+  TEST_EQ(vfloats.CopyTo(doubles, 3), true);
+  TEST_EQ(memcmp(doubles, floats, sizeof(floats)), 0);
+  vbytes = map["bytes"].AsTypedVector();
+  TEST_EQ(vbytes.size(), 300);
+  TEST_EQ(vbytes.CopyTo(bytes_back.data(), bytes_back.size()), true);
+  TEST_EQ(bytes_back == bytes, true);
+  auto vfixed = map["fixed"].AsFixedTypedVector();
+  TEST_EQ(vfixed.data<int8_t>() != nullptr, in_place);
+  float fixed_back[3];
+  TEST_EQ(vfixed.CopyTo(fixed_back, 3), true);
+  TEST_EQ(fixed_back[1], -2.0f);
+}
+
+// Copies a FlexBuffer into a Builder as it is walked.
+class FlexCopyVisitor : public flexbuffers::WalkVisitor {
+ public:
+  explicit FlexCopyVisitor(flexbuffers::Builder *fbb) : fbb_(fbb) {}
+  bool Null() { return Add([&]() { fbb_->Null(); }); }
+  bool Bool(bool b) { return Add([&]() { fbb_->Bool(b); }); }
+  bool Int(int64_t i) { return Add([&]() { fbb_->Int(i); }); }
+  bool UInt(uint64_t u) { return Add([&]() { fbb_->UInt(u); }); }
+  bool Float(double d) { return Add([&]() { fbb_->Double(d); }); }
+  bool String(const char *str, size_t len) {
+    return Add([&]() { fbb_->String(str, len); });
+  }
+  bool Blob(const uint8_t *data, size_t len) {
+    return Add([&]() { fbb_->Blob(data, len); });
+  }
+  bool StartMap(size_t) {
+    starts_.push_back(key_ ? fbb_->StartMap(key_) : fbb_->StartMap());
+    key_ = nullptr;
+    return true;
+  }
+  bool Key(const char *key) {
+    key_ = key;
+    return true;
+  }
+  bool EndMap() {
+    fbb_->EndMap(starts_.back());
+    starts_.pop_back();
+    return true;
+  }
+  bool StartVector(size_t) {
+    starts_.push_back(key_ ? fbb_->StartVector(key_) : fbb_->StartVector());
+    key_ = nullptr;
+    return true;
+  }
+  bool EndVector() {
+    fbb_->EndVector(starts_.back(), false, false);
+    starts_.pop_back();
+    return true;
+  }
+
+ private:
+  template<typename F> bool Add(F f) {
+    if (key_) fbb_->Key(key_);
+    key_ = nullptr;
+    f();
+    return true;
+  }
+
+  flexbuffers::Builder *fbb_;
+  std::vector<size_t> starts_;
+  const char *key_ = nullptr;
+};
+
+// Adds up the ints, until it reaches a limit.
+class FlexSumVisitor : public flexbuffers::WalkVisitor {
+ public:
+  bool Int(int64_t i) {
+    sum += i;
+    return sum < 10;
+  }
+  int64_t sum = 0;
+};
+
+void FlexBuffersWalkTest() {
+  flexbuffers::Builder slb;
+  slb.Map([&]() {
+    slb.Vector("vec", [&]() {
+      slb += -100;
+      slb += "Fred";
+      slb.IndirectFloat(4.0f);
+      slb.IndirectInt(-7);
+      uint8_t blob[] = { 77, 0, 78 };
+      slb.Blob(blob, 3);
+      slb += false;
+      slb.Null();
+    });
+    int ints[] = { 1, 2, 3 };
+    slb.Vector("bar", ints, 3);
+    slb.FixedTypedVector("bar3", ints, 3);
+    slb.Double("foo", 100.5);
+    slb.UInt("big", 1ULL << 63);
+    slb.Map("mymap", [&]() {
+      slb.String("foo", "Fred");
+      slb.Map("empty", []() {});
+    });
+  });
+  slb.Finish();
+  auto root = flexbuffers::GetRoot(slb.GetBuffer());
+
+  flexbuffers::Builder copy;
+  FlexCopyVisitor copier(&copy);
+  flexbuffers::Walker walker(&copier);
+  TEST_EQ(walker.Walk(slb.GetBuffer().data(), slb.GetSize()), true);
+  copy.Finish();
+  TEST_EQ_STR(flexbuffers::GetRoot(copy.GetBuffer()).ToString().c_str(),
+              root.ToString().c_str());
+  // Walkers are reusable, and can start anywhere.
+  copy.Clear();
+  TEST_EQ(walker.Walk(root.AsMap()["mymap"]), true);
+  copy.Finish();
+  TEST_EQ_STR(flexbuffers::GetRoot(copy.GetBuffer()).ToString().c_str(),
+              "{ empty: {  }, foo: \"Fred\" }");
+
+  FlexSumVisitor summer;
+  flexbuffers::Walker sum_walker(&summer);
+  TEST_EQ(sum_walker.Walk(root.AsMap()["bar"]), true);
+  TEST_EQ(summer.sum, 6);
+  // Keys are sorted, so it stops at the last element of "bar3".
+  summer.sum = 0;
+  TEST_EQ(sum_walker.Walk(slb.GetBuffer().data(), slb.GetSize()), false);
+  TEST_EQ(summer.sum, 12);
+}
+
+void FlexBuffersUpdateTest() {
+  flexbuffers::Builder slb;
+  slb.Map([&]() {
+    slb.String("name", "state");
+    slb.Int("count", 1);
+    slb.Vector("players", [&]() {
+      for (int i = 0; i < 2; i++) {
+        slb.Map([&]() {
+          slb.String("name", i ? "b" : "a");
+          slb.Int("score", i + 1);
+        });
+      }
+    });
+    int ints[] = { 1, 2, 3 };
+    slb.Vector("tags", ints, 3);
+    slb.FixedTypedVector("pos", ints, 3);
+    slb.Map("a", [&]() { slb.Map("b", [&]() { slb.Int("c", 1); }); });
+  });
+  slb.Finish();
+  auto buf = slb.GetBuffer();
+  auto old_size = buf.size();
+
+  flexbuffers::Updater upd(std::move(buf));
+  upd.Set({ "players", 1, "score" }, 1000000);
+  upd.Set({ "count" }, 2);
+  upd.Set({ "new" }, "hello");
+  upd.Remove({ "name" });
+  upd.Append({ "tags" }, 4);
+  upd.Set({ "pos", 0 }, 1.5);
+  TEST_EQ(upd.Finish(), true);
+  auto &ubuf = upd.GetBuffer();
+  TEST_EQ(flexbuffers::VerifyBuffer(ubuf.data(), ubuf.size()), true);
+  auto expected =
+      "{ a: { b: { c: 1 } }, count: 2, new: \"hello\", "
+      "players: [ { name: \"a\", score: 1 }, "
+      "{ name: \"b\", score: 1000000 } ], "
+      "pos: [ 1.5, 2, 3 ], tags: [ 1, 2, 3, 4 ] }";
+  TEST_EQ_STR(upd.GetRoot().ToString().c_str(), expected);
+  // Unchanged values are shared with the previous version.
+  auto map = upd.GetRoot().AsMap();
+  auto player = map["players"].AsVector()[0].AsMap();
+  TEST_EQ(player["name"].AsString().c_str() <
+              reinterpret_cast<const char *>(ubuf.data() + old_size),
+          true);
+  TEST_EQ(map["tags"].IsTypedVector(), true);
+  TEST_EQ(map["pos"].IsUntypedVector(), true);
+
+  // A change of a deeply nested value only copies the maps on its path.
+  auto size = ubuf.size();
+  upd.Set({ "a", "b", "c" }, 5);
+  TEST_EQ(upd.Finish(), true);
+  TEST_EQ(upd.GetRoot().AsMap()["a"].AsMap()["b"].AsMap()["c"].AsInt64(), 5);
+  TEST_EQ(upd.GetBuffer().size() - size < 100, true);
+
+  // Changes that don't apply leave the buffer as it was.
+  size = upd.GetBuffer().size();
+  auto before = upd.GetRoot().ToString();
+  upd.Set({ "count" }, 3);
+  upd.Set({ "players", 5, "score" }, 1);
+  TEST_EQ(upd.Finish(), false);
+  TEST_EQ(upd.GetBuffer().size(), size);
+  TEST_EQ_STR(upd.GetRoot().ToString().c_str(), before.c_str());
+}
+
+void FlexBuffersVerifierTest() {
+  flexbuffers::Builder slb(512, static_cast<flexbuffers::BuilderFlag>(
+                                    flexbuffers::BUILDER_FLAG_SHARE_ALL |
+                                    flexbuffers::BUILDER_FLAG_INDEX_MAP_KEYS));
+  slb.Map([&]() {
+    slb.Vector("vec", [&]() {
+      slb += -100;
+      slb += "Fred";
+      slb.IndirectFloat(4.0f);
+      slb.IndirectInt(-1);
+      slb.IndirectUInt(1ULL << 40);
+      uint8_t blob[] = { 77, 0, 78 };
+      slb.Blob(blob, 3);
+      slb.String(std::string(300, 'x'));
+      slb.Key("key");
+      slb.Null();
+    });
+    int ints[] = { 1, 2, 3 };
+    slb.Vector("bar", ints, 3);
+    slb.FixedTypedVector("bar3", ints, 3);
+    bool bools[] = { true, false, true, false };
+    slb.Vector("bools", bools, 4);
+    int64_t wide[] = { 1, 1LL << 40 };
+    slb.Vector("wide", wide, 2);
+    slb.Vector("maps", [&]() {
+      for (int m = 0; m < 3; m++) {
+        slb.Map([&]() {
+          for (int i = 0; i < 10; i++) {
+            slb.Int(("k" + flatbuffers::NumToString(i)).c_str(), i + m);
+          }
+        });
+      }
+    });
+  });
+  slb.Finish();
+  auto &buf = slb.GetBuffer();
+  TEST_EQ(flexbuffers::VerifyBuffer(buf.data(), buf.size()), true);
+  // The maps inside a vector inside the root map nest three deep.
+  flexbuffers::Verifier verifier(buf.data(), buf.size(), 3);
+  TEST_EQ(verifier.VerifyBuffer(), true);
+
+  // Buffers from the JSON parser, and scalar roots.
+  flatbuffers::Parser parser;
+  TEST_EQ(parser.ParseFlexBuffer(
+              "{ a: [ [ [ 1 ] ] ], b: { c: \"d\" }, e: [ \"f\", 2.5 ] }",
+              nullptr, &parser.flex_builder_),
+          true);
+  auto &pbuf = parser.flex_builder_.GetBuffer();
+  TEST_EQ(flexbuffers::VerifyBuffer(pbuf.data(), pbuf.size()), true);
+  flexbuffers::Builder root;
+  root.Double(1.5);
+  root.Finish();
+  TEST_EQ(flexbuffers::VerifyBuffer(root.GetBuffer().data(),
+                                    root.GetBuffer().size()),
+          true);
+}
+
 void TypeAliasesTest() {
   flatbuffers::FlatBufferBuilder builder;
 
@@ -3383,6 +4889,8 @@ int FlatBufferTests() {
 
   MiniReflectFlatBuffersTest(flatbuf.data());
 
+  QueryTest();
+
   SizePrefixedTest();
 
   #ifndef FLATBUFFERS_NO_FILE_TESTS
@@ -3395,6 +4903,8 @@ int FlatBufferTests() {
     FixedLengthArrayJsonTest(false);
     FixedLengthArrayJsonTest(true);
     ReflectionTest(flatbuf.data(), flatbuf.size());
+    SchemaViewTest();
+    FlexBuffersTranscodeTest();
     ParseProtoTest();
     ParseProtoTestWithSuffix();
     ParseProtoTestWithIncludes();
@@ -3417,6 +4927,7 @@ int FlatBufferTests() {
   EnumOutOfRangeTest();
   IntegerOutOfRangeTest();
   IntegerBoundaryTest();
+  TokenizerBlockBoundaryTest();
   UnicodeTest();
   UnicodeTestAllowNonUTF8();
   UnicodeTestGenerateTextFailsOnNonUTF8();
@@ -3425,7 +4936,11 @@ int FlatBufferTests() {
   InvalidUTF8Test();
   UnknownFieldsTest();
   ParseUnionTest();
+  KeySortTest();
+  FieldLookupTest();
+  ParserCheckpointTest();
   InvalidNestedFlatbufferTest();
+  NestedFlatbufferTest();
   ConformTest();
   ParseProtoBufAsciiTest();
   TypeAliasesTest();
@@ -3433,11 +4948,23 @@ int FlatBufferTests() {
   CreateSharedStringTest();
   JsonDefaultTest();
   JsonEnumsTest();
+  GenerateTextStreamingTest();
+  NdjsonTest();
   FlexBuffersTest();
   FlexBuffersDeprecatedTest();
+  FlexBuffersJsonTest();
+  FlexBuffersStreamingTest();
+  FlexBuffersKeyIndexTest();
+  FlexBuffersPoolTest();
+  FlexBuffersMapTemplateTest();
+  FlexBuffersVerifierTest();
+  FlexBuffersTypedVectorTest();
+  FlexBuffersWalkTest();
+  FlexBuffersUpdateTest();
   UninitializedVectorTest();
   EqualOperatorTest();
   NumericUtilsTest();
+  FastNumericParseTest();
   IsAsciiUtilsTest();
   ValidFloatTest();
   InvalidFloatTest();